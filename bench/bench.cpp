@@ -0,0 +1,54 @@
+#include "bench.h"
+#include <iomanip>
+
+void BenchRunner::report(const std::string& name, const std::string& params, size_t ops_per_sample,
+                         const LatencyHistogram& histogram) {
+    LatencyStats stats = histogram.stats();
+    double ops = static_cast<double>(ops_per_sample > 0 ? ops_per_sample : 1);
+    BenchResult result;
+    result.name = name;
+    result.params = params;
+    result.samples = stats.count;
+    result.ops_per_sample = ops_per_sample;
+    result.mean_ns = stats.mean_ns / ops;
+    result.p50_ns = stats.p50_ns / ops;
+    result.p99_ns = stats.p99_ns / ops;
+    result.p999_ns = stats.p999_ns / ops;
+    result.max_ns = stats.max_ns / ops;
+    result.ops_per_second = result.mean_ns > 0 ? 1e9 / result.mean_ns : 0.0;
+    print(result);
+}
+
+void BenchRunner::print(const BenchResult& r) {
+    switch (format_) {
+    case BenchFormat::JSON:
+        out_ << std::fixed << std::setprecision(2) << "{\"name\":\"" << r.name << "\",\"params\":\"" << r.params
+             << "\",\"samples\":" << r.samples << ",\"ops_per_sample\":" << r.ops_per_sample
+             << ",\"mean_ns\":" << r.mean_ns << ",\"p50_ns\":" << r.p50_ns << ",\"p99_ns\":" << r.p99_ns
+             << ",\"p999_ns\":" << r.p999_ns << ",\"max_ns\":" << r.max_ns << ",\"ops_per_s\":"
+             << std::setprecision(0) << r.ops_per_second << "}\n";
+        break;
+    case BenchFormat::CSV:
+        if (!header_done_) {
+            out_ << "name,params,samples,ops_per_sample,mean_ns,p50_ns,p99_ns,p999_ns,max_ns,ops_per_s\n";
+            header_done_ = true;
+        }
+        out_ << std::fixed << std::setprecision(2) << r.name << "," << r.params << "," << r.samples << ","
+             << r.ops_per_sample << "," << r.mean_ns << "," << r.p50_ns << "," << r.p99_ns << "," << r.p999_ns
+             << "," << r.max_ns << "," << std::setprecision(0) << r.ops_per_second << "\n";
+        break;
+    case BenchFormat::TABLE:
+        if (!header_done_) {
+            out_ << std::left << std::setw(28) << "case" << std::setw(26) << "params" << std::right
+                 << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10)
+                 << "p99.9" << std::setw(12) << "max" << std::setw(14) << "ops/s" << "\n";
+            header_done_ = true;
+        }
+        out_ << std::left << std::setw(28) << r.name << std::setw(26) << r.params << std::right << std::fixed
+             << std::setprecision(1) << std::setw(10) << r.mean_ns << std::setw(10) << r.p50_ns << std::setw(10)
+             << r.p99_ns << std::setw(10) << r.p999_ns << std::setw(12) << r.max_ns << std::setprecision(0)
+             << std::setw(14) << r.ops_per_second << "\n";
+        break;
+    }
+    out_.flush();
+}
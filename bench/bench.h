@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include "latency_histogram.h"
+#include "tsc_clock.h"
+
+// Keeps `value` alive so the optimiser cannot drop the work producing it.
+template <typename T>
+inline void bench_keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchResult {
+    std::string name;    // Case, e.g. "book.add"
+    std::string params;  // "depth=100 ladder=1", fixed per case
+    uint64_t samples = 0;
+    size_t ops_per_sample = 1;
+    // Per-operation nanoseconds: each sample times `ops_per_sample`
+    // operations and is divided back out, so cheap operations are not
+    // swamped by the clock read.
+    double mean_ns = 0.0;
+    double p50_ns = 0.0;
+    double p99_ns = 0.0;
+    double p999_ns = 0.0;
+    double max_ns = 0.0;
+    double ops_per_second = 0.0;
+};
+
+enum class BenchFormat {
+    TABLE,
+    JSON,  // One object per line, for diffing against a saved baseline
+    CSV
+};
+
+// Minimal timing harness. Each case runs untimed warm-up samples, then
+// `samples` timed ones; `setup` runs untimed before every sample to put the
+// structure back into the state under test.
+class BenchRunner {
+public:
+    BenchRunner(std::ostream& out, BenchFormat format, std::string filter, size_t samples)
+        : out_(out), format_(format), filter_(std::move(filter)), samples_(samples) {}
+
+    bool enabled(const std::string& name) const {
+        return filter_.empty() || name.find(filter_) != std::string::npos;
+    }
+    size_t samples() const { return samples_; }
+
+    template <typename Setup, typename Body>
+    void run(const std::string& name, const std::string& params, size_t ops_per_sample, Setup&& setup,
+             Body&& body) {
+        if (!enabled(name)) return;
+        LatencyHistogram histogram;
+        size_t warmup = samples_ / 10 + 1;
+        for (size_t i = 0; i < warmup + samples_; ++i) {
+            setup();
+            uint64_t start = TscClock::now();
+            body();
+            uint64_t elapsed = TscClock::now() - start;
+            if (i >= warmup) histogram.record(TscClock::to_ns(elapsed));
+        }
+        report(name, params, ops_per_sample, histogram);
+    }
+    template <typename Body>
+    void run(const std::string& name, const std::string& params, size_t ops_per_sample, Body&& body) {
+        run(name, params, ops_per_sample, [] {}, std::forward<Body>(body));
+    }
+
+    // For cases that time themselves (e.g. across threads) into a
+    // histogram of per-sample nanoseconds.
+    void report(const std::string& name, const std::string& params, size_t ops_per_sample,
+                const LatencyHistogram& histogram);
+private:
+    std::ostream& out_;
+    BenchFormat format_;
+    std::string filter_;
+    size_t samples_;
+    bool header_done_ = false;
+
+    void print(const BenchResult& result);
+};
@@ -0,0 +1,333 @@
+// Microbenchmarks for the book, the matcher, the indicators and the thread
+// pool (under each idle mode), reported as per-operation latency percentiles.
+//
+//   bench [--filter <substring>] [--samples <n>] [--format table|json|csv]
+//
+// --format json prints one object per case per line, so a saved run can be
+// diffed against a later one to catch regressions.
+#include "bench.h"
+#include "indicators.h"
+#include "matching_engine.h"
+#include "order_book.h"
+#include "order_pool.h"
+#include "threading.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t BOOK_OPS = 64;
+constexpr Price TOP_PRICE = 100000;
+
+std::string join_params(const std::string& a, size_t a_value, const std::string& b = "", size_t b_value = 0) {
+    std::string out = a + "=" + std::to_string(a_value);
+    if (!b.empty()) out += " " + b + "=" + std::to_string(b_value);
+    return out;
+}
+
+// One side of a book, `depth` levels deep with one order per level, plus
+// random orders inside that depth to add or cancel.
+struct BookFixture {
+    OrderPool pool;
+    OrderBookSide side;
+    std::mt19937_64 rng{42};
+    std::uniform_int_distribution<Price> price;
+    std::vector<RestingOrder*> batch;
+    OrderId next_id = 1;
+
+    BookFixture(size_t depth, size_t ladder)
+        : pool(depth + 2 * BOOK_OPS), side(true, ladder), price(TOP_PRICE - depth + 1, TOP_PRICE) {
+        for (size_t level = 0; level < depth; ++level) {
+            side.add_order(pool.acquire(Order(next_id++, OrderSide::BUY, TOP_PRICE - level, 10, OrderType::LIMIT)));
+        }
+        batch.reserve(BOOK_OPS);
+    }
+    void acquire_batch() {
+        batch.clear();
+        for (size_t i = 0; i < BOOK_OPS; ++i) {
+            batch.push_back(pool.acquire(Order(next_id++, OrderSide::BUY, price(rng), 10, OrderType::LIMIT)));
+        }
+    }
+    void release_batch() {
+        for (RestingOrder* order : batch) pool.release(order);
+        batch.clear();
+    }
+};
+
+void bench_book(BenchRunner& runner) {
+    for (size_t ladder : {size_t(0), size_t(4096)}) {
+        for (size_t depth : {10, 100, 1000, 10000}) {
+            std::string params = join_params("depth", depth, "ladder", ladder);
+            if (runner.enabled("book.add")) {
+                BookFixture book(depth, ladder);
+                bool resting = false;
+                runner.run("book.add", params, BOOK_OPS,
+                           [&] {
+                               if (resting) {
+                                   for (RestingOrder* order : book.batch) book.side.remove_order(order);
+                                   book.release_batch();
+                               }
+                               book.acquire_batch();
+                               resting = true;
+                           },
+                           [&] {
+                               for (RestingOrder* order : book.batch) book.side.add_order(order);
+                           });
+            }
+            if (runner.enabled("book.cancel")) {
+                BookFixture book(depth, ladder);
+                runner.run("book.cancel", params, BOOK_OPS,
+                           [&] {
+                               book.release_batch();
+                               book.acquire_batch();
+                               for (RestingOrder* order : book.batch) book.side.add_order(order);
+                           },
+                           [&] {
+                               for (RestingOrder* order : book.batch) book.side.remove_order(order);
+                           });
+            }
+            if (runner.enabled("book.best_price")) {
+                BookFixture book(depth, ladder);
+                runner.run("book.best_price", params, BOOK_OPS, [&] {
+                    for (size_t i = 0; i < BOOK_OPS; ++i) bench_keep(book.side.get_best_price());
+                });
+            }
+        }
+    }
+}
+
+// A market order that sweeps `levels` ask levels of one order each.
+void bench_engine(BenchRunner& runner) {
+    if (!runner.enabled("engine.cross")) return;
+    for (size_t levels : {1, 4, 16, 64, 256}) {
+        EngineConfig config;
+        config.ladder_levels = 4096;
+        MatchingEngine engine(config);
+        OrderId next_id = 1;
+        runner.run("engine.cross", join_params("levels", levels), 1,
+                   [&] {
+                       for (size_t level = 0; level < levels; ++level) {
+                           engine.add_order(
+                               Order(next_id++, OrderSide::SELL, TOP_PRICE + level, 10, OrderType::LIMIT));
+                       }
+                   },
+                   [&] {
+                       engine.add_order(Order(next_id++, OrderSide::BUY, 0, 10 * levels, OrderType::MARKET));
+                   });
+    }
+}
+
+// Cancels of random orders in a book of `resting` orders; each sample puts
+// the cancelled orders back first. Mostly the cost of the ID lookup once the
+// book outgrows the cache.
+void bench_engine_cancel(BenchRunner& runner) {
+    if (!runner.enabled("engine.cancel")) return;
+    for (size_t resting : {1000, 100000, 1000000}) {
+        EngineConfig config;
+        config.ladder_levels = 4096;
+        config.order_capacity = resting + BOOK_OPS;
+        MatchingEngine engine(config);
+        auto order_for = [](OrderId id) {
+            return Order(id, OrderSide::SELL, TOP_PRICE + id % 1000, 10, OrderType::LIMIT);
+        };
+        for (OrderId id = 1; id <= resting; ++id) engine.add_order(order_for(id));
+        std::mt19937_64 rng(11);
+        std::uniform_int_distribution<OrderId> pick(1, resting);
+        std::vector<OrderId> batch;
+        runner.run("engine.cancel", join_params("resting", resting), BOOK_OPS,
+                   [&] {
+                       for (OrderId id : batch) engine.add_order(order_for(id));
+                       batch.clear();
+                       while (batch.size() < BOOK_OPS) {
+                           OrderId id = pick(rng);
+                           if (std::find(batch.begin(), batch.end(), id) == batch.end()) batch.push_back(id);
+                       }
+                   },
+                   [&] {
+                       for (OrderId id : batch) bench_keep(engine.cancel_order(id));
+                   });
+    }
+}
+
+// `batch` crossing pairs (a resting sell, then a market buy that takes it),
+// added one call per order or as one submit_batch.
+void bench_engine_batch(BenchRunner& runner) {
+    for (size_t batch : {1, 8, 64, 256}) {
+        std::string params = join_params("batch", batch);
+        std::vector<Order> orders;
+        for (size_t i = 0; i < batch; ++i) {
+            orders.push_back(Order(0, OrderSide::SELL, TOP_PRICE, 10, OrderType::LIMIT));
+            orders.push_back(Order(0, OrderSide::BUY, 0, 10, OrderType::MARKET));
+        }
+        std::vector<TradeEvent> fills(batch);
+        MatchingEngine engine;
+        OrderId next_id = 1;
+        auto renumber = [&] {
+            for (Order& order : orders) order.order_id = next_id++;
+        };
+        runner.run("engine.add_loop", params, orders.size(), renumber, [&] {
+            for (const Order& order : orders) engine.add_order(order);
+        });
+        runner.run("engine.submit_batch", params, orders.size(), renumber, [&] {
+            bench_keep(engine.submit_batch(orders, fills.data(), fills.size()));
+        });
+    }
+}
+
+void bench_indicators(BenchRunner& runner) {
+    constexpr size_t CALLS = 16;
+    std::vector<double> prices(4096);
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> step(0.0, 0.05);
+    double price = 100.0;
+    for (double& p : prices) p = price += step(rng);
+    std::vector<CompactPrice> ticks;
+    for (double p : prices) ticks.push_back(CompactPrice::saturate(FixedPrice::from_double(p)));
+
+    for (size_t window : {16, 64, 256, 1024}) {
+        std::string params = join_params("window", window);
+        Span<double> values(prices.data() + prices.size() - window, window);
+        Span<CompactPrice> tick_values(ticks.data() + ticks.size() - window, window);
+        runner.run("indicators.sma", params, CALLS, [&] {
+            for (size_t i = 0; i < CALLS; ++i) bench_keep(Indicators::simple_moving_average(values, window));
+        });
+        runner.run("indicators.sma_ticks", params, CALLS, [&] {
+            for (size_t i = 0; i < CALLS; ++i) bench_keep(Indicators::simple_moving_average(tick_values, window));
+        });
+        runner.run("indicators.rsi", params, CALLS, [&] {
+            for (size_t i = 0; i < CALLS; ++i) bench_keep(Indicators::relative_strength_index(values, window - 1));
+        });
+        runner.run("indicators.macd", params, CALLS, [&] {
+            for (size_t i = 0; i < CALLS; ++i) bench_keep(Indicators::macd(values, 12, 26, 9));
+        });
+        runner.run("indicators.price_change", params, CALLS, [&] {
+            for (size_t i = 0; i < CALLS; ++i) bench_keep(Indicators::price_change_percent(values, window - 1));
+        });
+        runner.run("indicators.momentum", params, CALLS, [&] {
+            for (size_t i = 0; i < CALLS; ++i) bench_keep(Indicators::momentum_score(values, window / 4, window));
+        });
+        runner.run("indicators.min_max", params, CALLS, [&] {
+            for (size_t i = 0; i < CALLS; ++i) bench_keep(Indicators::window_min_max(values, window));
+        });
+        runner.run("indicators.min_max_ticks", params, CALLS, [&] {
+            for (size_t i = 0; i < CALLS; ++i) bench_keep(Indicators::window_min_max(tick_values, window));
+        });
+        runner.run("indicators.variance", params, CALLS, [&] {
+            for (size_t i = 0; i < CALLS; ++i) bench_keep(Indicators::window_variance(values, window));
+        });
+        if (runner.enabled("indicators.streaming")) {
+            StreamingIndicators streaming(window / 4, window, 14);
+            size_t next = 0;
+            runner.run("indicators.streaming", params, CALLS, [&] {
+                for (size_t i = 0; i < CALLS; ++i) streaming.update(prices[next++ % prices.size()]);
+                bench_keep(streaming.snapshot());
+            });
+        }
+    }
+}
+
+struct PingState {
+    LatencyHistogram latency;
+    std::atomic<bool> done{false};
+};
+
+void bench_thread_pool(BenchRunner& runner) {
+    struct Idle {
+        WaitMode wait;
+        uint32_t spin_us;
+    };
+    for (Idle idle : {Idle{WaitMode::BLOCK, 0}, Idle{WaitMode::BLOCK, 100}, Idle{WaitMode::SPIN_YIELD, 0},
+                      Idle{WaitMode::BUSY_POLL, 0}}) {
+        std::string params =
+            std::string("wait=") + wait_mode_name(idle.wait) + " " + join_params("spin_us", idle.spin_us);
+        if (runner.enabled("pool.enqueue")) {
+            ThreadPoolConfig config;
+            config.num_threads = 2;
+            config.wait = idle.wait;
+            config.spin_us = idle.spin_us;
+            ThreadPool pool(config);
+            std::atomic<uint64_t> completed{0};
+            uint64_t submitted = 0;
+            runner.run("pool.enqueue", params, BOOK_OPS,
+                       [&] {
+                           while (completed.load(std::memory_order_acquire) < submitted) std::this_thread::yield();
+                       },
+                       [&] {
+                           for (size_t i = 0; i < BOOK_OPS; ++i) {
+                               pool.enqueue([&completed] { completed.fetch_add(1, std::memory_order_release); });
+                           }
+                           submitted += BOOK_OPS;
+                       });
+            while (completed.load(std::memory_order_acquire) < submitted) std::this_thread::yield();
+            pool.shutdown();
+        }
+        if (runner.enabled("pool.dispatch")) {
+            // Enqueue to task start, one task in flight; a single worker
+            // keeps the histogram single-writer.
+            ThreadPoolConfig config;
+            config.num_threads = 1;
+            config.wait = idle.wait;
+            config.spin_us = idle.spin_us;
+            ThreadPool pool(config);
+            PingState state;
+            size_t warmup = runner.samples() / 10 + 1;
+            for (size_t i = 0; i < warmup + runner.samples(); ++i) {
+                if (i == warmup) state.latency.reset();
+                state.done.store(false, std::memory_order_relaxed);
+                uint64_t start = TscClock::now();
+                pool.enqueue([&state, start] {
+                    state.latency.record(TscClock::to_ns(TscClock::now() - start));
+                    state.done.store(true, std::memory_order_release);
+                });
+                while (!state.done.load(std::memory_order_acquire)) {
+                }
+            }
+            pool.shutdown();
+            runner.report("pool.dispatch", params, 1, state.latency);
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    size_t samples = 2000;
+    BenchFormat format = BenchFormat::TABLE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            samples = std::max<size_t>(1, std::stoul(argv[++i]));
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "table") {
+                format = BenchFormat::TABLE;
+            } else if (name == "json") {
+                format = BenchFormat::JSON;
+            } else if (name == "csv") {
+                format = BenchFormat::CSV;
+            } else {
+                std::cerr << "unknown format " << name << "\n";
+                return 1;
+            }
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--filter <substring>] [--samples <n>] [--format table|json|csv]\n";
+            return 1;
+        }
+    }
+
+    BenchRunner runner(std::cout, format, filter, samples);
+    bench_book(runner);
+    bench_engine(runner);
+    bench_engine_batch(runner);
+    bench_engine_cancel(runner);
+    bench_indicators(runner);
+    bench_thread_pool(runner);
+    return 0;
+}
@@ -108,11 +108,12 @@ void run_strategy_with_config(const StrategyConfig& config, const std::string& s
     
     // Set up market data processing
     market_data.start([&](const std::vector<std::shared_ptr<Order>>& market_orders) {
-        pool.enqueue([&]() {
-            auto signals = strategy.generate_signals(market_orders);
-            auto filtered = risk.filter_orders(signals);
+        pool.enqueue([&strategy, &risk, &engine, &perf, market_orders]() {
+            std::vector<Order> signals;
+            strategy.generate_signals(market_orders, signals);
+            risk.filter_orders(signals);
             
-            for (auto& order : filtered) {
+            for (const Order& order : signals) {
                 engine.add_order(order);
                 perf.record_event();
             }
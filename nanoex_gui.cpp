@@ -28,10 +28,11 @@
 #include <QAction>
 #include <QFileDialog>
 #include <QInputDialog>
-#include <QRegularExpression>
 #include <QColor>
 #include <QPalette>
 #include "src/chart_widget.h"
+#include "src/broadcast_ring.h"
+#include "src/telemetry_event.h"
 
 // ============================================================================
 // HFT System Runner Thread
@@ -124,11 +125,15 @@ public:
         setupUI();
     }
     
-    void updateStats(const QString& stats) {
-        // Parse and update performance statistics
-        statsText_->setPlainText(stats);
-        
-        // Extract key metrics for display
+    void updateStats(const TelemetryEvent::StatsFields& stats) {
+        statsText_->setPlainText(QString("Orders processed: %1\nTrades matched: %2\nEvents/sec: %3\n"
+                                         "Match latency: avg %4 ns, p99 %5 ns\nBest bid: %6  Best ask: %7\n"
+                                         "Risk rejected: %8")
+                                     .arg(stats.orders).arg(stats.trades)
+                                     .arg(stats.events_per_second, 0, 'f', 1)
+                                     .arg(stats.avg_match_ns, 0, 'f', 1).arg(stats.p99_match_ns, 0, 'f', 0)
+                                     .arg(stats.best_bid, 0, 'f', 2).arg(stats.best_ask, 0, 'f', 2)
+                                     .arg(stats.risk_rejected));
         updateMetrics(stats);
     }
 
@@ -179,37 +184,12 @@ private:
         layout->addWidget(metricsGroup);
     }
     
-    void updateMetrics(const QString& stats) {
-        // Simple parsing of key metrics from the stats text
-        // In a real implementation, you'd use regex or structured parsing
-        
-        // Extract orders per second
-        QRegularExpression ordersRegex("Orders/sec:\\s*([0-9.]+)");
-        QRegularExpressionMatch ordersMatch = ordersRegex.match(stats);
-        if (ordersMatch.hasMatch()) {
-            ordersPerSecLabel_->setText(ordersMatch.captured(1));
-        }
-        
-        // Extract latency
-        QRegularExpression latencyRegex("Avg latency:\\s*([0-9.]+)\\s*ns");
-        QRegularExpressionMatch latencyMatch = latencyRegex.match(stats);
-        if (latencyMatch.hasMatch()) {
-            latencyLabel_->setText(latencyMatch.captured(1) + " ns");
-        }
-        
-        // Extract trades
-        QRegularExpression tradesRegex("Trades matched:\\s*([0-9]+)");
-        QRegularExpressionMatch tradesMatch = tradesRegex.match(stats);
-        if (tradesMatch.hasMatch()) {
-            tradesLabel_->setText(tradesMatch.captured(1));
-        }
-        
-        // Extract spread
-        QRegularExpression spreadRegex("Spread:\\s*\\$([0-9.]+)");
-        QRegularExpressionMatch spreadMatch = spreadRegex.match(stats);
-        if (spreadMatch.hasMatch()) {
-            spreadLabel_->setText("$" + spreadMatch.captured(1));
-        }
+    void updateMetrics(const TelemetryEvent::StatsFields& stats) {
+        ordersPerSecLabel_->setText(QString::number(stats.events_per_second, 'f', 1));
+        latencyLabel_->setText(QString::number(stats.avg_match_ns, 'f', 1) + " ns");
+        tradesLabel_->setText(QString::number(stats.trades));
+        double spread = stats.best_bid > 0 && stats.best_ask > 0 ? stats.best_ask - stats.best_bid : 0.0;
+        spreadLabel_->setText("$" + QString::number(spread, 'f', 2));
     }
 
 private:
@@ -232,7 +212,8 @@ public:
         setupTable();
     }
     
-    void updateStrategyData(const QString& strategyName, const QString& stats) {
+    void updateStrategyData(const QString& strategyName, uint64_t signalCount, uint64_t orderCount,
+                            uint64_t rejected, double latencyNs, double pnlPct) {
         // Find or create row for strategy
         int row = findStrategyRow(strategyName);
         if (row == -1) {
@@ -240,9 +221,11 @@ public:
             insertRow(row);
             setItem(row, 0, new QTableWidgetItem(strategyName));
         }
-        
-        // Parse and update strategy statistics
-        updateStrategyRow(row, stats);
+        setItem(row, 1, new QTableWidgetItem(QString::number(signalCount)));
+        setItem(row, 2, new QTableWidgetItem(QString::number(orderCount)));
+        setItem(row, 3, new QTableWidgetItem(QString::number(rejected)));
+        setItem(row, 4, new QTableWidgetItem(QString::number(latencyNs, 'f', 1)));
+        setItem(row, 5, new QTableWidgetItem(QString::number(pnlPct, 'f', 2) + "%"));
     }
 
 private:
@@ -268,39 +251,6 @@ private:
         return -1;
     }
     
-    void updateStrategyRow(int row, const QString& stats) {
-        // Parse strategy statistics (simplified parsing)
-        QRegularExpression signalsRegex("Signals generated:\\s*([0-9]+)");
-        QRegularExpression ordersRegex("Orders sent:\\s*([0-9]+)");
-        QRegularExpression rejectedRegex("Orders rejected:\\s*([0-9]+)");
-        QRegularExpression latencyRegex("Avg processing time:\\s*([0-9.]+)\\s*ns");
-        QRegularExpression pnlRegex("Current PnL:\\s*\\$([0-9.-]+)");
-        
-        QRegularExpressionMatch signalsMatch = signalsRegex.match(stats);
-        if (signalsMatch.hasMatch()) {
-            setItem(row, 1, new QTableWidgetItem(signalsMatch.captured(1)));
-        }
-        
-        QRegularExpressionMatch ordersMatch = ordersRegex.match(stats);
-        if (ordersMatch.hasMatch()) {
-            setItem(row, 2, new QTableWidgetItem(ordersMatch.captured(1)));
-        }
-        
-        QRegularExpressionMatch rejectedMatch = rejectedRegex.match(stats);
-        if (rejectedMatch.hasMatch()) {
-            setItem(row, 3, new QTableWidgetItem(rejectedMatch.captured(1)));
-        }
-        
-        QRegularExpressionMatch latencyMatch = latencyRegex.match(stats);
-        if (latencyMatch.hasMatch()) {
-            setItem(row, 4, new QTableWidgetItem(latencyMatch.captured(1)));
-        }
-        
-        QRegularExpressionMatch pnlMatch = pnlRegex.match(stats);
-        if (pnlMatch.hasMatch()) {
-            setItem(row, 5, new QTableWidgetItem("$" + pnlMatch.captured(1)));
-        }
-    }
 };
 
 // ============================================================================
@@ -460,6 +410,11 @@ public:
         // Setup timer for periodic updates
         updateTimer_ = new QTimer(this);
         connect(updateTimer_, &QTimer::timeout, this, &NanoEXMainWindow::onUpdateTimer);
+
+        // Structured data comes over the shared-memory telemetry ring;
+        // stdout is only shown as a log.
+        telemetryTimer_ = new QTimer(this);
+        connect(telemetryTimer_, &QTimer::timeout, this, &NanoEXMainWindow::onTelemetryTimer);
         
         // Load settings
         loadSettings();
@@ -487,6 +442,8 @@ private slots:
             
             // Start update timer
             updateTimer_->start(1000); // Update every second
+            resetTelemetry();
+            telemetryTimer_->start(50);
             
             statusBar()->showMessage("HFT System started");
         } else {
@@ -501,6 +458,7 @@ private slots:
             startButton_->setStyleSheet("QPushButton { background-color: #44ff44; color: white; }");
             
             updateTimer_->stop();
+            telemetryTimer_->stop();
             statusBar()->showMessage("HFT System stopped");
         }
     }
@@ -516,20 +474,6 @@ private slots:
         QScrollBar* scrollbar = outputText_->verticalScrollBar();
         scrollbar->setValue(scrollbar->maximum());
         
-        // Parse for performance updates
-        if (text.contains("=== NanoEX Performance Stats ===")) {
-            // Extract performance stats
-            QString stats = extractPerformanceStats();
-            performanceWidget_->updateStats(stats);
-        }
-        
-        // Parse for strategy updates
-        if (text.contains("Strategy '") && text.contains("':")) {
-            parseStrategyUpdate(text);
-        }
-        
-        // Parse for strategy signals and update visualization
-        parseStrategySignals(text);
     }
     
     void onError(const QString& error) {
@@ -541,6 +485,8 @@ private slots:
         startButton_->setText("Start HFT System");
         startButton_->setStyleSheet("QPushButton { background-color: #44ff44; color: white; }");
         updateTimer_->stop();
+        onTelemetryTimer();  // Pick up whatever was published before exit
+        telemetryTimer_->stop();
         
         QString message = QString("HFT System finished with exit code: %1").arg(exitCode);
         statusBar()->showMessage(message);
@@ -559,6 +505,16 @@ private slots:
         }
     }
     
+    void onTelemetryTimer() {
+        if (!telemetry_.is_open() && !telemetry_.open(DEFAULT_TELEMETRY_RING)) {
+            return;  // nanoex has not created the ring yet
+        }
+        TelemetryEvent event;
+        while (telemetry_.poll(event)) {
+            handleTelemetry(event);
+        }
+    }
+    
     void onCompileAction() {
         QProcess* compileProcess = new QProcess(this);
         compileProcess->setWorkingDirectory(QDir::currentPath());
@@ -723,106 +679,58 @@ private:
         statusBar()->showMessage("Ready");
     }
     
-    QString extractPerformanceStats() {
-        QString text = outputText_->toPlainText();
-        int startPos = text.lastIndexOf("=== NanoEX Performance Stats ===");
-        if (startPos != -1) {
-            int endPos = text.indexOf("===", startPos + 1);
-            if (endPos != -1) {
-                return text.mid(startPos, endPos - startPos + 3);
-            }
-        }
-        return "";
-    }
-    
-    void parseStrategyUpdate(const QString& text) {
-        // Simple parsing of strategy updates
-        // In a real implementation, you'd use more sophisticated parsing
-        
-        QRegularExpression strategyRegex("Strategy '([^']+)':");
-        QRegularExpressionMatch strategyMatch = strategyRegex.match(text);
-        if (strategyMatch.hasMatch()) {
-            QString strategyName = strategyMatch.captured(1);
-            strategyTable_->updateStrategyData(strategyName, text);
-        }
-    }
-    
-    void parseStrategySignals(const QString& text) {
-        // Parse BUY signals
-        if (text.contains("BUY Signal:")) {
+    void resetTelemetry() {
+        telemetry_.close();
+        signalCount_ = 0;
+        orderCount_ = 0;
+        lastPnlPct_ = 0.0;
+    }
+    
+    void handleTelemetry(const TelemetryEvent& event) {
+        QDateTime time = QDateTime::fromMSecsSinceEpoch(event.wall_ns / 1000000);
+        switch (event.kind) {
+        case TelemetryEvent::Kind::ORDER:
+            ++orderCount_;
+            break;
+        case TelemetryEvent::Kind::SIGNAL: {
+            const TelemetryEvent::SignalFields& signal = event.signal;
+            bool isBuy = event.side == TelemetryEvent::BUY;
+            ++signalCount_;
+            if (!isBuy) lastPnlPct_ = signal.pnl_pct;
+            QString text = QString("%1 Signal @ %2 (Confidence: %3%) Momentum: %4 RSI: %5 MACD: %6")
+                               .arg(isBuy ? "BUY" : "SELL")
+                               .arg(signal.price, 0, 'f', 2)
+                               .arg(signal.confidence * 100, 0, 'f', 2)
+                               .arg(signal.momentum_score, 0, 'f', 2)
+                               .arg(signal.rsi, 0, 'f', 1)
+                               .arg((event.flags & 1) ? "Bullish" : "Bearish");
+            if (!isBuy) text += QString(" P&L: %1%").arg(signal.pnl_pct, 0, 'f', 2);
             signalMonitor_->addSignal(text);
-            
-            // Extract price from signal
-            QRegularExpression priceRegex("@ ([0-9.]+)");
-            QRegularExpressionMatch priceMatch = priceRegex.match(text);
-            if (priceMatch.hasMatch()) {
-                double price = priceMatch.captured(1).toDouble();
-                strategyChart_->addSignalPoint(price, true, QDateTime::currentDateTime());
-            }
+            strategyChart_->addSignalPoint(signal.price, isBuy, time);
+            break;
+        }
+        case TelemetryEvent::Kind::INDICATORS: {
+            const TelemetryEvent::IndicatorFields& ind = event.indicators;
+            strategyChart_->updateIndicators(ind.rsi, ind.momentum_score, ind.macd_line - ind.signal_line);
+            if (ind.price > 0) strategyChart_->addPricePoint(ind.price, time);
+            break;
+        }
+        case TelemetryEvent::Kind::STATS:
+            performanceWidget_->updateStats(event.stats);
+            strategyTable_->updateStrategyData("Momentum", signalCount_, orderCount_, event.stats.risk_rejected,
+                                               event.stats.avg_match_ns, lastPnlPct_);
+            break;
+        case TelemetryEvent::Kind::CONFIG: {
+            const TelemetryEvent::ConfigFields& config = event.config;
+            strategyConfig_->updateConfig(QString("Momentum threshold: %1\nRSI oversold: %2\nRSI overbought: %3\n"
+                                                  "Short period: %4\nLong period: %5\nPosition size: %6\n"
+                                                  "Stop loss: %7%\nTake profit: %8%")
+                                              .arg(config.momentum_threshold).arg(config.rsi_oversold)
+                                              .arg(config.rsi_overbought).arg(config.short_period)
+                                              .arg(config.long_period).arg(config.position_size)
+                                              .arg(config.stop_loss_pct).arg(config.take_profit_pct));
+            break;
         }
-        
-        // Parse SELL signals
-        if (text.contains("SELL Signal:")) {
-            signalMonitor_->addSignal(text);
-            
-            // Extract price from signal
-            QRegularExpression priceRegex("@ ([0-9.]+)");
-            QRegularExpressionMatch priceMatch = priceRegex.match(text);
-            if (priceMatch.hasMatch()) {
-                double price = priceMatch.captured(1).toDouble();
-                strategyChart_->addSignalPoint(price, false, QDateTime::currentDateTime());
-            }
-        }
-        
-        // Parse strategy configuration
-        if (text.contains("=== Momentum Strategy Configuration ===")) {
-            // Extract configuration text
-            QStringList lines = text.split('\n');
-            QString configText;
-            bool inConfig = false;
-            for (const QString& line : lines) {
-                if (line.contains("=== Momentum Strategy Configuration ===")) {
-                    inConfig = true;
-                    continue;
-                }
-                if (line.contains("=====================================")) {
-                    inConfig = false;
-                    break;
-                }
-                if (inConfig) {
-                    configText += line + "\n";
-                }
-            }
-            strategyConfig_->updateConfig(configText);
-        }
-        
-        // Parse indicators from signal reasons
-        if (text.contains("Momentum:") && text.contains("RSI:") && text.contains("MACD:")) {
-            QRegularExpression momentumRegex("Momentum: ([0-9.-]+)");
-            QRegularExpression rsiRegex("RSI: ([0-9.]+)");
-            QRegularExpression macdRegex("MACD: ([A-Za-z]+)");
-            
-            QRegularExpressionMatch momentumMatch = momentumRegex.match(text);
-            QRegularExpressionMatch rsiMatch = rsiRegex.match(text);
-            QRegularExpressionMatch macdMatch = macdRegex.match(text);
-            
-            if (momentumMatch.hasMatch() && rsiMatch.hasMatch()) {
-                double momentum = momentumMatch.captured(1).toDouble();
-                double rsi = rsiMatch.captured(1).toDouble();
-                double macd = macdMatch.hasMatch() ? (macdMatch.captured(1) == "Bullish" ? 1.0 : -1.0) : 0.0;
-                
-                strategyChart_->updateIndicators(rsi, momentum, macd);
-            }
-        }
-        
-        // Parse price data from orders
-        if (text.contains("Order:") && text.contains("@")) {
-            QRegularExpression priceRegex("@ ([0-9.]+)");
-            QRegularExpressionMatch priceMatch = priceRegex.match(text);
-            if (priceMatch.hasMatch()) {
-                double price = priceMatch.captured(1).toDouble();
-                strategyChart_->addPricePoint(price, QDateTime::currentDateTime());
-            }
         }
     }
     
@@ -849,6 +757,11 @@ private:
     StrategyConfigWidget* strategyConfig_;
     HFTRunner* hftRunner_;
     QTimer* updateTimer_;
+    QTimer* telemetryTimer_;
+    BroadcastReader<TelemetryEvent> telemetry_;
+    uint64_t signalCount_ = 0;
+    uint64_t orderCount_ = 0;
+    double lastPnlPct_ = 0.0;
 };
 
 // ============================================================================
@@ -0,0 +1,164 @@
+// Runs a strategy against recorded market data through the real engine on
+// a simulated clock and prints fills, P&L and latency.
+//
+//   backtest <capture> | <tick store> [--from <unix ns>] [--to <unix ns>] [options]
+//   backtest --synthetic <records> [--rate <msgs/s>] [--seed <n>] [options]
+//
+// Options: --strategy momentum|reversion, --batch <records>,
+// --latency-us <us>, --position-size <qty>, --short <n>, --long <n>,
+// --momentum <score>, --stop-loss <pct>, --take-profit <pct>,
+// --reversion <pct>, --ladder <ticks>, --max-qty <qty>.
+//
+// --synthetic generates LoadGenerator flow stamped at --rate, for runs
+// without a capture file. A tick store (see tick_store.h) is decoded into
+// memory for the --from/--to window only.
+#include "backtester.h"
+#include "load_generator.h"
+#include "replay.h"
+#include "tick_store.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void print_latency(const char* name, const LatencyStats& stats) {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right << " count=" << stats.count
+              << " mean=" << std::fixed << std::setprecision(1) << stats.mean_ns << "ns p50=" << stats.p50_ns
+              << "ns p99=" << stats.p99_ns << "ns p99.9=" << stats.p999_ns << "ns max=" << stats.max_ns << "ns\n";
+}
+
+void print_result(const BacktestResult& r) {
+    std::cout << "Flow:\n"
+              << "  records=" << r.records << " engine_commands=" << r.engine_commands
+              << " book_trades=" << r.book_trades << "\n"
+              << "  signals=" << r.signals << " risk_rejected=" << r.risk_rejected
+              << " orders=" << r.strategy_orders << " fills=" << r.fills << " filled_qty=" << r.filled_quantity
+              << " unfilled_qty=" << r.unfilled_quantity << "\n";
+    std::cout << "P&L:\n" << std::fixed << std::setprecision(2)
+              << "  realized=" << r.realized_pnl << " total=" << r.total_pnl << " max_drawdown=" << r.max_drawdown
+              << " position=" << r.position << "\n"
+              << "  round_trips=" << r.round_trips << " winning=" << r.winning_trips;
+    if (r.round_trips > 0) {
+        std::cout << " (" << std::setprecision(1) << (100.0 * r.winning_trips / r.round_trips) << "%)";
+    }
+    std::cout << "\n";
+    std::cout << "Speed:\n" << std::setprecision(3)
+              << "  simulated=" << (r.simulated_ns / 1e9) << "s wall=" << r.wall_seconds << "s ("
+              << std::setprecision(0) << (r.wall_seconds > 0 ? r.simulated_ns / 1e9 / r.wall_seconds : 0.0)
+              << "x real time) " << std::setprecision(2) << (r.events_per_second / 1e6) << "M events/s\n";
+    std::cout << "Latency:\n";
+    print_latency("match", r.match_latency);
+    print_latency("decision", r.decision_latency);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    size_t synthetic = 0;
+    double rate = 1e6;
+    uint64_t seed = 1;
+    uint64_t from_ns = 0;
+    uint64_t to_ns = UINT64_MAX;
+    BacktestConfig config;
+    config.engine.ladder_levels = 1024;
+    bool bad_args = false;
+    for (int i = 1; i < argc && !bad_args; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--synthetic" && has_value) {
+            synthetic = std::stoul(argv[++i]);
+        } else if (arg == "--from" && has_value) {
+            from_ns = std::stoull(argv[++i]);
+        } else if (arg == "--to" && has_value) {
+            to_ns = std::stoull(argv[++i]);
+        } else if (arg == "--rate" && has_value) {
+            rate = std::stod(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            seed = std::stoull(argv[++i]);
+        } else if (arg == "--strategy" && has_value) {
+            std::string kind = argv[++i];
+            if (kind == "momentum") {
+                config.strategy_kind = BacktestStrategy::MOMENTUM;
+            } else if (kind == "reversion") {
+                config.strategy_kind = BacktestStrategy::MEAN_REVERSION;
+            } else {
+                bad_args = true;
+            }
+        } else if (arg == "--batch" && has_value) {
+            config.batch_size = std::stoul(argv[++i]);
+        } else if (arg == "--latency-us" && has_value) {
+            config.order_latency_ns = static_cast<uint64_t>(std::stod(argv[++i]) * 1000);
+        } else if (arg == "--position-size" && has_value) {
+            config.strategy.position_size = std::stod(argv[++i]);
+        } else if (arg == "--short" && has_value) {
+            config.strategy.short_period = std::stoul(argv[++i]);
+        } else if (arg == "--long" && has_value) {
+            config.strategy.long_period = std::stoul(argv[++i]);
+        } else if (arg == "--momentum" && has_value) {
+            config.strategy.momentum_threshold = std::stod(argv[++i]);
+        } else if (arg == "--stop-loss" && has_value) {
+            config.strategy.stop_loss_pct = std::stod(argv[++i]);
+        } else if (arg == "--take-profit" && has_value) {
+            config.strategy.take_profit_pct = std::stod(argv[++i]);
+        } else if (arg == "--reversion" && has_value) {
+            config.strategy.reversion_threshold_pct = std::stod(argv[++i]);
+        } else if (arg == "--ladder" && has_value) {
+            config.engine.ladder_levels = std::stoul(argv[++i]);
+        } else if (arg == "--max-qty" && has_value) {
+            config.risk.max_order_quantity = std::stoull(argv[++i]);
+        } else if (path.empty() && arg.rfind("--", 0) != 0) {
+            path = arg;
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args || (path.empty() == (synthetic == 0)) || rate <= 0) {
+        std::cerr << "usage: " << argv[0] << " <capture> | <tick store> [--from <ns>] [--to <ns>]"
+                  << " | --synthetic <records> [--rate <msgs/s>] [--seed <n>]"
+                  << " [--strategy momentum|reversion] [--batch <n>] [--latency-us <us>] [--position-size <qty>]"
+                  << " [--short <n>] [--long <n>] [--momentum <score>] [--stop-loss <pct>] [--take-profit <pct>]"
+                  << " [--reversion <pct>] [--ladder <ticks>] [--max-qty <qty>]\n";
+        return 1;
+    }
+
+    CaptureFile capture;
+    std::vector<MarketRecord> generated;
+    Span<MarketRecord> records;
+    if (synthetic > 0) {
+        LoadConfig load;
+        load.stream_length = synthetic;
+        load.seed = seed;
+        generated = LoadGenerator(load).generate(0);
+        double spacing_ns = 1e9 / rate;
+        for (size_t i = 0; i < generated.size(); ++i) {
+            generated[i].timestamp_ns = static_cast<uint64_t>(i * spacing_ns);
+        }
+        records = Span<MarketRecord>(generated);
+        std::cout << "Synthetic flow: " << generated.size() << " records at " << rate << " msgs/s\n";
+    } else if (TickStoreFile::is_tick_store(path)) {
+        TickStoreFile store;
+        if (!store.open(path) || !store.read_range(from_ns, to_ns, generated)) {
+            std::cerr << store.error() << "\n";
+            return 1;
+        }
+        records = Span<MarketRecord>(generated);
+        std::cout << "Tick store " << path << ": " << records.size() << " of " << store.record_count()
+                  << " records\n";
+    } else {
+        if (!capture.open(path)) {
+            std::cerr << capture.error() << "\n";
+            return 1;
+        }
+        records = capture.records();
+        std::cout << "Capture " << path << ": " << records.size() << " records\n";
+    }
+
+    Backtester backtester(config);
+    BacktestResult result = backtester.run(records);
+    print_result(result);
+    return 0;
+}
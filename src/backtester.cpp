@@ -0,0 +1,186 @@
+#include "backtester.h"
+#include "mean_reversion_strategy.h"
+#include "tsc_clock.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+// Average-cost position keeping for the strategy's fills.
+struct Account {
+    int64_t position = 0;
+    double average_price = 0.0;
+    double realized = 0.0;
+    double trip_start = 0.0;  // Realized P&L when the position last left flat
+    double last_price = 0.0;
+    double peak = 0.0;
+    uint64_t round_trips = 0;
+    uint64_t winning_trips = 0;
+
+    void fill(OrderSide side, double price, Quantity quantity) {
+        int64_t remaining = static_cast<int64_t>(quantity);
+        int64_t direction = side == OrderSide::BUY ? 1 : -1;
+        if (position != 0 && (position > 0) != (direction > 0)) {
+            int64_t closing = std::min(remaining, position > 0 ? position : -position);
+            realized += (price - average_price) * static_cast<double>(closing) * (position > 0 ? 1 : -1);
+            position += direction * closing;
+            remaining -= closing;
+            if (position == 0) {
+                ++round_trips;
+                if (realized > trip_start) ++winning_trips;
+                trip_start = realized;
+                average_price = 0.0;
+            }
+        }
+        if (remaining > 0) {
+            int64_t held = position > 0 ? position : -position;
+            average_price = (average_price * static_cast<double>(held) + price * static_cast<double>(remaining)) /
+                            static_cast<double>(held + remaining);
+            position += direction * remaining;
+        }
+    }
+
+    double total() const {
+        return realized + (position != 0 ? (last_price - average_price) * static_cast<double>(position) : 0.0);
+    }
+};
+
+struct PendingOrder {
+    uint64_t arrival_ns;
+    Order order;
+};
+
+}  // namespace
+
+Backtester::Backtester(const BacktestConfig& config) : config_(config) {
+    if (config_.batch_size == 0) config_.batch_size = 1;
+    config_.engine.publish_depth = false;
+    config_.engine.trade_tail_capacity = 0;
+}
+
+BacktestResult Backtester::run(Span<MarketRecord> records) {
+    switch (config_.strategy_kind) {
+    case BacktestStrategy::MEAN_REVERSION:
+        return run_with<MeanReversionStrategy>(records);
+    case BacktestStrategy::MOMENTUM:
+    default:
+        return run_with<StrategyEngine>(records);
+    }
+}
+
+template <typename Strategy>
+BacktestResult Backtester::run_with(Span<MarketRecord> records) {
+    BacktestResult result;
+    MatchingEngine engine(config_.engine);
+    RiskManager risk(config_.risk);
+    Strategy strategy(config_.strategy);
+    Account account;
+    LatencyHistogram decision_latency;
+
+    // Strategy orders are market orders and never rest, so every trade
+    // routed to the strategy's participant belongs to the one add_order is
+    // matching right now.
+    const ParticipantId participant = config_.strategy.participant;
+    Quantity active_filled = 0;
+    Price active_checked_price = 0;
+    engine.set_trade_callback([&](const TradeEvent& trade) {
+        ++result.book_trades;
+        account.last_price = price_to_double(trade.price);
+    });
+    engine.set_participant_callback(participant, [&](const TradeEvent& trade) {
+        OrderSide side = trade.buy_participant == participant ? OrderSide::BUY : OrderSide::SELL;
+        account.fill(side, account.last_price, trade.quantity);
+        risk.on_fill(trade.symbol, side, active_checked_price, trade.quantity);
+        active_filled += trade.quantity;
+        ++result.fills;
+    });
+
+    auto submit = [&](const Order& order) {
+        active_filled = 0;
+        active_checked_price = order.price;
+        engine.add_order(order);
+        Quantity residual = order.quantity - active_filled;
+        if (residual > 0) risk.on_cancel(order.symbol, order.side, order.price, residual);
+        result.filled_quantity += active_filled;
+        result.unfilled_quantity += residual;
+        ++result.strategy_orders;
+    };
+
+    std::vector<PendingOrder> pending;
+    size_t pending_head = 0;
+    auto release_until = [&](uint64_t now_ns) {
+        while (pending_head < pending.size() && pending[pending_head].arrival_ns <= now_ns) {
+            submit(pending[pending_head++].order);
+        }
+        if (pending_head == pending.size()) {
+            pending.clear();
+            pending_head = 0;
+        }
+    };
+
+    std::vector<Order> orders;
+    const SymbolId symbol = config_.engine.symbol;
+    auto wall_start = std::chrono::steady_clock::now();
+    for (size_t begin = 0; begin < records.size(); begin += config_.batch_size) {
+        size_t end = std::min(records.size(), begin + config_.batch_size);
+        for (size_t i = begin; i < end; ++i) {
+            const MarketRecord& record = records[i];
+            release_until(record.timestamp_ns);
+            if (record.kind == MarketRecord::Kind::TRADE) {
+                account.last_price = price_to_double(record.price);
+                continue;
+            }
+            if (record.symbol != symbol) continue;
+            switch (record.kind) {
+            case MarketRecord::Kind::ADD:
+                engine.add_order(record.to_order());
+                break;
+            case MarketRecord::Kind::CANCEL:
+                // Fails harmlessly when strategy fills already took the order.
+                engine.cancel_order(record.order_id);
+                break;
+            case MarketRecord::Kind::MODIFY:
+                engine.modify_order(record.order_id, record.price, record.quantity);
+                break;
+            case MarketRecord::Kind::TRADE:
+                break;
+            }
+            ++result.engine_commands;
+        }
+
+        // The decision is made as of the batch's last record.
+        uint64_t decided_ns = records[end - 1].timestamp_ns;
+        uint64_t ticks = TscClock::now();
+        orders.clear();
+        size_t signals = strategy.generate_signals(Span<MarketRecord>(records.data() + begin, end - begin), orders);
+        size_t accepted = signals > 0 ? risk.filter_orders(orders) : 0;
+        decision_latency.record(TscClock::to_ns(TscClock::now() - ticks));
+        result.signals += signals;
+        result.risk_rejected += signals - accepted;
+        for (Order& order : orders) {
+            order.timestamp = ticks;  // emit_order leaves them unstamped
+            pending.push_back(PendingOrder{decided_ns + config_.order_latency_ns, order});
+        }
+        release_until(decided_ns);
+
+        double total = account.total();
+        account.peak = std::max(account.peak, total);
+        result.max_drawdown = std::max(result.max_drawdown, account.peak - total);
+    }
+    // Orders still in flight when the data ends arrive at the final book.
+    release_until(UINT64_MAX);
+    result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+    result.records = records.size();
+    if (!records.empty()) result.simulated_ns = records[records.size() - 1].timestamp_ns - records[0].timestamp_ns;
+    result.events_per_second = result.wall_seconds > 0 ? result.records / result.wall_seconds : 0.0;
+    result.position = account.position;
+    result.realized_pnl = account.realized;
+    result.total_pnl = account.total();
+    result.round_trips = account.round_trips;
+    result.winning_trips = account.winning_trips;
+    result.match_latency = engine.get_match_latency().stats();
+    result.decision_latency = decision_latency.stats();
+    return result;
+}
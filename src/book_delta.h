@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include "order_book.h"
+
+// Incremental L2 book update published by a MatchingEngine. Level events
+// carry the level's state after the command that changed it, so a reader
+// that applies them in order (keyed by side and price) rebuilds the book.
+struct BookDelta {
+    enum class Kind : uint8_t { LEVEL_ADD = 0, LEVEL_CHANGE = 1, LEVEL_DELETE = 2, TRADE = 3 };
+
+    uint64_t sequence;   // Per-engine, no gaps
+    Timestamp timestamp;
+    Price price;
+    Quantity quantity;   // Level total (0 on delete); traded size for TRADE
+    SymbolId symbol;
+    uint32_t orders;     // Orders resting at the level
+    Kind kind;
+    OrderSide side;      // Level side; the aggressor's side for TRADE
+    uint8_t reserved[6];
+};
+
+static_assert(sizeof(BookDelta) == 48, "BookDelta layout is shared with out-of-process readers");
+static_assert(std::is_trivially_copyable<BookDelta>::value, "BookDelta must be copyable into shared memory");
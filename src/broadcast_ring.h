@@ -0,0 +1,148 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include "lockfree_ring.h"
+#include "shared_memory.h"
+
+// Layout at the start of a broadcast ring's shared-memory region. Slots
+// follow at offset sizeof(BroadcastRingHeader).
+struct BroadcastRingHeader {
+    static constexpr uint32_t MAGIC = 0x5242584e;  // "NXBR"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t capacity;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head;  // Records ever written
+};
+
+// Single-writer, many-reader ring in shared memory. The writer never waits
+// for readers: each slot carries a sequence stamp (odd while being
+// written), and a reader that falls a full lap behind detects it, skips
+// ahead and counts what it missed. Writing costs one copy and two stores
+// no matter how many readers are attached.
+template <typename T>
+class BroadcastWriter {
+    static_assert(std::is_trivially_copyable<T>::value, "BroadcastWriter requires a trivially copyable type");
+public:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        T value;
+    };
+
+    static size_t region_size(size_t capacity) { return sizeof(BroadcastRingHeader) + capacity * sizeof(Slot); }
+
+    bool create(const std::string& name, size_t capacity) {
+        capacity = round_up_pow2(capacity);
+        if (!memory_.create(name, region_size(capacity))) return false;
+        header_ = new (memory_.data()) BroadcastRingHeader{BroadcastRingHeader::MAGIC, BroadcastRingHeader::VERSION,
+                                                           sizeof(T), 0, capacity, {0}};
+        slots_ = reinterpret_cast<Slot*>(static_cast<unsigned char*>(memory_.data()) + sizeof(BroadcastRingHeader));
+        for (size_t i = 0; i < capacity; ++i) new (&slots_[i].sequence) std::atomic<uint64_t>(0);
+        mask_ = capacity - 1;
+        head_ = 0;
+        return true;
+    }
+
+    void write(const T& value) {
+        Slot& slot = slots_[head_ & mask_];
+        slot.sequence.store(2 * head_ + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.value, &value, sizeof(T));
+        slot.sequence.store(2 * head_ + 2, std::memory_order_release);
+        header_->head.store(++head_, std::memory_order_release);
+    }
+
+    bool is_open() const { return header_ != nullptr; }
+    uint64_t written() const { return head_; }
+    const std::string& error() const { return memory_.error(); }
+private:
+    SharedMemory memory_;
+    BroadcastRingHeader* header_ = nullptr;
+    Slot* slots_ = nullptr;
+    size_t mask_ = 0;
+    uint64_t head_ = 0;
+};
+
+// One reader of a BroadcastWriter's ring; any number may attach, in this
+// process or another. Readers start at the oldest record still in the ring.
+template <typename T>
+class BroadcastReader {
+public:
+    using Slot = typename BroadcastWriter<T>::Slot;
+
+    bool open(const std::string& name) {
+        if (!memory_.open(name)) {
+            error_ = memory_.error();
+            return false;
+        }
+        header_ = static_cast<const BroadcastRingHeader*>(memory_.data());
+        if (memory_.size() < sizeof(BroadcastRingHeader) || header_->magic != BroadcastRingHeader::MAGIC ||
+            header_->version != BroadcastRingHeader::VERSION || header_->record_size != sizeof(T) ||
+            memory_.size() < BroadcastWriter<T>::region_size(header_->capacity)) {
+            memory_.close();
+            header_ = nullptr;
+            error_ = name + " is not a compatible broadcast ring";
+            return false;
+        }
+        slots_ = reinterpret_cast<const Slot*>(static_cast<const unsigned char*>(memory_.data()) + sizeof(BroadcastRingHeader));
+        mask_ = header_->capacity - 1;
+        uint64_t head = header_->head.load(std::memory_order_acquire);
+        cursor_ = head > header_->capacity ? head - header_->capacity : 0;
+        return true;
+    }
+
+    // Copies the next record into `out`; false if the reader is caught up.
+    bool poll(T& out) {
+        for (;;) {
+            const Slot& slot = slots_[cursor_ & mask_];
+            uint64_t expected = 2 * cursor_ + 2;
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before < expected) {
+                // A restarted writer re-creates the region from zero.
+                if (header_->head.load(std::memory_order_acquire) < cursor_) cursor_ = 0;
+                return false;
+            }
+            if (before == expected) {
+                std::memcpy(&out, &slot.value, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                    ++cursor_;
+                    return true;
+                }
+            }
+            // Lapped: jump to the oldest record the writer has not yet
+            // overwritten, leaving some slack for writes in flight.
+            uint64_t head = header_->head.load(std::memory_order_acquire);
+            uint64_t oldest = head - (mask_ + 1) / 2;
+            lost_ += oldest - cursor_;
+            cursor_ = oldest;
+        }
+    }
+
+    void close() {
+        memory_.close();
+        header_ = nullptr;
+        cursor_ = 0;
+        lost_ = 0;
+    }
+
+    uint64_t lost() const { return lost_; }
+    bool is_open() const { return header_ != nullptr; }
+    const std::string& error() const { return error_; }
+private:
+    SharedMemory memory_;
+    const BroadcastRingHeader* header_ = nullptr;
+    const Slot* slots_ = nullptr;
+    size_t mask_ = 0;
+    uint64_t cursor_ = 0;
+    uint64_t lost_ = 0;
+    std::string error_;
+};
@@ -0,0 +1,97 @@
+#include "chart_series.h"
+#include <algorithm>
+
+ChartSeries::ChartSeries(size_t capacity)
+    : capacity_(capacity > 1 ? capacity : 2), levels_(0), times_(capacity_), values_(capacity_) {
+    while ((size_t(2) << levels_) <= capacity_) ++levels_;
+    pyramid_.resize(levels_);
+    // One spare bucket per level: the oldest and newest retained buckets
+    // may both be partial and must not share a slot.
+    for (int k = 1; k <= levels_; ++k) pyramid_[k - 1].resize((capacity_ >> k) + 2);
+}
+
+void ChartSeries::append(int64_t time_ms, double value) {
+    if (!empty()) time_ms = std::max(time_ms, last_time());
+    uint64_t index = end_;
+    times_[index % capacity_] = time_ms;
+    values_[index % capacity_] = value;
+    for (int k = 1; k <= levels_; ++k) {
+        std::vector<Range>& level = pyramid_[k - 1];
+        Range& bucket = level[(index >> k) % level.size()];
+        if ((index & ((uint64_t(1) << k) - 1)) == 0) {
+            bucket = {value, value};
+        } else {
+            bucket.min = std::min(bucket.min, value);
+            bucket.max = std::max(bucket.max, value);
+        }
+    }
+    ++end_;
+    if (end_ - begin_ > capacity_) ++begin_;
+}
+
+void ChartSeries::clear() {
+    begin_ = end_ = 0;
+}
+
+uint64_t ChartSeries::lower_bound(uint64_t from, int64_t time_ms) const {
+    uint64_t lo = from, hi = end_;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (time_at(mid) < time_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+ChartSeries::Range ChartSeries::range(uint64_t a, uint64_t b) const {
+    Range out{value_at(a), value_at(a)};
+    while (a < b) {
+        // Largest aligned bucket starting at a that fits inside [a, b).
+        // Buckets starting at or after begin_ never include evicted samples.
+        int k = 0;
+        while (k < levels_ && (a & ((uint64_t(2) << k) - 1)) == 0 && a + (uint64_t(2) << k) <= b) ++k;
+        if (k == 0) {
+            double value = value_at(a);
+            out.min = std::min(out.min, value);
+            out.max = std::max(out.max, value);
+            ++a;
+            continue;
+        }
+        const std::vector<Range>& level = pyramid_[k - 1];
+        const Range& bucket = level[(a >> k) % level.size()];
+        out.min = std::min(out.min, bucket.min);
+        out.max = std::max(out.max, bucket.max);
+        a += uint64_t(1) << k;
+    }
+    return out;
+}
+
+bool ChartSeries::decimate(int64_t t0, int64_t t1, size_t columns, std::vector<ChartBucket>& out, double& lo,
+                           double& hi) const {
+    out.assign(columns, ChartBucket());
+    if (empty() || columns == 0 || t1 <= t0) return false;
+    bool any = false;
+    uint64_t start = lower_bound(begin_, t0);
+    double span = static_cast<double>(t1 - t0);
+    for (size_t column = 0; column < columns && start < end_; ++column) {
+        int64_t column_end = t0 + static_cast<int64_t>(span * (column + 1) / columns);
+        uint64_t stop = column + 1 == columns ? lower_bound(start, t1) : lower_bound(start, column_end);
+        if (stop == start) continue;
+        Range r = range(start, stop);
+        ChartBucket& bucket = out[column];
+        bucket = {r.min, r.max, value_at(start), value_at(stop - 1), true};
+        if (!any) {
+            lo = r.min;
+            hi = r.max;
+            any = true;
+        } else {
+            lo = std::min(lo, r.min);
+            hi = std::max(hi, r.max);
+        }
+        start = stop;
+    }
+    return any;
+}
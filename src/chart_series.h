@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One screen column of a decimated series: the value range inside it, and
+// the first/last samples so neighbouring columns can be joined.
+struct ChartBucket {
+    double min = 0.0;
+    double max = 0.0;
+    double first = 0.0;
+    double last = 0.0;
+    bool valid = false;
+};
+
+// Time-ordered (time, value) series for the GUI charts. Samples live in a
+// fixed ring, so a full session is kept until the capacity is reached and
+// the oldest samples are overwritten after that. Alongside it sits a
+// min/max pyramid: level k holds one bucket per 2^k samples, updated on
+// every append. Any index range [a, b) is covered by O(log n) aligned
+// buckets, so decimating to N columns costs O(N log n) however many
+// samples are visible. Qt-free so it can be exercised without a display.
+class ChartSeries {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = size_t(1) << 20;
+
+    explicit ChartSeries(size_t capacity = DEFAULT_CAPACITY);
+
+    // Samples must arrive in time order; earlier timestamps are clamped
+    // to the last one.
+    void append(int64_t time_ms, double value);
+    void clear();
+
+    size_t size() const { return static_cast<size_t>(end_ - begin_); }
+    bool empty() const { return end_ == begin_; }
+    size_t capacity() const { return capacity_; }
+    int64_t first_time() const { return time_at(begin_); }
+    int64_t last_time() const { return time_at(end_ - 1); }
+    double last_value() const { return value_at(end_ - 1); }
+
+    // Splits [t0, t1) into `columns` equal slices and fills one bucket per
+    // slice. Returns false when no sample falls in the window; lo/hi then
+    // hold the value range of what was drawn.
+    bool decimate(int64_t t0, int64_t t1, size_t columns, std::vector<ChartBucket>& out, double& lo,
+                  double& hi) const;
+private:
+    struct Range {
+        double min;
+        double max;
+    };
+
+    size_t capacity_;
+    int levels_;  // Pyramid levels above the raw samples
+    std::vector<int64_t> times_;
+    std::vector<double> values_;
+    std::vector<std::vector<Range>> pyramid_;  // pyramid_[k-1] is level k
+    // Absolute sample indices; the ring slot is index % capacity_.
+    uint64_t begin_ = 0;
+    uint64_t end_ = 0;
+
+    int64_t time_at(uint64_t index) const { return times_[index % capacity_]; }
+    double value_at(uint64_t index) const { return values_[index % capacity_]; }
+    uint64_t lower_bound(uint64_t from, int64_t time_ms) const;
+    Range range(uint64_t a, uint64_t b) const;
+};
@@ -12,27 +12,19 @@ ChartWidget::ChartWidget(QWidget* parent) : QWidget(parent) {
     minTime_ = QDateTime::currentDateTime();
     maxTime_ = minTime_.addSecs(60); // 1 minute window
     
-    // Set up timer for auto-refresh
+    // Repaints are coalesced to the refresh timer rather than issued per point
     QTimer* refreshTimer = new QTimer(this);
-    connect(refreshTimer, &QTimer::timeout, this, [this]() { update(); });
+    connect(refreshTimer, &QTimer::timeout, this, [this]() {
+        if (!dirty_) return;
+        dirty_ = false;
+        update();
+    });
     refreshTimer->start(100); // Update 10 times per second
 }
 
 void ChartWidget::addPricePoint(double price, const QDateTime& timestamp) {
-    DataPoint point(timestamp, price);
-    point.rsi = currentRSI_;
-    point.momentum = currentMomentum_;
-    point.macd = currentMACD_;
-    
-    dataPoints_.append(point);
-    
-    // Keep only last 200 points for performance
-    if (dataPoints_.size() > 200) {
-        dataPoints_.removeFirst();
-    }
-    
-    updateScales();
-    update();
+    series_.append(timestamp.toMSecsSinceEpoch(), price);
+    dirty_ = true;
 }
 
 void ChartWidget::addSignalPoint(double price, bool isBuy, const QDateTime& timestamp) {
@@ -50,30 +42,29 @@ void ChartWidget::addSignalPoint(double price, bool isBuy, const QDateTime& time
         signals_.removeFirst();
     }
     
-    update();
+    dirty_ = true;
 }
 
 void ChartWidget::updateIndicators(double rsi, double momentum, double macd) {
     currentRSI_ = rsi;
     currentMomentum_ = momentum;
     currentMACD_ = macd;
-    update();
+    dirty_ = true;
 }
 
 void ChartWidget::clearData() {
-    dataPoints_.clear();
+    series_.clear();
     signals_.clear();
     update();
 }
 
 void ChartWidget::paintEvent(QPaintEvent* event) {
     QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
     
     // Fill background
     painter.fillRect(rect(), backgroundColor_);
     
-    if (dataPoints_.isEmpty()) {
+    if (series_.empty()) {
         // Draw placeholder text
         painter.setPen(Qt::gray);
         painter.setFont(QFont("Arial", 16));
@@ -82,6 +73,7 @@ void ChartWidget::paintEvent(QPaintEvent* event) {
     }
     
     // Draw chart elements
+    updateScales();
     drawGrid(painter);
     drawPriceChart(painter);
     drawSignals(painter);
@@ -127,29 +119,34 @@ void ChartWidget::drawGrid(QPainter& painter) {
 }
 
 void ChartWidget::drawPriceChart(QPainter& painter) {
-    if (dataPoints_.size() < 2) return;
+    if (series_.size() < 2) return;
     
     painter.setPen(QPen(priceColor_, 2));
     
-    QPainterPath path;
-    bool first = true;
-    
-    for (const DataPoint& point : dataPoints_) {
-        QPointF screenPoint = dataToScreen(point.timestamp, point.price);
-        
-        if (first) {
-            path.moveTo(screenPoint);
-            first = false;
-        } else {
-            path.lineTo(screenPoint);
-        }
+    // One vertical min/max stroke per pixel column, joined to the previous
+    // column, so the cost depends on the width rather than the point count.
+    QVector<QLineF> lines;
+    lines.reserve(static_cast<int>(buckets_.size()) * 2);
+    QPointF previous;
+    bool havePrevious = false;
+    for (size_t column = 0; column < buckets_.size(); ++column) {
+        const ChartBucket& bucket = buckets_[column];
+        if (!bucket.valid) continue;
+        qreal x = marginLeft_ + static_cast<qreal>(column);
+        if (havePrevious) lines.append(QLineF(previous, QPointF(x, priceToY(bucket.first))));
+        lines.append(QLineF(x, priceToY(bucket.min), x, priceToY(bucket.max)));
+        previous = QPointF(x, priceToY(bucket.last));
+        havePrevious = true;
     }
     
-    painter.drawPath(path);
+    painter.drawLines(lines);
 }
 
 void ChartWidget::drawSignals(QPainter& painter) {
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing);
     for (const DataPoint& signal : signals_) {
+        if (signal.timestamp < minTime_) continue;
         QPointF screenPoint = dataToScreen(signal.timestamp, signal.price);
         
         // Draw signal marker
@@ -166,6 +163,7 @@ void ChartWidget::drawSignals(QPainter& painter) {
         QString signalText = signal.isBuySignal ? "B" : "S";
         painter.drawText(screenPoint.x() - 3, screenPoint.y() + 3, signalText);
     }
+    painter.restore();
 }
 
 void ChartWidget::drawIndicators(QPainter& painter) {
@@ -202,8 +200,8 @@ void ChartWidget::drawIndicators(QPainter& painter) {
                     QString("MACD: %1").arg(currentMACD_, 0, 'f', 2));
     
     // Current price
-    if (!dataPoints_.isEmpty()) {
-        double currentPrice = dataPoints_.last().price;
+    if (!series_.empty()) {
+        double currentPrice = series_.last_value();
         painter.setPen(priceColor_);
         painter.drawText(indicatorRect.x() + 380, indicatorRect.y() + 20, 
                         QString("Price: $%1").arg(currentPrice, 0, 'f', 2));
@@ -211,36 +209,40 @@ void ChartWidget::drawIndicators(QPainter& painter) {
 }
 
 void ChartWidget::updateScales() {
-    if (dataPoints_.isEmpty()) return;
+    if (series_.empty()) return;
     
-    // Update price scale
-    minPrice_ = dataPoints_.first().price;
-    maxPrice_ = dataPoints_.first().price;
+    // Update time scale: the whole session, or the zoomed span ending at
+    // the latest point
+    qint64 lastMs = series_.last_time();
+    qint64 firstMs = series_.first_time();
+    if (viewSpanMs_ > 0) firstMs = qMax(firstMs, lastMs - viewSpanMs_);
     
-    for (const DataPoint& point : dataPoints_) {
-        minPrice_ = qMin(minPrice_, point.price);
-        maxPrice_ = qMax(maxPrice_, point.price);
+    // Ensure minimum time range
+    if (lastMs - firstMs < 10000) { // Less than 10 seconds
+        lastMs = firstMs + 10000;
     }
+    minTime_ = QDateTime::fromMSecsSinceEpoch(firstMs);
+    maxTime_ = QDateTime::fromMSecsSinceEpoch(lastMs);
+    
+    // Update price scale from the decimated buckets that will be drawn
+    int chartWidth = qMax(1, width() - marginLeft_ - marginRight_);
+    double lo = 0;
+    double hi = 0;
+    if (!series_.decimate(firstMs, lastMs + 1, static_cast<size_t>(chartWidth), buckets_, lo, hi)) {
+        lo = hi = series_.last_value();
+    }
+    minPrice_ = lo;
+    maxPrice_ = hi;
     
     // Add some padding
     double priceRange = maxPrice_ - minPrice_;
     if (priceRange < 0.1) priceRange = 0.1;
     minPrice_ -= priceRange * 0.1;
     maxPrice_ += priceRange * 0.1;
-    
-    // Update time scale
-    minTime_ = dataPoints_.first().timestamp;
-    maxTime_ = dataPoints_.last().timestamp;
-    
-    // Ensure minimum time range
-    if (minTime_.msecsTo(maxTime_) < 10000) { // Less than 10 seconds
-        maxTime_ = minTime_.addMSecs(10000);
-    }
 }
 
 QPointF ChartWidget::dataToScreen(const QDateTime& timestamp, double value, bool isPrice) {
     int chartWidth = width() - marginLeft_ - marginRight_;
-    int chartHeight = height() - marginTop_ - marginBottom_;
     
     // Convert time to x coordinate
     qint64 timeRange = minTime_.msecsTo(maxTime_);
@@ -249,12 +251,15 @@ QPointF ChartWidget::dataToScreen(const QDateTime& timestamp, double value, bool
     int x = marginLeft_ + (timeOffset * chartWidth) / timeRange;
     
     // Convert price to y coordinate
+    return QPointF(x, priceToY(value));
+}
+
+qreal ChartWidget::priceToY(double price) const {
+    int chartHeight = height() - marginTop_ - marginBottom_;
     double priceRange = maxPrice_ - minPrice_;
     if (priceRange == 0) priceRange = 1;
-    double priceOffset = value - minPrice_;
-    int y = height() - marginBottom_ - (priceOffset * chartHeight) / priceRange;
-    
-    return QPointF(x, y);
+    double priceOffset = price - minPrice_;
+    return static_cast<int>(height() - marginBottom_ - (priceOffset * chartHeight) / priceRange);
 }
 
 QDateTime ChartWidget::screenToTime(int x) {
@@ -277,7 +282,7 @@ void ChartWidget::resizeEvent(QResizeEvent* event) {
 }
 
 void ChartWidget::mouseMoveEvent(QMouseEvent* event) {
-    if (dataPoints_.isEmpty()) return;
+    if (series_.empty()) return;
     
     QPoint pos = event->pos();
     if (pos.x() >= marginLeft_ && pos.x() <= width() - marginRight_ &&
@@ -292,4 +297,16 @@ void ChartWidget::mouseMoveEvent(QMouseEvent* event) {
         
         QToolTip::showText(event->globalPosition().toPoint(), tooltip, this);
     }
-} 
\ No newline at end of file
+}
+
+void ChartWidget::wheelEvent(QWheelEvent* event) {
+    if (series_.empty()) return;
+    
+    qint64 sessionMs = series_.last_time() - series_.first_time();
+    qint64 span = viewSpanMs_ > 0 ? viewSpanMs_ : sessionMs;
+    // Each notch halves or doubles the visible span
+    span = event->angleDelta().y() > 0 ? span / 2 : span * 2;
+    viewSpanMs_ = span >= sessionMs ? 0 : qMax<qint64>(span, 1000);
+    event->accept();
+    update();
+}
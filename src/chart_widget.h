@@ -8,6 +8,9 @@
 #include <QDateTime>
 #include <QMouseEvent>
 #include <QToolTip>
+#include <QWheelEvent>
+#include <vector>
+#include "chart_series.h"
 
 struct DataPoint {
     QDateTime timestamp;
@@ -22,6 +25,11 @@ struct DataPoint {
     DataPoint(const QDateTime& t, double p) : timestamp(t), price(p), rsi(50), momentum(0), macd(0), isSignal(false), isBuySignal(false) {}
 };
 
+// Live price chart. Prices go into a ChartSeries holding the whole
+// session; each repaint decimates the visible window to one bucket per
+// pixel column. Appends only mark the chart dirty, and the refresh timer
+// repaints at most once per tick. The wheel zooms the window, which stays
+// anchored to the latest price.
 class ChartWidget : public QWidget {
     Q_OBJECT
 
@@ -37,6 +45,7 @@ protected:
     void paintEvent(QPaintEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
 
 private:
     void drawPriceChart(QPainter& painter);
@@ -45,11 +54,15 @@ private:
     void drawGrid(QPainter& painter);
     void updateScales();
     QPointF dataToScreen(const QDateTime& timestamp, double value, bool isPrice = true);
+    qreal priceToY(double price) const;
     QDateTime screenToTime(int x);
     double screenToPrice(int y);
     
-    QVector<DataPoint> dataPoints_;
+    ChartSeries series_;
+    std::vector<ChartBucket> buckets_;  // Reused across repaints
     QVector<DataPoint> signals_;
+    bool dirty_ = false;
+    qint64 viewSpanMs_ = 0;  // 0 shows the whole session
     
     // Chart dimensions
     int marginLeft_ = 80;
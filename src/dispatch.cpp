@@ -0,0 +1,38 @@
+#include "dispatch.h"
+
+OrderedDispatcher::OrderedDispatcher(ThreadPool& pool, size_t num_strands, size_t mailbox_capacity)
+    : pool_(pool) {
+    if (num_strands == 0) num_strands = 1;
+    strands_.reserve(num_strands);
+    for (size_t i = 0; i < num_strands; ++i) {
+        strands_.push_back(std::make_unique<Strand>(mailbox_capacity));
+    }
+}
+
+void OrderedDispatcher::post_task(size_t index, InplaceTask&& task) {
+    Strand& strand = *strands_[index];
+    while (!strand.mailbox.try_push(std::move(task))) std::this_thread::yield();
+    // Whoever takes pending from 0 to 1 owns the strand until it drains.
+    if (strand.pending.fetch_add(1, std::memory_order_acq_rel) == 0) schedule(index);
+}
+
+void OrderedDispatcher::schedule(size_t index) {
+    // Strands map to a home worker for cache affinity; stealing may still
+    // move a turn elsewhere, which is safe because only one turn is live.
+    pool_.enqueue_to(index % pool_.size(), [this, index]() { run(index); });
+}
+
+void OrderedDispatcher::run(size_t index) {
+    Strand& strand = *strands_[index];
+    InplaceTask task;
+    for (size_t done = 0; done < RUN_BUDGET; ++done) {
+        // pending counts tasks already pushed, so the pop only waits out a
+        // producer that is mid-publish.
+        while (!strand.mailbox.try_pop(task)) cpu_relax();
+        task();
+        task.reset();
+        if (strand.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) return;
+    }
+    // Budget spent with work left: requeue so other strands get a turn.
+    schedule(index);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "threading.h"
+#include "lockfree_ring.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Ordered per-key dispatch on top of ThreadPool. Each key hashes to a
+// strand: a mailbox whose tasks run one at a time in submission order, on
+// whichever worker picks the strand up. Different strands run in parallel,
+// so state owned by one key never needs a lock.
+class OrderedDispatcher {
+public:
+    OrderedDispatcher(ThreadPool& pool, size_t num_strands, size_t mailbox_capacity = 1024);
+    OrderedDispatcher(const OrderedDispatcher&) = delete;
+    OrderedDispatcher& operator=(const OrderedDispatcher&) = delete;
+
+    template <typename F>
+    void post(uint64_t key, F&& task) { post_task(strand_of(key), InplaceTask(std::forward<F>(task))); }
+
+    size_t strand_of(uint64_t key) const { return static_cast<size_t>(key % strands_.size()); }
+    size_t num_strands() const { return strands_.size(); }
+private:
+    struct alignas(CACHE_LINE_SIZE) Strand {
+        explicit Strand(size_t capacity) : mailbox(capacity) {}
+        MpscRing<InplaceTask> mailbox;
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> pending{0};
+    };
+    static constexpr size_t RUN_BUDGET = 64;  // Tasks per turn before yielding the worker
+
+    ThreadPool& pool_;
+    std::vector<std::unique_ptr<Strand>> strands_;
+
+    void post_task(size_t strand, InplaceTask&& task);
+    void schedule(size_t strand);
+    void run(size_t strand);
+};
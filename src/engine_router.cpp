@@ -0,0 +1,270 @@
+#include "engine_router.h"
+#include "threading.h"
+#include <algorithm>
+#include <fstream>
+
+EngineRouter::EngineRouter(const RouterConfig& config) : config_(config) {
+    size_t num_shards = config.num_shards > 0 ? config.num_shards : 1;
+    engines_.resize(config.num_symbols);
+    shards_.resize(num_shards);
+    for (size_t i = 0; i < num_shards; ++i) {
+        run_on_cpu(shard_cpu(i), [&]() {
+            shards_[i] = std::make_unique<Shard>(config.ingress_capacity);
+            for (size_t symbol = i; symbol < config.num_symbols; symbol += num_shards) {
+                EngineConfig engine_config = config.engine;
+                engine_config.symbol = static_cast<SymbolId>(symbol);
+                engines_[symbol] = std::make_unique<MatchingEngine>(engine_config);
+            }
+        });
+    }
+}
+
+int EngineRouter::shard_cpu(size_t shard) const {
+    if (!config_.shard_cpus.empty()) return config_.shard_cpus[shard % config_.shard_cpus.size()];
+    return config_.first_cpu >= 0 ? config_.first_cpu + static_cast<int>(shard) : -1;
+}
+
+EngineRouter::~EngineRouter() {
+    stop();
+}
+
+bool EngineRouter::open_delta_rings(const std::string& prefix, size_t capacity) {
+    for (size_t i = 0; i < engines_.size(); ++i) {
+        if (!engines_[i]->open_delta_ring(prefix + "." + std::to_string(i), capacity)) {
+            delta_error_ = engines_[i]->get_delta_error();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EngineRouter::recover(const std::string& prefix, RecoveryStats& recovered) {
+    recovered = RecoveryStats();
+    for (size_t i = 0; i < engines_.size(); ++i) {
+        std::string path = prefix + "." + std::to_string(i);
+        SnapshotHeader snapshot;
+        if (std::ifstream(path + ".snap")) {
+            if (!engines_[i]->restore_snapshot(path + ".snap", snapshot)) {
+                journal_error_ = engines_[i]->get_snapshot_error();
+                return false;
+            }
+            ++recovered.snapshots;
+            recovered.snapshot_orders += snapshot.bid_orders + snapshot.ask_orders;
+        }
+        if (!std::ifstream(path)) continue;
+        JournalReplayStats stats;
+        if (!replay_journal(path, *engines_[i], stats, journal_error_, snapshot.journal_sequence)) return false;
+        JournalReplayStats& total = recovered.journal;
+        total.entries += stats.entries;
+        total.adds += stats.adds;
+        total.cancels += stats.cancels;
+        total.modifies += stats.modifies;
+        total.truncated = total.truncated || stats.truncated;
+    }
+    return true;
+}
+
+bool EngineRouter::open_journals(const std::string& prefix, const JournalConfig& config) {
+    for (size_t i = 0; i < engines_.size(); ++i) {
+        if (!engines_[i]->open_journal(prefix + "." + std::to_string(i), config)) {
+            journal_error_ = engines_[i]->get_journal_error();
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t EngineRouter::request_snapshots(const std::string& prefix) {
+    size_t started = 0;
+    for (size_t i = 0; i < engines_.size(); ++i) {
+        if (engines_[i]->request_snapshot(prefix + "." + std::to_string(i) + ".snap")) ++started;
+    }
+    return started;
+}
+
+bool EngineRouter::save_snapshots(const std::string& prefix) {
+    for (size_t i = 0; i < engines_.size(); ++i) {
+        if (!engines_[i]->save_snapshot(prefix + "." + std::to_string(i) + ".snap")) {
+            journal_error_ = engines_[i]->get_snapshot_error();
+            return false;
+        }
+    }
+    return true;
+}
+
+void EngineRouter::start() {
+    if (running_.exchange(true)) return;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        shards_[i]->thread = std::thread(&EngineRouter::shard_loop, this, std::ref(*shards_[i]), shard_cpu(i));
+    }
+}
+
+void EngineRouter::stop() {
+    running_ = false;
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+}
+
+void EngineRouter::submit_order(const Order& order, TraceContext* trace) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::ADD;
+    command.order = order;
+    command.trace = trace;
+    if (trace && order.symbol >= engines_.size()) trace->finish();  // Dropped, so it ends here
+    push(order.symbol, command);
+}
+
+void EngineRouter::submit_batch(Span<Order> orders, TraceContext* trace) {
+    bool running = running_.load(std::memory_order_acquire);
+    // Running: runs share a shard ring. Not started: runs share a book.
+    auto same_run = [&](SymbolId a, SymbolId b) {
+        return b < engines_.size() && (running ? shard_of(a) == shard_of(b) : a == b);
+    };
+    std::vector<EngineCommand> commands;
+    // Rides on the first command actually routed; skipped orders do not take it.
+    TraceContext* pending_trace = trace;
+    size_t start = 0;
+    while (start < orders.size()) {
+        SymbolId symbol = orders[start].symbol;
+        if (symbol >= engines_.size()) {
+            ++start;
+            continue;
+        }
+        size_t end = start + 1;
+        while (end < orders.size() && same_run(symbol, orders[end].symbol)) ++end;
+        auto command_at = [&](size_t i) {
+            EngineCommand command;
+            command.order = orders[start + i];
+            command.trace = pending_trace;
+            pending_trace = nullptr;
+            return command;
+        };
+        if (running) {
+            auto& ring = shards_[shard_of(symbol)]->ingress;
+            end = std::min(end, start + ring.capacity());
+            while (!ring.try_push_n(end - start, command_at)) std::this_thread::yield();
+        } else {
+            commands.clear();
+            for (size_t i = 0; i < end - start; ++i) commands.push_back(command_at(i));
+            engines_[symbol]->execute(commands);
+        }
+        start = end;
+    }
+    if (pending_trace) pending_trace->finish();
+}
+
+void EngineRouter::submit_cancel(SymbolId symbol, OrderId order_id) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::CANCEL;
+    command.order.order_id = order_id;
+    command.order.symbol = symbol;
+    push(symbol, command);
+}
+
+void EngineRouter::submit_modify(SymbolId symbol, OrderId order_id, Price new_price, Quantity new_quantity) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::MODIFY;
+    command.order.order_id = order_id;
+    command.order.symbol = symbol;
+    command.order.price = new_price;
+    command.order.quantity = new_quantity;
+    push(symbol, command);
+}
+
+void EngineRouter::push(SymbolId symbol, const EngineCommand& command) {
+    if (symbol >= engines_.size()) return;
+    if (!running_.load(std::memory_order_acquire)) {
+        // Not started: apply synchronously on the caller's thread.
+        engines_[symbol]->execute(command);
+        return;
+    }
+    auto& ring = shards_[shard_of(symbol)]->ingress;
+    while (!ring.try_push(command)) std::this_thread::yield();
+}
+
+// Drains up to MAX_BATCH commands at a time and applies each run of
+// same-symbol commands under one lock acquisition of that book.
+void EngineRouter::shard_loop(Shard& shard, int cpu) {
+    place_current_thread(cpu, config_.fifo_priority);
+    constexpr size_t MAX_BATCH = 256;
+    EngineCommand command;
+    std::vector<EngineCommand> batch;
+    batch.reserve(MAX_BATCH);
+    IdleWaiter waiter(config_.wait);
+    auto apply = [&]() {
+        uint64_t counts[3] = {0, 0, 0};
+        for (size_t start = 0; start < batch.size();) {
+            SymbolId symbol = batch[start].order.symbol;
+            size_t end = start;
+            for (; end < batch.size() && batch[end].order.symbol == symbol; ++end) {
+                ++counts[static_cast<size_t>(batch[end].kind)];
+            }
+            engines_[symbol]->execute(Span<EngineCommand>(batch.data() + start, end - start));
+            start = end;
+        }
+        shard.orders.fetch_add(counts[static_cast<size_t>(EngineCommand::Kind::ADD)], std::memory_order_relaxed);
+        shard.cancels.fetch_add(counts[static_cast<size_t>(EngineCommand::Kind::CANCEL)], std::memory_order_relaxed);
+        shard.modifies.fetch_add(counts[static_cast<size_t>(EngineCommand::Kind::MODIFY)], std::memory_order_relaxed);
+        batch.clear();
+    };
+    while (running_.load(std::memory_order_acquire)) {
+        if (!shard.ingress.try_pop(command)) {
+            waiter.idle();
+            continue;
+        }
+        waiter.reset();
+        do {
+            batch.push_back(command);
+        } while (batch.size() < MAX_BATCH && shard.ingress.try_pop(command));
+        apply();
+    }
+    while (shard.ingress.try_pop(command)) {
+        batch.push_back(command);
+        if (batch.size() == MAX_BATCH) apply();
+    }
+    apply();
+}
+
+void EngineRouter::set_participant_callback(ParticipantId participant, const TradeCallback& callback) {
+    for (auto& engine : engines_) engine->set_participant_callback(participant, callback);
+}
+
+void EngineRouter::set_unfilled_callback(ParticipantId participant, const OrderCallback& callback) {
+    for (auto& engine : engines_) engine->set_unfilled_callback(participant, callback);
+}
+
+ShardStats EngineRouter::get_shard_stats(size_t shard) const {
+    ShardStats stats;
+    stats.orders = shards_[shard]->orders.load(std::memory_order_relaxed);
+    stats.cancels = shards_[shard]->cancels.load(std::memory_order_relaxed);
+    stats.modifies = shards_[shard]->modifies.load(std::memory_order_relaxed);
+    for (size_t symbol = shard; symbol < engines_.size(); symbol += shards_.size()) {
+        stats.trades += engines_[symbol]->get_matched_trades();
+    }
+    return stats;
+}
+
+uint64_t EngineRouter::get_processed_orders() const {
+    uint64_t total = 0;
+    for (const auto& engine : engines_) total += engine->get_processed_orders();
+    return total;
+}
+
+uint64_t EngineRouter::get_matched_trades() const {
+    uint64_t total = 0;
+    for (const auto& engine : engines_) total += engine->get_matched_trades();
+    return total;
+}
+
+uint64_t EngineRouter::get_self_trades_prevented() const {
+    uint64_t total = 0;
+    for (const auto& engine : engines_) total += engine->get_self_trades_prevented();
+    return total;
+}
+
+LatencyStats EngineRouter::get_match_latency() const {
+    LatencyHistogram merged;
+    for (const auto& engine : engines_) merged.merge(engine->get_match_latency());
+    return merged.stats();
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "matching_engine.h"
+#include "lockfree_ring.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct RouterConfig {
+    size_t num_symbols = 1;              // Books are created for symbols [0, num_symbols)
+    size_t num_shards = 1;               // Matcher threads; symbol s runs on shard s % num_shards
+    int first_cpu = -1;                  // Shard i pins to first_cpu + i (-1 = unpinned)
+    std::vector<int> shard_cpus;         // Overrides first_cpu: shard i pins to shard_cpus[i % size]
+    int fifo_priority = 0;               // SCHED_FIFO priority for matcher threads (0 = default scheduler)
+    WaitMode wait = WaitMode::SPIN_YIELD;  // Shard idle policy when its ring is empty
+    size_t ingress_capacity = 1 << 16;   // Command ring size per shard
+    EngineConfig engine;                 // Book configuration applied to every symbol
+};
+
+struct RecoveryStats {
+    uint64_t snapshots = 0;        // Books loaded from a snapshot
+    uint64_t snapshot_orders = 0;  // Resting orders those snapshots held
+    JournalReplayStats journal;    // Journal tail replayed on top, summed over books
+};
+
+struct ShardStats {
+    uint64_t orders = 0;
+    uint64_t cancels = 0;
+    uint64_t modifies = 0;
+    uint64_t trades = 0;
+};
+
+// Owns one MatchingEngine per symbol and shards the symbols across matcher
+// threads. Each shard has its own command ring and is the only writer of
+// its books, so the per-book locks are never contended. A pinned shard's
+// books and ring are built on its CPU, so they are local to its NUMA node.
+class EngineRouter {
+public:
+    explicit EngineRouter(const RouterConfig& config);
+    ~EngineRouter();
+    EngineRouter(const EngineRouter&) = delete;
+    EngineRouter& operator=(const EngineRouter&) = delete;
+
+    // Opens one BookDelta ring per symbol, named "<prefix>.<symbol>"
+    // (e.g. "/nanoex.book.0"). Call before start().
+    bool open_delta_rings(const std::string& prefix, size_t capacity);
+    const std::string& get_delta_error() const { return delta_error_; }
+    // Rebuilds each book from its latest snapshot "<prefix>.<symbol>.snap"
+    // and the tail of its journal "<prefix>.<symbol>" after it, whichever
+    // exist. Call before open_journals() and start().
+    bool recover(const std::string& prefix, RecoveryStats& recovered);
+    bool open_journals(const std::string& prefix, const JournalConfig& config = JournalConfig());
+    // Starts a background snapshot of every book (see
+    // MatchingEngine::request_snapshot); books still writing the previous
+    // one are skipped. Returns how many were started.
+    size_t request_snapshots(const std::string& prefix);
+    bool save_snapshots(const std::string& prefix);
+    const std::string& get_journal_error() const { return journal_error_; }
+    void start();
+    void stop();  // Stop every producer first, as for MatchingEngine::stop()
+    // A sampled order's `trace` is stamped and finished by the matcher.
+    void submit_order(const Order& order, TraceContext* trace = nullptr);
+    // Routes a batch with one ring claim per run of orders bound for the
+    // same shard; `trace`, if any, follows the first order with a valid
+    // symbol and is finished here if there is none. Before start()
+    // each run of same-symbol orders is applied under one book lock.
+    void submit_batch(Span<Order> orders, TraceContext* trace = nullptr);
+    void submit_cancel(SymbolId symbol, OrderId order_id);
+    void submit_modify(SymbolId symbol, OrderId order_id, Price new_price, Quantity new_quantity);
+
+    // Registers `callback` for `participant` on every book. It runs on the
+    // shard thread that owns the book, so it must be thread-safe when
+    // there is more than one shard.
+    void set_participant_callback(ParticipantId participant, const TradeCallback& callback);
+    // Same, for MatchingEngine::set_unfilled_callback.
+    void set_unfilled_callback(ParticipantId participant, const OrderCallback& callback);
+
+    size_t num_symbols() const { return engines_.size(); }
+    size_t num_shards() const { return shards_.size(); }
+    size_t shard_of(SymbolId symbol) const { return symbol % shards_.size(); }
+    MatchingEngine& engine(SymbolId symbol) { return *engines_[symbol]; }
+    const MatchingEngine& engine(SymbolId symbol) const { return *engines_[symbol]; }
+
+    ShardStats get_shard_stats(size_t shard) const;
+    uint64_t get_processed_orders() const;
+    uint64_t get_matched_trades() const;
+    uint64_t get_self_trades_prevented() const;
+    // Match time merged across every symbol's engine.
+    LatencyStats get_match_latency() const;
+private:
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        explicit Shard(size_t capacity) : ingress(capacity) {}
+        MpscRing<EngineCommand> ingress;
+        std::thread thread;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> orders{0};
+        std::atomic<uint64_t> cancels{0};
+        std::atomic<uint64_t> modifies{0};
+    };
+    RouterConfig config_;
+    std::vector<std::unique_ptr<MatchingEngine>> engines_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> running_{false};
+    std::string delta_error_;
+    std::string journal_error_;
+    int shard_cpu(size_t shard) const;
+    void shard_loop(Shard& shard, int cpu);
+    void push(SymbolId symbol, const EngineCommand& command);
+};
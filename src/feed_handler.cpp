@@ -0,0 +1,189 @@
+#include "feed_handler.h"
+#include "lockfree_ring.h"
+#include "threading.h"
+#include "tsc_clock.h"
+#include <algorithm>
+#include <cstring>
+
+FeedHandler::FeedHandler(const FeedConfig& config)
+    : config_(config),
+      pending_(std::max<size_t>(config.max_pending, 1)),
+      pending_records_(new MarketRecord[pending_.size() * MAX_RECORDS_PER_PACKET]) {
+    // One poll of both feeds plus everything held back by a gap fits
+    // without reallocating.
+    records_.reserve((2 * PacketBatch::MAX_PACKETS + pending_.size()) * MAX_RECORDS_PER_PACKET);
+}
+
+FeedHandler::~FeedHandler() { stop(); }
+
+bool FeedHandler::start(MarketRecordCallback callback) {
+    auto a = std::make_unique<UdpMulticastSource>(config_.feed_a);
+    if (!a->open()) {
+        error_ = "feed A: " + a->error();
+        return false;
+    }
+    std::unique_ptr<UdpMulticastSource> b;
+    if (config_.feed_b.port != 0) {
+        b = std::make_unique<UdpMulticastSource>(config_.feed_b);
+        if (!b->open()) {
+            error_ = "feed B: " + b->error();
+            return false;
+        }
+    }
+    start(std::move(a), std::move(b), std::move(callback));
+    return true;
+}
+
+void FeedHandler::start(std::unique_ptr<PacketSource> a, std::unique_ptr<PacketSource> b, MarketRecordCallback callback) {
+    source_a_ = std::move(a);
+    source_b_ = std::move(b);
+    callback_ = std::move(callback);
+    synced_ = false;
+    running_ = true;
+    thread_ = std::thread(&FeedHandler::run, this);
+}
+
+void FeedHandler::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+}
+
+FeedStats FeedHandler::get_stats() const {
+    FeedStats stats;
+    stats.packets_a = counters_.packets_a.load(std::memory_order_relaxed);
+    stats.packets_b = counters_.packets_b.load(std::memory_order_relaxed);
+    stats.records = counters_.records.load(std::memory_order_relaxed);
+    stats.duplicates = counters_.duplicates.load(std::memory_order_relaxed);
+    stats.gaps = counters_.gaps.load(std::memory_order_relaxed);
+    stats.lost = counters_.lost.load(std::memory_order_relaxed);
+    stats.malformed = counters_.malformed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FeedHandler::run() {
+    place_current_thread(config_.cpu, config_.fifo_priority);
+    uint64_t timeout_ticks = static_cast<uint64_t>(config_.gap_timeout_us * 1000.0 / TscClock::ns_per_tick());
+    // Blocking mode sleeps at most a poll interval; the sockets are
+    // non-blocking, so gap timeouts keep being checked either way.
+    IdleWaiter waiter(config_.wait, IdleWaiter::DEFAULT_SPINS, 10);
+    while (running_) {
+        size_t received = poll(*source_a_, counters_.packets_a);
+        if (source_b_) received += poll(*source_b_, counters_.packets_b);
+        if (pending_count_ > 0 && TscClock::now() - gap_start_ticks_ > timeout_ticks) skip_gap();
+        flush();
+        if (received == 0) {
+            waiter.idle();
+        } else {
+            waiter.reset();
+        }
+    }
+}
+
+size_t FeedHandler::poll(PacketSource& source, std::atomic<uint64_t>& packets) {
+    size_t count = source.receive(batch_);
+    for (size_t i = 0; i < count; ++i) on_packet(batch_.packet(i), batch_.lengths[i]);
+    if (count > 0) bump(packets, count);
+    return count;
+}
+
+void FeedHandler::on_packet(const uint8_t* data, size_t length) {
+    FeedPacketHeader header;
+    if (length < sizeof(header)) {
+        bump(counters_.malformed);
+        return;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.record_size != sizeof(MarketRecord) || header.count > MAX_RECORDS_PER_PACKET ||
+        length < sizeof(header) + header.count * sizeof(MarketRecord)) {
+        bump(counters_.malformed);
+        return;
+    }
+    const uint8_t* payload = data + sizeof(header);
+    if (!synced_) {
+        // Join mid-stream at whatever arrives first.
+        expected_ = header.sequence;
+        synced_ = true;
+    }
+    uint64_t end = header.sequence + header.count;
+    if (end <= expected_) {
+        bump(counters_.duplicates);
+        return;
+    }
+    if (header.sequence <= expected_) {
+        append(header.sequence, payload, header.count);
+        if (pending_count_ > 0) release_pending();
+        return;
+    }
+    hold(header.sequence, payload, header.count);
+}
+
+void FeedHandler::append(uint64_t sequence, const uint8_t* payload, size_t count) {
+    // Drop the overlap with what the other feed already delivered.
+    size_t skip = static_cast<size_t>(expected_ - sequence);
+    size_t offset = records_.size();
+    records_.resize(offset + count - skip);
+    std::memcpy(records_.data() + offset, payload + skip * sizeof(MarketRecord), (count - skip) * sizeof(MarketRecord));
+    expected_ = sequence + count;
+    if (records_.size() + MAX_RECORDS_PER_PACKET > records_.capacity()) flush();
+}
+
+void FeedHandler::hold(uint64_t sequence, const uint8_t* payload, size_t count) {
+    for (const Pending& pending : pending_) {
+        if (pending.used && pending.sequence == sequence && pending.count >= count) {
+            bump(counters_.duplicates);
+            return;
+        }
+    }
+    if (pending_count_ == pending_.size()) skip_gap();
+    if (pending_count_ == 0) gap_start_ticks_ = TscClock::now();
+    size_t slot = 0;
+    while (pending_[slot].used) ++slot;
+    pending_[slot] = Pending{sequence, static_cast<uint32_t>(count), true};
+    std::memcpy(&pending_records_[slot * MAX_RECORDS_PER_PACKET], payload, count * sizeof(MarketRecord));
+    ++pending_count_;
+    // skip_gap() may have advanced past this packet already.
+    release_pending();
+}
+
+void FeedHandler::release_pending() {
+    bool released = false;
+    bool progressed = true;
+    while (progressed && pending_count_ > 0) {
+        progressed = false;
+        for (size_t slot = 0; slot < pending_.size(); ++slot) {
+            Pending& pending = pending_[slot];
+            if (!pending.used || pending.sequence > expected_) continue;
+            if (pending.sequence + pending.count > expected_) {
+                append(pending.sequence, reinterpret_cast<const uint8_t*>(&pending_records_[slot * MAX_RECORDS_PER_PACKET]),
+                       pending.count);
+            } else {
+                bump(counters_.duplicates);
+            }
+            pending.used = false;
+            --pending_count_;
+            progressed = true;
+            released = true;
+        }
+    }
+    // Whatever is still held now waits on a new gap.
+    if (released && pending_count_ > 0) gap_start_ticks_ = TscClock::now();
+}
+
+void FeedHandler::skip_gap() {
+    uint64_t next = UINT64_MAX;
+    for (const Pending& pending : pending_) {
+        if (pending.used) next = std::min(next, pending.sequence);
+    }
+    if (next == UINT64_MAX || next <= expected_) return;
+    bump(counters_.gaps);
+    bump(counters_.lost, next - expected_);
+    expected_ = next;
+    release_pending();
+}
+
+void FeedHandler::flush() {
+    if (records_.empty()) return;
+    bump(counters_.records, records_.size());
+    callback_(Span<MarketRecord>(records_.data(), records_.size()));
+    records_.clear();
+}
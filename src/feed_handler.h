@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "market_data.h"
+#include "market_record.h"
+#include "packet_source.h"
+#include "udp_multicast_source.h"
+#include "wait_strategy.h"
+
+// Wire format of one feed datagram: a header followed by `count`
+// MarketRecords. `sequence` numbers the first record; the next packet on
+// the stream starts at sequence + count. A and B carry the same sequence
+// space but may packetize it differently.
+struct FeedPacketHeader {
+    uint64_t sequence;
+    uint16_t count;
+    uint16_t record_size;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FeedPacketHeader) == 16, "FeedPacketHeader layout is part of the wire format");
+
+struct FeedConfig {
+    UdpEndpoint feed_a;
+    UdpEndpoint feed_b;             // port 0 = no B feed
+    size_t max_pending = 64;        // Out-of-order packets held while a gap is open
+    uint32_t gap_timeout_us = 500;  // Wait this long for the other feed to fill a gap
+    int cpu = -1;                   // Pin the receive thread (-1 = don't)
+    int fifo_priority = 0;          // SCHED_FIFO priority for it (0 = default scheduler)
+    WaitMode wait = WaitMode::BUSY_POLL;  // Between empty polls of both sockets
+};
+
+struct FeedStats {
+    uint64_t packets_a = 0;
+    uint64_t packets_b = 0;
+    uint64_t records = 0;      // Delivered, in sequence
+    uint64_t duplicates = 0;   // Packets already seen on the other feed
+    uint64_t gaps = 0;         // Gaps neither feed filled in time
+    uint64_t lost = 0;         // Records skipped over by those gaps
+    uint64_t malformed = 0;
+};
+
+// Multicast market-data ingest. One busy-polling thread drains the A and B
+// sources, arbitrates them into a single gap-free sequence (first copy
+// wins, later copies are dropped), and decodes records into a buffer
+// allocated once up front. Packets ahead of a gap are held until either
+// feed fills it, or until the timeout, at which point the gap is counted
+// as lost and delivery resumes.
+//
+// The callback follows the MarketData contract, but each span is only
+// valid for the duration of the call.
+class FeedHandler {
+public:
+    using MarketRecordCallback = MarketData::MarketRecordCallback;
+
+    explicit FeedHandler(const FeedConfig& config);
+    ~FeedHandler();
+    FeedHandler(const FeedHandler&) = delete;
+    FeedHandler& operator=(const FeedHandler&) = delete;
+
+    // Joins the configured UDP groups and starts receiving.
+    bool start(MarketRecordCallback callback);
+    // Receives from caller-supplied backends instead; `b` may be null.
+    void start(std::unique_ptr<PacketSource> a, std::unique_ptr<PacketSource> b, MarketRecordCallback callback);
+    void stop();
+
+    FeedStats get_stats() const;
+    const std::string& get_error() const { return error_; }
+private:
+    struct Pending {
+        uint64_t sequence = 0;
+        uint32_t count = 0;
+        bool used = false;
+    };
+    struct alignas(CACHE_LINE_SIZE) Counters {
+        std::atomic<uint64_t> packets_a{0};
+        std::atomic<uint64_t> packets_b{0};
+        std::atomic<uint64_t> records{0};
+        std::atomic<uint64_t> duplicates{0};
+        std::atomic<uint64_t> gaps{0};
+        std::atomic<uint64_t> lost{0};
+        std::atomic<uint64_t> malformed{0};
+    };
+    static constexpr size_t MAX_RECORDS_PER_PACKET =
+        (PacketBatch::MTU - sizeof(FeedPacketHeader)) / sizeof(MarketRecord);
+
+    FeedConfig config_;
+    std::unique_ptr<PacketSource> source_a_;
+    std::unique_ptr<PacketSource> source_b_;
+    PacketBatch batch_;
+    std::vector<MarketRecord> records_;
+    std::vector<Pending> pending_;
+    std::unique_ptr<MarketRecord[]> pending_records_;
+    size_t pending_count_ = 0;
+    uint64_t gap_start_ticks_ = 0;
+    uint64_t expected_ = 0;
+    bool synced_ = false;
+    Counters counters_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::string error_;
+    MarketRecordCallback callback_;
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    void run();
+    size_t poll(PacketSource& source, std::atomic<uint64_t>& packets);
+    void on_packet(const uint8_t* data, size_t length);
+    void append(uint64_t sequence, const uint8_t* payload, size_t count);
+    void hold(uint64_t sequence, const uint8_t* payload, size_t count);
+    void release_pending();
+    void skip_gap();
+    void flush();
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Fixed-point decimal whose integer representation counts ticks of
+// 1/SCALE units, with the scale fixed at compile time. The tag keeps
+// prices and quantities from mixing; Rep may be 32-bit for compact storage
+// where a book's range allows (see narrow()).
+template <typename Tag, uint64_t Scale, typename Rep = uint64_t>
+class Fixed {
+    static_assert(std::is_unsigned<Rep>::value, "ticks are unsigned");
+    static_assert(Scale > 0, "scale must be positive");
+public:
+    using rep = Rep;
+    static constexpr uint64_t SCALE = Scale;
+
+    constexpr Fixed() = default;
+    static constexpr Fixed from_ticks(Rep ticks) { return Fixed(ticks); }
+    // Rounds to the nearest tick; negative values clamp to zero.
+    static Fixed from_double(double value) {
+        long long ticks = std::llround(value * static_cast<double>(Scale));
+        return Fixed(ticks <= 0 ? 0 : static_cast<Rep>(ticks));
+    }
+
+    constexpr Rep ticks() const { return ticks_; }
+    constexpr double to_double() const { return static_cast<double>(ticks_) / static_cast<double>(Scale); }
+
+    // Same quantity at a finer scale (exact) or wider storage.
+    template <uint64_t ToScale, typename ToRep = Rep>
+    constexpr Fixed<Tag, ToScale, ToRep> rescale() const {
+        static_assert(ToScale % Scale == 0, "rescale only to a multiple of the scale; use to_double for coarser");
+        return Fixed<Tag, ToScale, ToRep>::from_ticks(static_cast<ToRep>(ticks_ * (ToScale / Scale)));
+    }
+    template <typename ToRep>
+    constexpr Fixed<Tag, Scale, ToRep> widen() const {
+        static_assert(sizeof(ToRep) >= sizeof(Rep), "widen() cannot lose range; use narrow()");
+        return Fixed<Tag, Scale, ToRep>::from_ticks(ticks_);
+    }
+    // Fits `value` into this (narrower) storage; false if out of range.
+    template <typename FromRep>
+    static bool narrow(Fixed<Tag, Scale, FromRep> value, Fixed& out) {
+        if (value.ticks() > std::numeric_limits<Rep>::max()) return false;
+        out = Fixed(static_cast<Rep>(value.ticks()));
+        return true;
+    }
+    // As narrow(), clamping out-of-range values to the largest tick count.
+    template <typename FromRep>
+    static Fixed saturate(Fixed<Tag, Scale, FromRep> value) {
+        Fixed out = Fixed(std::numeric_limits<Rep>::max());
+        narrow(value, out);
+        return out;
+    }
+
+    constexpr bool operator==(Fixed other) const { return ticks_ == other.ticks_; }
+    constexpr bool operator!=(Fixed other) const { return ticks_ != other.ticks_; }
+    constexpr bool operator<(Fixed other) const { return ticks_ < other.ticks_; }
+    constexpr bool operator<=(Fixed other) const { return ticks_ <= other.ticks_; }
+    constexpr bool operator>(Fixed other) const { return ticks_ > other.ticks_; }
+    constexpr bool operator>=(Fixed other) const { return ticks_ >= other.ticks_; }
+    constexpr Fixed operator+(Fixed other) const { return Fixed(static_cast<Rep>(ticks_ + other.ticks_)); }
+    constexpr Fixed operator-(Fixed other) const { return Fixed(static_cast<Rep>(ticks_ - other.ticks_)); }
+    Fixed& operator+=(Fixed other) { ticks_ = static_cast<Rep>(ticks_ + other.ticks_); return *this; }
+    Fixed& operator-=(Fixed other) { ticks_ = static_cast<Rep>(ticks_ - other.ticks_); return *this; }
+private:
+    constexpr explicit Fixed(Rep ticks) : ticks_(ticks) {}
+    Rep ticks_ = 0;
+};
+
+struct PriceTag {};
+struct QuantityTag {};
+
+constexpr uint64_t PRICE_TICKS_PER_UNIT = 100;  // Cents
+
+using FixedPrice = Fixed<PriceTag, PRICE_TICKS_PER_UNIT>;
+using FixedQuantity = Fixed<QuantityTag, 1>;
+// Half-size storage for prices up to ~42.9M units and quantities up to ~4.29B.
+using CompactPrice = Fixed<PriceTag, PRICE_TICKS_PER_UNIT, uint32_t>;
+using CompactQuantity = Fixed<QuantityTag, 1, uint32_t>;
+
+// Kernels read spans of these as their underlying tick arrays.
+static_assert(sizeof(CompactPrice) == 4 && std::is_standard_layout<CompactPrice>::value &&
+                  std::is_trivially_copyable<CompactPrice>::value,
+              "CompactPrice must stay a bare 32-bit tick count");
@@ -1,34 +1,38 @@
 #include "indicators.h"
+#include "simd_kernels.h"
 #include <numeric>
 #include <algorithm>
 
 // Simple Moving Average
-double Indicators::simple_moving_average(const std::deque<double>& values, size_t period) {
+double Indicators::simple_moving_average(Span<double> values, size_t period) {
     if (values.size() < period || period == 0) return 0.0;
-    double sum = std::accumulate(values.end() - period, values.end(), 0.0);
-    return sum / period;
+    return SimdKernels::sum(values.end() - period, period) / period;
+}
+
+double Indicators::simple_moving_average(Span<CompactPrice> prices, size_t period) {
+    if (prices.size() < period || period == 0) return 0.0;
+    const uint32_t* ticks = reinterpret_cast<const uint32_t*>(prices.end() - period);
+    return static_cast<double>(SimdKernels::sum(ticks, period)) / static_cast<double>(period * CompactPrice::SCALE);
 }
 
 // Relative Strength Index
-double Indicators::relative_strength_index(const std::deque<double>& prices, size_t period) {
-    if (prices.size() < period + 1) return 50.0; // Neutral RSI
+double Indicators::relative_strength_index(Span<double> prices, size_t period) {
+    if (prices.size() < period + 1 || period == 0) return 50.0; // Neutral RSI
     
-    std::deque<double> gains, losses;
-    for (size_t i = 1; i < prices.size(); ++i) {
+    // Only the last `period` price changes contribute.
+    double gains = 0.0;
+    double losses = 0.0;
+    for (size_t i = prices.size() - period; i < prices.size(); ++i) {
         double change = prices[i] - prices[i-1];
         if (change > 0) {
-            gains.push_back(change);
-            losses.push_back(0.0);
+            gains += change;
         } else {
-            gains.push_back(0.0);
-            losses.push_back(-change);
+            losses -= change;
         }
     }
     
-    if (gains.size() < period) return 50.0;
-    
-    double avg_gain = std::accumulate(gains.end() - period, gains.end(), 0.0) / period;
-    double avg_loss = std::accumulate(losses.end() - period, losses.end(), 0.0) / period;
+    double avg_gain = gains / period;
+    double avg_loss = losses / period;
     
     if (avg_loss == 0.0) return 100.0;
     
@@ -37,7 +41,7 @@ double Indicators::relative_strength_index(const std::deque<double>& prices, siz
 }
 
 // MACD (Moving Average Convergence Divergence)
-std::pair<double, double> Indicators::macd(const std::deque<double>& prices, size_t fast_period, size_t slow_period, size_t signal_period) {
+std::pair<double, double> Indicators::macd(Span<double> prices, size_t fast_period, size_t slow_period, size_t signal_period) {
     if (prices.size() < slow_period) return {0.0, 0.0};
     
     double fast_ema = simple_moving_average(prices, fast_period);
@@ -45,23 +49,23 @@ std::pair<double, double> Indicators::macd(const std::deque<double>& prices, siz
     
     double macd_line = fast_ema - slow_ema;
     
-    // For simplicity, using SMA as signal line (in practice, EMA would be better)
-    std::deque<double> macd_values;
-    for (size_t i = slow_period; i < prices.size(); ++i) {
-        std::deque<double> temp_prices(prices.begin(), prices.begin() + i + 1);
-        double fast = simple_moving_average(temp_prices, fast_period);
-        double slow = simple_moving_average(temp_prices, slow_period);
-        macd_values.push_back(fast - slow);
-    }
+    // For simplicity, using SMA as signal line (in practice, EMA would be better).
+    // The MACD series has one value per prefix ending at index >= slow_period;
+    // only the last signal_period of them feed the signal line.
+    size_t series_length = prices.size() - slow_period;
+    if (signal_period == 0 || series_length < signal_period) return {macd_line, 0.0};
     
-    double signal_line = (macd_values.size() >= signal_period) ? 
-        simple_moving_average(macd_values, signal_period) : 0.0;
+    double signal_sum = 0.0;
+    for (size_t i = prices.size() - signal_period; i < prices.size(); ++i) {
+        Span<double> prefix = prices.first(i + 1);
+        signal_sum += simple_moving_average(prefix, fast_period) - simple_moving_average(prefix, slow_period);
+    }
     
-    return {macd_line, signal_line};
+    return {macd_line, signal_sum / signal_period};
 }
 
 // Price Change Percentage
-double Indicators::price_change_percent(const std::deque<double>& prices, size_t period) {
+double Indicators::price_change_percent(Span<double> prices, size_t period) {
     if (prices.size() < period + 1) return 0.0;
     
     double current_price = prices.back();
@@ -73,7 +77,7 @@ double Indicators::price_change_percent(const std::deque<double>& prices, size_t
 }
 
 // Momentum Score (combination of multiple indicators)
-double Indicators::momentum_score(const std::deque<double>& prices, size_t short_period, size_t long_period) {
+double Indicators::momentum_score(Span<double> prices, size_t short_period, size_t long_period) {
     if (prices.size() < long_period) return 0.0;
     
     double short_sma = simple_moving_average(prices, short_period);
@@ -92,4 +96,164 @@ double Indicators::momentum_score(const std::deque<double>& prices, size_t short
     
     // Combined momentum score
     return (price_vs_short + ma_trend + momentum_factor) / 3.0;
-} 
\ No newline at end of file
+}
+
+// Min/Max over the last `period` values
+std::pair<double, double> Indicators::window_min_max(Span<double> values, size_t period) {
+    Span<double> window = values.last(period);
+    double lo = 0.0;
+    double hi = 0.0;
+    SimdKernels::min_max(window.data(), window.size(), lo, hi);
+    return {lo, hi};
+}
+
+std::pair<double, double> Indicators::window_min_max(Span<CompactPrice> prices, size_t period) {
+    Span<CompactPrice> window = prices.last(period);
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    SimdKernels::min_max(reinterpret_cast<const uint32_t*>(window.data()), window.size(), lo, hi);
+    return {CompactPrice::from_ticks(lo).to_double(), CompactPrice::from_ticks(hi).to_double()};
+}
+
+// Population variance over the last `period` values
+double Indicators::window_variance(Span<double> values, size_t period) {
+    if (values.size() < period || period == 0) return 0.0;
+    double sum = 0.0;
+    double squares = 0.0;
+    SimdKernels::sum_and_squares(values.end() - period, period, sum, squares);
+    double mean = sum / period;
+    return std::max(squares / period - mean * mean, 0.0);
+}
+
+StreamingIndicators::StreamingIndicators(size_t short_period, size_t long_period, size_t rsi_period,
+                                         size_t macd_fast, size_t macd_slow, size_t macd_signal)
+    : short_period_(short_period), long_period_(long_period), rsi_period_(rsi_period),
+      macd_slow_(macd_slow), macd_signal_(macd_signal),
+      fast_alpha_(2.0 / (macd_fast + 1.0)), slow_alpha_(2.0 / (macd_slow + 1.0)),
+      signal_alpha_(2.0 / (macd_signal + 1.0)),
+      window_(std::max({short_period + 1, long_period, size_t{2}})) {}
+
+void StreamingIndicators::reset() {
+    window_.clear();
+    count_ = rsi_samples_ = macd_samples_ = 0;
+    short_sum_ = long_sum_ = avg_gain_ = avg_loss_ = 0.0;
+    fast_ema_ = slow_ema_ = signal_ema_ = 0.0;
+    snapshot_ = IndicatorSnapshot();
+}
+
+void StreamingIndicators::update(double price) {
+    double previous = count_ > 0 ? price_back(0) : price;
+    // Values leaving the SMA windows once this price is pushed.
+    double short_out = count_ >= short_period_ ? price_back(short_period_ - 1) : 0.0;
+    double long_out = count_ >= long_period_ ? price_back(long_period_ - 1) : 0.0;
+
+    window_.push_back(price);
+    ++count_;
+
+    if (count_ % RESUM_INTERVAL == 0) {
+        Span<double> recent = window_.view();
+        short_sum_ = SimdKernels::sum(recent.last(short_period_).data(), std::min(short_period_, recent.size()));
+        long_sum_ = SimdKernels::sum(recent.last(long_period_).data(), std::min(long_period_, recent.size()));
+    } else {
+        short_sum_ += price - short_out;
+        long_sum_ += price - long_out;
+    }
+
+    // Wilder RSI: seed with a simple average, then exponential smoothing.
+    if (count_ > 1 && rsi_period_ > 0) {
+        double change = price - previous;
+        double gain = change > 0 ? change : 0.0;
+        double loss = change < 0 ? -change : 0.0;
+        ++rsi_samples_;
+        if (rsi_samples_ <= rsi_period_) {
+            avg_gain_ += gain / rsi_period_;
+            avg_loss_ += loss / rsi_period_;
+        } else {
+            avg_gain_ = (avg_gain_ * (rsi_period_ - 1) + gain) / rsi_period_;
+            avg_loss_ = (avg_loss_ * (rsi_period_ - 1) + loss) / rsi_period_;
+        }
+    }
+
+    // MACD: EMAs seeded with the first price; the signal line starts once
+    // the slow EMA has a full period behind it.
+    if (count_ == 1) {
+        fast_ema_ = slow_ema_ = price;
+    } else {
+        fast_ema_ += fast_alpha_ * (price - fast_ema_);
+        slow_ema_ += slow_alpha_ * (price - slow_ema_);
+    }
+    double macd_line = fast_ema_ - slow_ema_;
+    if (count_ >= macd_slow_) {
+        signal_ema_ = macd_samples_ == 0 ? macd_line : signal_ema_ + signal_alpha_ * (macd_line - signal_ema_);
+        ++macd_samples_;
+    }
+
+    IndicatorSnapshot& snap = snapshot_;
+    snap.price = price;
+    snap.short_sma = (count_ >= short_period_ && short_period_ > 0) ? short_sum_ / short_period_ : 0.0;
+    snap.long_sma = (count_ >= long_period_ && long_period_ > 0) ? long_sum_ / long_period_ : 0.0;
+    if (rsi_samples_ < rsi_period_) {
+        snap.rsi = 50.0;
+    } else if (avg_loss_ == 0.0) {
+        snap.rsi = 100.0;
+    } else {
+        snap.rsi = 100.0 - (100.0 / (1.0 + avg_gain_ / avg_loss_));
+    }
+    if (count_ >= macd_slow_) {
+        snap.macd_line = macd_line;
+        snap.signal_line = macd_samples_ >= macd_signal_ ? signal_ema_ : 0.0;
+    } else {
+        snap.macd_line = snap.signal_line = 0.0;
+    }
+    snap.price_change_pct = 0.0;
+    if (count_ >= short_period_ + 1) {
+        double past = price_back(short_period_);
+        if (past != 0.0) snap.price_change_pct = ((price - past) / past) * 100.0;
+    }
+    if (count_ >= long_period_) {
+        double price_vs_short = (price > snap.short_sma) ? 1.0 : -1.0;
+        double ma_trend = (snap.short_sma > snap.long_sma) ? 1.0 : -1.0;
+        snap.momentum_score = (price_vs_short + ma_trend + std::tanh(snap.price_change_pct / 10.0)) / 3.0;
+    } else {
+        snap.momentum_score = 0.0;
+    }
+}
+
+IndicatorBank::IndicatorBank(size_t history_capacity)
+    : prices_(history_capacity), volumes_(history_capacity) {}
+
+size_t IndicatorBank::subscribe(size_t short_period, size_t long_period, size_t rsi_period) {
+    size_t free_slot = slots_.size();
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        Slot& slot = slots_[i];
+        if (slot.subscribers == 0) {
+            free_slot = std::min(free_slot, i);
+        } else if (slot.short_period == short_period && slot.long_period == long_period &&
+                   slot.rsi_period == rsi_period) {
+            ++slot.subscribers;
+            return i;
+        }
+    }
+    Slot fresh{short_period, long_period, rsi_period, 1, StreamingIndicators(short_period, long_period, rsi_period)};
+    for (CompactPrice price : prices_.view()) fresh.indicators.update(price.to_double());
+    if (free_slot == slots_.size()) {
+        slots_.push_back(std::move(fresh));
+    } else {
+        slots_[free_slot] = std::move(fresh);
+    }
+    return free_slot;
+}
+
+void IndicatorBank::unsubscribe(size_t slot) {
+    if (slot < slots_.size() && slots_[slot].subscribers > 0) --slots_[slot].subscribers;
+}
+
+void IndicatorBank::update(FixedPrice price, FixedQuantity volume) {
+    CompactPrice ticks = CompactPrice::saturate(price);
+    prices_.push_back(ticks);
+    volumes_.push_back(CompactQuantity::saturate(volume));
+    double units = ticks.to_double();
+    for (Slot& slot : slots_) {
+        if (slot.subscribers != 0) slot.indicators.update(units);
+    }
+}
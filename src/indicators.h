@@ -1,13 +1,116 @@
 #pragma once
 #include <vector>
-#include <deque>
 #include <cmath>
+#include <utility>
+#include "span.h"
+#include "ring_buffer.h"
+#include "fixed_point.h"
 
+// Batch indicators over a contiguous price window (oldest first), e.g. a
+// RingBuffer::view(). Window reductions run on SimdKernels; the
+// CompactPrice overloads reduce exact tick counts and return units.
 class Indicators {
 public:
-    static double simple_moving_average(const std::deque<double>& values, size_t period);
-    static double relative_strength_index(const std::deque<double>& prices, size_t period);
-    static std::pair<double, double> macd(const std::deque<double>& prices, size_t fast_period, size_t slow_period, size_t signal_period);
-    static double price_change_percent(const std::deque<double>& prices, size_t period);
-    static double momentum_score(const std::deque<double>& prices, size_t short_period, size_t long_period);
-}; 
\ No newline at end of file
+    static double simple_moving_average(Span<double> values, size_t period);
+    static double simple_moving_average(Span<CompactPrice> prices, size_t period);
+    static double relative_strength_index(Span<double> prices, size_t period);
+    static std::pair<double, double> macd(Span<double> prices, size_t fast_period, size_t slow_period, size_t signal_period);
+    static double price_change_percent(Span<double> prices, size_t period);
+    static double momentum_score(Span<double> prices, size_t short_period, size_t long_period);
+    static std::pair<double, double> window_min_max(Span<double> values, size_t period);
+    static std::pair<double, double> window_min_max(Span<CompactPrice> prices, size_t period);
+    static double window_variance(Span<double> values, size_t period);
+};
+
+// Latest values produced by StreamingIndicators, computed once per tick and
+// shared by every consumer.
+struct IndicatorSnapshot {
+    double price = 0.0;
+    double short_sma = 0.0;
+    double long_sma = 0.0;
+    double rsi = 50.0;
+    double macd_line = 0.0;
+    double signal_line = 0.0;
+    double price_change_pct = 0.0;
+    double momentum_score = 0.0;
+};
+
+// O(1)-per-tick indicator state: running-sum SMAs, Wilder-smoothed RSI and
+// EMA-based MACD with an EMA signal line. Returns the same neutral values
+// as the batch Indicators functions until enough ticks have been seen.
+class StreamingIndicators {
+public:
+    StreamingIndicators(size_t short_period, size_t long_period, size_t rsi_period,
+                        size_t macd_fast = 12, size_t macd_slow = 26, size_t macd_signal = 9);
+    void update(double price);
+    void reset();
+    const IndicatorSnapshot& snapshot() const { return snapshot_; }
+    size_t count() const { return count_; }
+private:
+    static constexpr size_t RESUM_INTERVAL = 4096;  // Refresh running sums to bound FP drift
+
+    size_t short_period_;
+    size_t long_period_;
+    size_t rsi_period_;
+    size_t macd_slow_;
+    size_t macd_signal_;
+    double fast_alpha_;
+    double slow_alpha_;
+    double signal_alpha_;
+
+    RingBuffer<double> window_;
+    size_t count_ = 0;
+    double short_sum_ = 0.0;
+    double long_sum_ = 0.0;
+
+    double avg_gain_ = 0.0;
+    double avg_loss_ = 0.0;
+    size_t rsi_samples_ = 0;
+
+    double fast_ema_ = 0.0;
+    double slow_ema_ = 0.0;
+    double signal_ema_ = 0.0;
+    size_t macd_samples_ = 0;
+
+    IndicatorSnapshot snapshot_;
+
+    double price_back(size_t age) const { return window_.window(age + 1)[0]; }
+};
+
+// Price/volume history plus one StreamingIndicators per distinct period
+// set, shared by every strategy reading the same feed. Strategies with
+// matching periods share a slot, so each tick updates each window once no
+// matter how many strategies consume it. History is kept as 32-bit ticks
+// (saturating), converting to units once per tick for the indicators.
+class IndicatorBank {
+public:
+    static constexpr size_t DEFAULT_HISTORY = 1000;
+
+    explicit IndicatorBank(size_t history_capacity = DEFAULT_HISTORY);
+
+    // Returns the slot for these periods, creating it (and replaying the
+    // retained history into it) if no strategy has asked for them yet.
+    // Slots are reference-counted and keep their index for life.
+    size_t subscribe(size_t short_period, size_t long_period, size_t rsi_period);
+    // Drops one subscription; a slot nobody reads stops being updated and
+    // is reused by the next subscribe for new periods.
+    void unsubscribe(size_t slot);
+    void update(FixedPrice price, FixedQuantity volume);
+
+    const IndicatorSnapshot& snapshot(size_t slot) const { return slots_[slot].indicators.snapshot(); }
+    Span<CompactPrice> prices() const { return prices_.view(); }
+    Span<CompactQuantity> volumes() const { return volumes_.view(); }
+    size_t history_size() const { return prices_.size(); }
+    size_t num_slots() const { return slots_.size(); }
+private:
+    struct Slot {
+        size_t short_period;
+        size_t long_period;
+        size_t rsi_period;
+        size_t subscribers;
+        StreamingIndicators indicators;
+    };
+    RingBuffer<CompactPrice> prices_;
+    RingBuffer<CompactQuantity> volumes_;
+    std::vector<Slot> slots_;
+};
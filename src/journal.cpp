@@ -0,0 +1,287 @@
+#include "journal.h"
+#include "matching_engine.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NANOEX_HAVE_POSIX_IO 1
+#endif
+
+Journal::Journal(const JournalConfig& config)
+    : config_(config), ring_(std::make_unique<SpscRing<JournalEntry>>(config.ring_capacity)) {
+    if (config_.write_batch == 0) config_.write_batch = 1;
+}
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::open(const std::string& path) {
+    close();
+#ifdef NANOEX_HAVE_POSIX_IO
+    if (!recover_tail(path)) return false;
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) {
+        error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) == 0 && st.st_size == 0) {
+        JournalHeader header;
+        if (!write_all(&header, sizeof(header))) {
+            close();
+            return false;
+        }
+    }
+    written_sequence_.store(next_sequence_ - 1, std::memory_order_release);
+    synced_sequence_.store(next_sequence_ - 1, std::memory_order_release);
+    running_ = true;
+    writer_ = std::thread(&Journal::writer_loop, this);
+    return true;
+#else
+    error_ = "journaling needs POSIX file I/O";
+    (void)path;
+    return false;
+#endif
+}
+
+// Finds the last valid entry of an existing journal, cuts off anything
+// after it and continues the sequence from there.
+bool Journal::recover_tail(const std::string& path) {
+    next_sequence_ = 1;
+#ifdef NANOEX_HAVE_POSIX_IO
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || st.st_size == 0) return true;
+    JournalReader reader;
+    if (!reader.open(path)) {
+        error_ = reader.error();
+        return false;
+    }
+    JournalEntry entries[256];
+    uint64_t valid = 0;
+    while (size_t n = reader.read(entries, 256)) valid += n;
+    uint64_t last_sequence = reader.last_sequence();
+    reader.close();
+    off_t length = static_cast<off_t>(sizeof(JournalHeader) + valid * sizeof(JournalEntry));
+    if (st.st_size != length && ::truncate(path.c_str(), length) != 0) {
+        error_ = "cannot trim " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    next_sequence_ = last_sequence + 1;
+#else
+    (void)path;
+#endif
+    return true;
+}
+
+void Journal::close() {
+    if (running_.exchange(false) && writer_.joinable()) writer_.join();
+#ifdef NANOEX_HAVE_POSIX_IO
+    if (fd_ >= 0) ::close(fd_);
+#endif
+    fd_ = -1;
+}
+
+size_t Journal::drain(JournalEntry* batch) {
+    size_t count = 0;
+    while (count < config_.write_batch && ring_->try_pop(batch[count])) {
+        JournalEntry& entry = batch[count];
+        entry.record.timestamp_ns = static_cast<uint64_t>(TscClock::to_wall_ns(entry.record.timestamp_ns));
+        ++count;
+    }
+    return count;
+}
+
+bool Journal::write_all(const void* data, size_t size) {
+#ifdef NANOEX_HAVE_POSIX_IO
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd_, bytes, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error_ = std::string("journal write failed: ") + std::strerror(errno);
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+#else
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+void Journal::sync() {
+    uint64_t written = written_sequence_.load(std::memory_order_relaxed);
+    if (written == synced_sequence_.load(std::memory_order_relaxed)) return;
+#if defined(__APPLE__)
+    int rc = ::fsync(fd_);
+#elif defined(NANOEX_HAVE_POSIX_IO)
+    int rc = ::fdatasync(fd_);
+#else
+    int rc = -1;
+#endif
+    if (rc == 0) {
+        synced_sequence_.store(written, std::memory_order_release);
+    } else {
+        error_ = std::string("journal sync failed: ") + std::strerror(errno);
+    }
+}
+
+void Journal::writer_loop() {
+    std::vector<JournalEntry> batch(config_.write_batch);
+    auto sync_interval = std::chrono::microseconds(config_.sync_interval_us);
+    auto last_sync = std::chrono::steady_clock::now();
+    bool failed = false;
+    IdleWaiter waiter(config_.wait);
+    for (;;) {
+        bool stopping = !running_.load(std::memory_order_acquire);
+        size_t count = drain(batch.data());
+        if (count > 0 && !failed) {
+            failed = !write_all(batch.data(), count * sizeof(JournalEntry));
+            if (!failed) written_sequence_.store(batch[count - 1].sequence, std::memory_order_release);
+        }
+        auto now = std::chrono::steady_clock::now();
+        // Group commit: one sync covers everything written in the window.
+        if (!failed && config_.sync_interval_us > 0 && now - last_sync >= sync_interval) {
+            sync();
+            last_sync = now;
+        }
+        if (count == 0) {
+            if (stopping) break;
+            waiter.idle();
+        } else {
+            waiter.reset();
+        }
+    }
+    if (!failed && config_.sync_interval_us > 0) sync();
+}
+
+bool Journal::wait_durable(uint64_t sequence, std::chrono::milliseconds timeout) const {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        uint64_t durable = config_.sync_interval_us > 0 ? get_synced() : get_written();
+        if (durable >= sequence) return true;
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+JournalReader::~JournalReader() {
+    close();
+}
+
+bool JournalReader::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    JournalHeader header;
+    if (std::fread(&header, sizeof(header), 1, file_) != 1 || header.magic != JournalHeader::MAGIC ||
+        header.version != JournalHeader::VERSION || header.entry_size != sizeof(JournalEntry)) {
+        close();
+        error_ = path + " is not a journal file";
+        return false;
+    }
+    // Whole entries only; a partial trailing entry is a write the crash
+    // interrupted.
+    std::fseek(file_, 0, SEEK_END);
+    long size = std::ftell(file_);
+    std::fseek(file_, static_cast<long>(sizeof(JournalHeader)), SEEK_SET);
+    uint64_t payload = static_cast<uint64_t>(size) - sizeof(JournalHeader);
+    remaining_ = payload / sizeof(JournalEntry);
+    truncated_ = payload % sizeof(JournalEntry) != 0;
+    return true;
+}
+
+void JournalReader::close() {
+    if (file_) std::fclose(file_);
+    file_ = nullptr;
+    last_sequence_ = 0;
+    remaining_ = 0;
+    truncated_ = false;
+    done_ = false;
+}
+
+bool JournalReader::skip_to(uint64_t sequence) {
+    if (!file_ || sequence < last_sequence_) return false;
+    uint64_t skip = sequence - last_sequence_;
+    if (skip > remaining_) {
+        error_ = "journal ends before sequence " + std::to_string(sequence);
+        return false;
+    }
+    long offset = static_cast<long>(sizeof(JournalHeader) + sequence * sizeof(JournalEntry));
+    if (std::fseek(file_, offset, SEEK_SET) != 0) return false;
+    remaining_ -= skip;
+    last_sequence_ = sequence;
+    return true;
+}
+
+size_t JournalReader::read(JournalEntry* out, size_t max) {
+    if (!file_ || done_) return 0;
+    size_t count = std::fread(out, sizeof(JournalEntry), std::min<uint64_t>(max, remaining_), file_);
+    remaining_ -= count;
+    if (count == 0) done_ = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (out[i].sequence != last_sequence_ + 1) {
+            done_ = true;
+            truncated_ = true;
+            return i;
+        }
+        last_sequence_ = out[i].sequence;
+    }
+    return count;
+}
+
+bool replay_journal(const std::string& path, MatchingEngine& engine, JournalReplayStats& stats, std::string& error,
+                    uint64_t after_sequence) {
+    stats = JournalReplayStats();
+    JournalReader reader;
+    if (!reader.open(path) || (after_sequence > 0 && !reader.skip_to(after_sequence))) {
+        error = reader.error();
+        return false;
+    }
+    JournalEntry entries[256];
+    EngineCommand command;
+    while (size_t n = reader.read(entries, 256)) {
+        for (size_t i = 0; i < n; ++i) {
+            const MarketRecord& record = entries[i].record;
+            switch (record.kind) {
+            case MarketRecord::Kind::ADD:
+                command.kind = EngineCommand::Kind::ADD;
+                command.order = record.to_order();
+                ++stats.adds;
+                break;
+            case MarketRecord::Kind::CANCEL:
+                command.kind = EngineCommand::Kind::CANCEL;
+                command.order.order_id = record.order_id;
+                ++stats.cancels;
+                break;
+            case MarketRecord::Kind::MODIFY:
+                command.kind = EngineCommand::Kind::MODIFY;
+                command.order.order_id = record.order_id;
+                command.order.price = record.price;
+                command.order.quantity = record.quantity;
+                ++stats.modifies;
+                break;
+            case MarketRecord::Kind::TRADE:
+                continue;
+            }
+            engine.execute(command);
+            ++stats.entries;
+        }
+    }
+    if (reader.last_sequence() > after_sequence) stats.first_sequence = after_sequence + 1;
+    stats.last_sequence = reader.last_sequence();
+    stats.truncated = reader.truncated();
+    return true;
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "lockfree_ring.h"
+#include "market_record.h"
+#include "tsc_clock.h"
+#include "wait_strategy.h"
+
+// One inbound engine command as written to the journal. Sequences start at
+// 1 and are contiguous within a file; a reader stops at the first gap or
+// torn record, which is where a crash cut the file off.
+struct JournalEntry {
+    uint64_t sequence;
+    MarketRecord record;  // ADD, CANCEL or MODIFY; timestamp_ns is Unix time
+};
+
+static_assert(sizeof(JournalEntry) == 48, "JournalEntry layout is part of the journal file format");
+static_assert(std::is_trivially_copyable<JournalEntry>::value, "JournalEntry must be writable as raw bytes");
+
+struct JournalHeader {
+    static constexpr uint32_t MAGIC = 0x4c4a584e;  // "NXJL"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t entry_size = sizeof(JournalEntry);
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(JournalHeader) == 16, "JournalHeader layout is part of the journal file format");
+
+struct JournalConfig {
+    size_t ring_capacity = 1 << 16;  // Entries queued between the engine and the writer
+    size_t write_batch = 1024;       // Entries per write(2)
+    uint32_t sync_interval_us = 1000;  // Group-commit window for fdatasync (0 = never sync)
+    WaitMode wait = WaitMode::BLOCK;   // Writer thread's idle policy between batches
+};
+
+// Append-only command journal. append() runs on the engine thread and only
+// stamps a sequence and pushes the entry onto an SPSC ring; a writer thread
+// drains the ring in batches with write(2) and issues one fdatasync per
+// sync interval, covering every entry written since the last one. A full
+// ring makes append() wait rather than drop, so the journal never has
+// holes. Opening an existing journal trims a torn tail and continues its
+// sequence.
+class Journal {
+public:
+    explicit Journal(const JournalConfig& config = JournalConfig());
+    ~Journal();
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    bool open(const std::string& path);
+    void close();  // Writes and syncs everything queued, then joins the writer
+    bool is_open() const { return fd_ >= 0; }
+
+    // Producer side: one thread at a time (the engine serialises callers).
+    void append(MarketRecord record) {
+        JournalEntry entry{next_sequence_++, record};
+        entry.record.timestamp_ns = TscClock::now();  // Converted to wall time by the writer
+        if (!ring_->try_push(entry)) {
+            stalls_.fetch_add(1, std::memory_order_relaxed);
+            do {
+                std::this_thread::yield();
+            } while (!ring_->try_push(entry));
+        }
+    }
+
+    uint64_t get_appended() const { return next_sequence_ - 1; }
+    uint64_t get_written() const { return written_sequence_.load(std::memory_order_acquire); }
+    // Highest sequence known to be on stable storage.
+    uint64_t get_synced() const { return synced_sequence_.load(std::memory_order_acquire); }
+    uint64_t get_stalls() const { return stalls_.load(std::memory_order_relaxed); }
+    // Blocks until `sequence` is on stable storage (only written, when
+    // sync_interval_us is 0). False if that takes longer than `timeout`,
+    // e.g. because the writer has failed.
+    bool wait_durable(uint64_t sequence, std::chrono::milliseconds timeout) const;
+    const std::string& error() const { return error_; }
+private:
+    JournalConfig config_;
+    std::unique_ptr<SpscRing<JournalEntry>> ring_;
+    int fd_ = -1;
+    uint64_t next_sequence_ = 1;
+    std::thread writer_;
+    std::atomic<bool> running_{false};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> written_sequence_{0};
+    std::atomic<uint64_t> synced_sequence_{0};
+    std::atomic<uint64_t> stalls_{0};
+    std::string error_;
+
+    bool recover_tail(const std::string& path);
+    size_t drain(JournalEntry* batch);
+    bool write_all(const void* data, size_t size);
+    void sync();
+    void writer_loop();
+};
+
+// Sequential reader over a journal file. Stops cleanly at a sequence gap or
+// a torn final entry.
+class JournalReader {
+public:
+    JournalReader() = default;
+    ~JournalReader();
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    // Positions the reader after entry `sequence` without reading what
+    // precedes it (entries are fixed size and numbered from 1).
+    bool skip_to(uint64_t sequence);
+    // Reads up to `max` entries; returns 0 at the end of the valid journal.
+    size_t read(JournalEntry* out, size_t max);
+    uint64_t last_sequence() const { return last_sequence_; }
+    // True if reading stopped on a gap or a torn entry rather than at EOF.
+    bool truncated() const { return truncated_; }
+    const std::string& error() const { return error_; }
+private:
+    std::FILE* file_ = nullptr;
+    uint64_t last_sequence_ = 0;
+    uint64_t remaining_ = 0;  // Whole entries left in the file
+    bool truncated_ = false;
+    bool done_ = false;
+    std::string error_;
+};
+
+class MatchingEngine;
+
+struct JournalReplayStats {
+    uint64_t entries = 0;
+    uint64_t adds = 0;
+    uint64_t cancels = 0;
+    uint64_t modifies = 0;
+    uint64_t first_sequence = 0;  // First entry applied (0 if none)
+    uint64_t last_sequence = 0;
+    bool truncated = false;
+};
+
+// Rebuilds `engine` by applying every journaled command after
+// `after_sequence` in sequence order; pass a snapshot's journal_sequence to
+// replay only the tail it does not cover. The result is deterministic for a
+// given journal and EngineConfig. Run it before the engine opens its own
+// journal, or the replay is journaled again.
+bool replay_journal(const std::string& path, MatchingEngine& engine, JournalReplayStats& stats, std::string& error,
+                    uint64_t after_sequence = 0);
@@ -0,0 +1,77 @@
+#include "latency_histogram.h"
+#include <algorithm>
+
+namespace {
+
+constexpr uint64_t LINEAR = uint64_t{1} << LatencyHistogram::SUB_BITS;
+constexpr uint64_t HALF = LINEAR >> 1;
+
+unsigned msb(uint64_t v) {
+    return 63u - static_cast<unsigned>(__builtin_clzll(v));
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : counts_(new std::atomic<uint64_t>[BUCKETS]) {
+    reset();
+}
+
+size_t LatencyHistogram::bucket_of(uint64_t ns) {
+    if (ns < LINEAR) return static_cast<size_t>(ns);
+    unsigned high = msb(ns);
+    if (high >= MAX_BITS) return BUCKETS - 1;
+    // Group g covers [2^(SUB_BITS-1+g), 2^(SUB_BITS+g)) in HALF buckets of width 2^g.
+    unsigned group = high - SUB_BITS + 1;
+    return static_cast<size_t>(LINEAR + (group - 1) * HALF + ((ns >> group) - HALF));
+}
+
+uint64_t LatencyHistogram::bucket_upper(size_t bucket) {
+    if (bucket < LINEAR) return bucket;
+    uint64_t offset = bucket - LINEAR;
+    unsigned group = static_cast<unsigned>(offset / HALF) + 1;
+    uint64_t sub = offset % HALF + HALF;
+    return ((sub + 1) << group) - 1;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        uint64_t n = other.counts_[i].load(std::memory_order_relaxed);
+        if (n != 0) counts_[i].fetch_add(n, std::memory_order_relaxed);
+    }
+    count_.fetch_add(other.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    uint64_t other_max = other.max_.load(std::memory_order_relaxed);
+    if (other_max > max_.load(std::memory_order_relaxed)) max_.store(other_max, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+    for (size_t i = 0; i < BUCKETS; ++i) counts_[i].store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) total += counts_[i].load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucket_upper(i), max_.load(std::memory_order_relaxed));
+    }
+    return max_.load(std::memory_order_relaxed);
+}
+
+LatencyStats LatencyHistogram::stats() const {
+    LatencyStats out;
+    out.count = count_.load(std::memory_order_relaxed);
+    if (out.count == 0) return out;
+    out.mean_ns = static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(out.count);
+    out.p50_ns = percentile(0.50);
+    out.p99_ns = percentile(0.99);
+    out.p999_ns = percentile(0.999);
+    out.max_ns = max_.load(std::memory_order_relaxed);
+    return out;
+}
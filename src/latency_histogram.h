@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct LatencyStats {
+    uint64_t count = 0;
+    double mean_ns = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+// HDR-style log-linear histogram of nanosecond latencies. Values below
+// 2^SUB_BITS are exact; above that every power-of-two range is split into
+// 2^(SUB_BITS-1) buckets, so any reported percentile is within ~3% of the
+// true value. Memory is fixed (BUCKETS counters) regardless of sample
+// count. One thread records at a time; readers may merge concurrently.
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 6;
+    static constexpr unsigned MAX_BITS = 40;  // Values >= 2^40 ns (~18 min) land in the top bucket
+    static constexpr size_t BUCKETS = (size_t{1} << SUB_BITS) + (MAX_BITS - SUB_BITS) * (size_t{1} << (SUB_BITS - 1));
+
+    LatencyHistogram();
+
+    void record(uint64_t ns) {
+        bump(counts_[bucket_of(ns)], 1);
+        bump(count_, 1);
+        bump(sum_, ns);
+        if (ns > max_.load(std::memory_order_relaxed)) max_.store(ns, std::memory_order_relaxed);
+    }
+
+    // Adds `other`'s samples into this histogram.
+    void merge(const LatencyHistogram& other);
+    void reset();
+    LatencyStats stats() const;
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    static size_t bucket_of(uint64_t ns);
+    static uint64_t bucket_upper(size_t bucket);
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+
+    // Single writer: a plain load/store keeps the hot path free of locked
+    // instructions while readers still see whole values.
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+    uint64_t percentile(double fraction) const;
+};
@@ -0,0 +1,71 @@
+#include "load_generator.h"
+#include "order_id.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+LoadGenerator::LoadGenerator(const LoadConfig& config) : config_(config) {}
+
+std::vector<MarketRecord> LoadGenerator::generate(size_t index) const {
+    std::mt19937_64 rng(config_.seed * 0x9e3779b97f4a7c15ULL + index);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> offset(0.0, config_.price_stddev);
+    std::uniform_int_distribution<Quantity> qty_dist(1, 100);
+    size_t num_symbols = std::max<size_t>(config_.num_symbols, 1);
+    std::uniform_int_distribution<SymbolId> symbol_dist(0, static_cast<SymbolId>(num_symbols - 1));
+
+    struct Live {
+        OrderId id;
+        SymbolId symbol;
+        OrderSide side;
+        Price price;
+    };
+    std::vector<Live> live;
+    std::vector<double> mids(num_symbols, static_cast<double>(config_.mid_price));
+    OrderIdGenerator order_ids(static_cast<uint16_t>(OrderIdGenerator::FIRST_LOAD_SOURCE + index));
+    uint64_t timestamp_ns = 0;
+
+    std::vector<MarketRecord> stream;
+    stream.reserve(config_.stream_length);
+    auto push = [&](MarketRecord::Kind kind, OrderId id, SymbolId symbol, OrderSide side, OrderType type,
+                    Price price, Quantity qty) {
+        stream.push_back(MarketRecord{++timestamp_ns, id, price, qty, symbol, kind, side, type, 0});
+    };
+
+    size_t target = std::max<size_t>(config_.stream_length, 1);
+    while (stream.size() + live.size() < target) {
+        double roll = unit(rng);
+        if (!live.empty() && roll < config_.cancel_ratio + config_.modify_ratio) {
+            size_t pick = static_cast<size_t>(unit(rng) * live.size()) % live.size();
+            Live& order = live[pick];
+            if (roll < config_.cancel_ratio) {
+                push(MarketRecord::Kind::CANCEL, order.id, order.symbol, order.side, OrderType::LIMIT, order.price, 0);
+                order = live.back();
+                live.pop_back();
+            } else {
+                Price price = std::max<Price>(1, static_cast<Price>(std::llround(static_cast<double>(order.price) + offset(rng) * 0.25)));
+                order.price = price;
+                push(MarketRecord::Kind::MODIFY, order.id, order.symbol, order.side, OrderType::LIMIT, price, qty_dist(rng));
+            }
+            continue;
+        }
+
+        SymbolId symbol = symbol_dist(rng);
+        double& mid = mids[symbol];
+        mid = std::max(mid + (unit(rng) - 0.5), 1.0);  // Slow random walk
+        OrderSide side = unit(rng) < 0.5 ? OrderSide::BUY : OrderSide::SELL;
+        bool market = unit(rng) < config_.market_ratio;
+        // Bids cluster just below the mid, asks just above.
+        double distance = std::abs(offset(rng));
+        double raw = side == OrderSide::BUY ? mid - distance : mid + distance;
+        Price price = std::max<Price>(1, static_cast<Price>(std::llround(raw)));
+        OrderId id = order_ids.next();
+        push(MarketRecord::Kind::ADD, id, symbol, side, market ? OrderType::MARKET : OrderType::LIMIT, price, qty_dist(rng));
+        if (!market) live.push_back(Live{id, symbol, side, price});
+    }
+
+    for (const Live& order : live) {
+        push(MarketRecord::Kind::CANCEL, order.id, order.symbol, order.side, OrderType::LIMIT, order.price, 0);
+    }
+    return stream;
+}
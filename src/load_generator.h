@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "market_record.h"
+
+struct LoadConfig {
+    double messages_per_second = 100000;  // Total across producers
+    size_t producers = 1;                 // Threads, each with its own pregenerated stream
+    size_t batch_size = 64;               // Records per callback
+    size_t stream_length = 1 << 20;       // Records pregenerated per producer, replayed in a loop
+    size_t num_symbols = 1;
+    double cancel_ratio = 0.3;            // Share of messages that cancel a live order
+    double modify_ratio = 0.1;            // Share that modify a live order
+    double market_ratio = 0.05;           // Share of adds that are market orders
+    Price mid_price = 10000;              // Starting mid, in ticks
+    double price_stddev = 20.0;           // Limit prices cluster around the mid (ticks)
+    uint64_t seed = 1;
+};
+
+// Pregenerates synthetic order flow so that producing it at load costs a
+// pointer bump. Each producer's stream ends by cancelling every order it
+// left resting, so replaying it in a loop never reuses a live order ID.
+class LoadGenerator {
+public:
+    explicit LoadGenerator(const LoadConfig& config);
+    // Builds producer `index`'s stream; its order IDs are disjoint from
+    // every other producer's.
+    std::vector<MarketRecord> generate(size_t index) const;
+private:
+    LoadConfig config_;
+};
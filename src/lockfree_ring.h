@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+inline size_t round_up_pow2(size_t n) {
+    size_t size = 2;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+// Bounded single-producer/single-consumer ring. Each side caches the other
+// side's index so the common case touches only its own cache line.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : mask_(round_up_pow2(capacity) - 1), buffer_(new T[mask_ + 1]) {}
+
+    template <typename U>
+    bool try_push(U&& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_) return false;
+        }
+        buffer_[head & mask_] = std::forward<U>(value);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) return false;
+        }
+        out = std::move(buffer_[tail & mask_]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask_ + 1; }
+private:
+    const size_t mask_;
+    std::unique_ptr<T[]> buffer_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+};
+
+// Bounded multi-producer/single-consumer ring (Vyukov's per-cell sequence
+// scheme). Producers claim a cell with one CAS; the consumer never
+// contends with them.
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t capacity)
+        : mask_(round_up_pow2(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <typename U>
+    bool try_push(U&& value) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::forward<U>(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Claims `count` consecutive cells with one CAS and fills them with
+    // fill(0) .. fill(count - 1), all or nothing. The consumer frees cells
+    // in order, so the last cell being free means the whole run is.
+    template <typename Fill>
+    bool try_push_n(size_t count, Fill&& fill) {
+        if (count == 0) return true;
+        if (count > capacity()) return false;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t last = pos + count - 1;
+            size_t seq = cells_[last & mask_].sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(last);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            cell.value = fill(i);
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        Cell& cell = cells_[tail_ & mask_];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(tail_ + 1) < 0) return false;
+        out = std::move(cell.value);
+        cell.sequence.store(tail_ + mask_ + 1, std::memory_order_release);
+        ++tail_;
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    alignas(CACHE_LINE_SIZE) size_t tail_ = 0;
+};
@@ -0,0 +1,98 @@
+#include "logger.h"
+#include "threading.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+const char* log_level_name(LogLevel level) {
+    switch (level) {
+    case LogLevel::DEBUG: return "DEBUG";
+    case LogLevel::INFO: return "INFO";
+    case LogLevel::WARN: return "WARN";
+    case LogLevel::ERROR: return "ERROR";
+    }
+    return "?";
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::~Logger() {
+    stop();
+}
+
+Logger::Ring& Logger::local_ring() {
+    thread_local Ring* ring = nullptr;
+    if (!ring) ring = &register_ring();
+    return *ring;
+}
+
+Logger::Ring& Logger::register_ring() {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    rings_.push_back(std::make_unique<Ring>(RING_CAPACITY));
+    return *rings_.back();
+}
+
+void Logger::start(std::FILE* out, int cpu, int fifo_priority) {
+    if (running_.exchange(true)) return;
+    out_ = out;
+    writer_ = std::thread([this, cpu, fifo_priority]() {
+        place_current_thread(cpu, fifo_priority);
+        writer_loop();
+    });
+}
+
+void Logger::stop() {
+    if (!running_.exchange(false)) return;
+    if (writer_.joinable()) writer_.join();
+    std::vector<LogRecord> batch;
+    std::string text;
+    while (drain(batch, text) > 0) {}
+}
+
+size_t Logger::drain(std::vector<LogRecord>& batch, std::string& text) {
+    batch.clear();
+    {
+        // Rings are never removed, so the lock only covers the vector
+        // itself growing under us.
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        LogRecord record;
+        for (auto& ring : rings_) {
+            for (size_t i = 0; i < RING_CAPACITY && ring->try_pop(record); ++i) batch.push_back(record);
+        }
+    }
+    if (batch.empty()) return 0;
+
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const LogRecord& a, const LogRecord& b) { return a.ticks < b.ticks; });
+    text.clear();
+    char line[512];
+    for (const LogRecord& record : batch) {
+        int64_t wall_ns = TscClock::to_wall_ns(record.ticks);
+        std::time_t seconds = static_cast<std::time_t>(wall_ns / 1000000000);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        int prefix = std::snprintf(line, sizeof(line), "%02d:%02d:%02d.%06lld %-5s ", local.tm_hour, local.tm_min,
+                                   local.tm_sec, static_cast<long long>((wall_ns % 1000000000) / 1000),
+                                   log_level_name(record.site->level));
+        int body = record.format(record, line + prefix, sizeof(line) - prefix);
+        size_t length = prefix + std::min<size_t>(body > 0 ? body : 0, sizeof(line) - prefix - 1);
+        text.append(line, length);
+        text.push_back('\n');
+    }
+    std::fwrite(text.data(), 1, text.size(), out_);
+    std::fflush(out_);
+    written_.fetch_add(batch.size(), std::memory_order_relaxed);
+    return batch.size();
+}
+
+void Logger::writer_loop() {
+    std::vector<LogRecord> batch;
+    batch.reserve(RING_CAPACITY);
+    std::string text;
+    while (running_.load(std::memory_order_acquire)) {
+        if (drain(batch, text) == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
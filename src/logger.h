@@ -0,0 +1,195 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "lockfree_ring.h"
+#include "tsc_clock.h"
+
+enum class LogLevel : uint8_t { DEBUG = 0, INFO = 1, WARN = 2, ERROR = 3 };
+
+// Calls below this level are compiled out entirely (-DNANOEX_LOG_LEVEL=2
+// keeps WARN and ERROR).
+#ifndef NANOEX_LOG_LEVEL
+#define NANOEX_LOG_LEVEL 1
+#endif
+
+const char* log_level_name(LogLevel level);
+
+// Everything about a log call that is known at compile time. One static
+// instance per call site; records carry only a pointer to it.
+struct LogSite {
+    LogLevel level;
+    const char* format;  // printf-style, checked by the compiler at the call site
+    const char* file;
+    int line;
+};
+
+// Strings are copied into the record (truncated) since the caller's
+// buffer may be gone by the time the record is formatted.
+struct LogString {
+    static constexpr size_t CAPACITY = 32;
+    char data[CAPACITY];
+};
+
+// Fixed-size binary record: the call site, a timestamp and the raw
+// argument bytes. `format` is instantiated per argument list and unpacks
+// them for snprintf on the logging thread.
+struct LogRecord {
+    static constexpr size_t PAYLOAD = 168;
+
+    const LogSite* site;
+    uint64_t ticks;
+    int (*format)(const LogRecord& record, char* out, size_t size);
+    alignas(8) unsigned char payload[PAYLOAD];
+};
+
+static_assert(sizeof(LogRecord) == 192, "LogRecord should stay three cache lines");
+
+namespace log_detail {
+
+template <typename T, typename = void>
+struct Stored {
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                  "log arguments must be numbers, pointers or strings");
+    using type = T;
+    static type store(T value) { return value; }
+    static T load(const type& value) { return value; }
+};
+
+inline LogString store_string(const char* text) {
+    LogString out;
+    std::strncpy(out.data, text ? text : "(null)", LogString::CAPACITY - 1);
+    out.data[LogString::CAPACITY - 1] = '\0';
+    return out;
+}
+
+template <>
+struct Stored<const char*> {
+    using type = LogString;
+    static type store(const char* text) { return store_string(text); }
+    static const char* load(const type& value) { return value.data; }
+};
+template <>
+struct Stored<char*> : Stored<const char*> {};
+template <size_t N>
+struct Stored<char[N]> : Stored<const char*> {};
+
+template <typename T>
+using StoredFor = Stored<typename std::decay<T>::type>;
+
+template <typename T>
+constexpr size_t align_to(size_t offset) { return (offset + alignof(T) - 1) / alignof(T) * alignof(T); }
+
+// Bytes the stored arguments occupy when packed in order, each aligned.
+template <typename... S>
+constexpr size_t payload_size() {
+    size_t offset = 0;
+    ((offset = align_to<S>(offset) + sizeof(S)), ...);
+    return offset;
+}
+
+template <typename S>
+void write_arg(unsigned char* payload, size_t& offset, const S& value) {
+    offset = align_to<S>(offset);
+    std::memcpy(payload + offset, &value, sizeof(S));
+    offset += sizeof(S);
+}
+
+template <typename S>
+S read_arg(const unsigned char* payload, size_t& offset) {
+    offset = align_to<S>(offset);
+    S value;
+    std::memcpy(&value, payload + offset, sizeof(S));
+    offset += sizeof(S);
+    return value;
+}
+
+template <typename... Args>
+int format_record(const LogRecord& record, char* out, size_t size) {
+    if constexpr (sizeof...(Args) == 0) {
+        return std::snprintf(out, size, "%s", record.site->format);
+    } else {
+        size_t offset = 0;
+        // Braced initialisation reads the arguments back in order.
+        std::tuple<typename StoredFor<Args>::type...> values{
+            read_arg<typename StoredFor<Args>::type>(record.payload, offset)...};
+        return std::apply([&](const auto&... value) {
+            return std::snprintf(out, size, record.site->format, StoredFor<Args>::load(value)...);
+        }, values);
+    }
+}
+
+}  // namespace log_detail
+
+// Asynchronous logger. Callers copy a LogRecord into their own thread's
+// SPSC ring (allocated on the thread's first log call) and return; when a
+// ring is full the record is dropped and counted rather than blocking.
+// A background thread drains every ring, orders the batch by timestamp,
+// formats it and writes it with one fwrite.
+class Logger {
+public:
+    static constexpr size_t RING_CAPACITY = 4096;
+
+    static Logger& instance();
+
+    // The writer thread pins to `cpu` (-1 = unpinned).
+    void start(std::FILE* out = stdout, int cpu = -1, int fifo_priority = 0);
+    void stop();  // Drains what is queued, then joins the writer thread
+
+    template <typename... Args>
+    void log(const LogSite* site, const Args&... args) {
+        static_assert(log_detail::payload_size<typename log_detail::StoredFor<Args>::type...>() <= LogRecord::PAYLOAD,
+                      "too many log arguments for one record");
+        LogRecord record;
+        record.site = site;
+        record.ticks = TscClock::now();
+        record.format = &log_detail::format_record<Args...>;
+        size_t offset = 0;
+        (log_detail::write_arg(record.payload, offset, log_detail::StoredFor<Args>::store(args)), ...);
+        (void)offset;
+        if (!local_ring().try_push(record)) dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t get_dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t get_written() const { return written_.load(std::memory_order_relaxed); }
+private:
+    Logger() = default;
+    ~Logger();
+
+    using Ring = SpscRing<LogRecord>;
+    std::mutex rings_mutex_;  // Guards rings_ growing while the writer walks it
+    std::vector<std::unique_ptr<Ring>> rings_;
+    std::thread writer_;
+    std::atomic<bool> running_{false};
+    std::FILE* out_ = stdout;
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+
+    Ring& local_ring();
+    Ring& register_ring();
+    size_t drain(std::vector<LogRecord>& batch, std::string& text);
+    void writer_loop();
+};
+
+#define NANOEX_LOG(level, fmt, ...)                                                       \
+    do {                                                                                  \
+        if constexpr (static_cast<int>(level) >= NANOEX_LOG_LEVEL) {                      \
+            static constexpr LogSite nanoex_log_site{level, fmt, __FILE__, __LINE__};     \
+            if (false) std::printf(fmt, ##__VA_ARGS__); /* compile-time format check */  \
+            Logger::instance().log(&nanoex_log_site, ##__VA_ARGS__);                      \
+        }                                                                                 \
+    } while (0)
+
+#define NANOEX_LOG_DEBUG(fmt, ...) NANOEX_LOG(LogLevel::DEBUG, fmt, ##__VA_ARGS__)
+#define NANOEX_LOG_INFO(fmt, ...) NANOEX_LOG(LogLevel::INFO, fmt, ##__VA_ARGS__)
+#define NANOEX_LOG_WARN(fmt, ...) NANOEX_LOG(LogLevel::WARN, fmt, ##__VA_ARGS__)
+#define NANOEX_LOG_ERROR(fmt, ...) NANOEX_LOG(LogLevel::ERROR, fmt, ##__VA_ARGS__)
@@ -1,15 +1,29 @@
 #include "order_book.h"
 #include "matching_engine.h"
+#include "engine_router.h"
 #include "market_data.h"
 #include "strategy.h"
 #include "risk.h"
 #include "indicators.h"
 #include "performance.h"
 #include "threading.h"
+#include "dispatch.h"
+#include "tsc_clock.h"
+#include "replay.h"
+#include "tick_store.h"
+#include "feed_handler.h"
+#include "telemetry.h"
+#include "metrics.h"
+#include "logger.h"
+#include "trace.h"
+#include "topology.h"
 #include <iostream>
 #include <atomic>
 #include <iomanip>
 #include <chrono>
+#include <algorithm>
+#include <limits>
+#include <string>
 
 namespace {
 
@@ -35,16 +49,512 @@ void print_strategy_status(const StrategyEngine& strategy) {
     std::cout << "\n";
 }
 
+void print_latency(const PerformanceMonitor& perf, const EngineRouter& router) {
+    perf.print_latency_report(std::cout);
+    print_latency_line(std::cout, "match", router.get_match_latency());
+}
+
+// Everything the strategy strand touches, including the order buffer it
+// reuses across batches. The strand is the telemetry ring's only writer.
+struct StrategyContext {
+    StrategyEngine& strategy;
+    RiskManager& risk;
+    EngineRouter& router;
+    PerformanceMonitor& perf;
+    TelemetryPublisher& telemetry;
+    bool verbose;
+    std::vector<Order> orders;
+    std::vector<Order> in_flight;  // Accepted orders the matcher may still report on, at their checked price
+};
+
+// Execution reports come from the matcher and are posted onto the strategy
+// strand, which owns risk's exposure. `filled` is false for a remainder
+// that will never trade; either way the order's checked price is what risk
+// releases.
+void settle(StrategyContext& ctx, OrderId order_id, Quantity quantity, bool filled) {
+    auto it = std::find_if(ctx.in_flight.begin(), ctx.in_flight.end(),
+                           [order_id](const Order& order) { return order.order_id == order_id; });
+    if (it == ctx.in_flight.end()) return;
+    if (filled) {
+        ctx.risk.on_fill(it->symbol, it->side, it->price, quantity);
+    } else {
+        ctx.risk.on_cancel(it->symbol, it->side, it->price, quantity);
+    }
+    it->quantity -= std::min(it->quantity, quantity);
+    if (it->quantity == 0) {
+        *it = ctx.in_flight.back();
+        ctx.in_flight.pop_back();
+    }
+}
+
+// Resting quantity across both sides of a book's published depth, the
+// reference RiskConfig::max_position_pct is a fraction of.
+Quantity book_quantity(const BookDepth& depth) {
+    Quantity total = 0;
+    for (uint32_t i = 0; i < depth.bid_levels; ++i) total += depth.bids[i].quantity;
+    for (uint32_t i = 0; i < depth.ask_levels; ++i) total += depth.asks[i].quantity;
+    return total;
+}
+
+// Logged from the strategy strand, so these only queue binary records;
+// the logger thread does the formatting.
+void log_signal(const StrategyEngine& strategy) {
+    const SignalReason& reason = strategy.get_last_signal_reason();
+    const char* side = strategy.get_last_signal_type() == SignalType::BUY ? "BUY" : "SELL";
+    double confidence = strategy.get_last_signal_confidence() * 100;
+    switch (reason.kind) {
+    case SignalReason::Kind::REVERSION:
+        NANOEX_LOG_INFO("%s Signal: Reversion: %.2f%% from MA (%.2f), RSI: %.2f (Confidence: %.2f%%)", side,
+                        reason.deviation_pct, reason.long_sma, reason.rsi, confidence);
+        break;
+    case SignalReason::Kind::STOP_LOSS:
+    case SignalReason::Kind::TAKE_PROFIT:
+        NANOEX_LOG_INFO("%s Signal: %s triggered (Confidence: %.2f%%, P&L: %.2f%%)", side,
+                        reason.kind == SignalReason::Kind::STOP_LOSS ? "Stop Loss" : "Take Profit", confidence,
+                        strategy.get_last_signal_pnl_pct());
+        break;
+    default:
+        NANOEX_LOG_INFO("%s Signal: Momentum: %.2f, RSI: %.2f, MACD: %s, Price vs MA: %s (%.2f vs %.2f) "
+                        "(Confidence: %.2f%%)",
+                        side, reason.momentum_score, reason.rsi, reason.macd_bullish ? "Bullish" : "Bearish",
+                        reason.price_above_ma ? "Above" : "Below", reason.short_sma, reason.long_sma, confidence);
+        break;
+    }
+}
+
+void log_order(const Order& order) {
+    NANOEX_LOG_INFO("Order: %s @ %.2f x %llu", order.side == OrderSide::BUY ? "BUY" : "SELL", price_to_double(order.price),
+                    static_cast<unsigned long long>(order.quantity));
+}
+
+void publish_stats(StrategyContext& ctx) {
+    auto [best_bid, best_ask] = ctx.router.engine(0).get_best_bid_ask();
+    ctx.telemetry.publish_stats(ctx.router.get_processed_orders(), ctx.router.get_matched_trades(),
+                                ctx.perf.get_events_per_second(), ctx.router.get_match_latency(),
+                                best_bid, best_ask, ctx.risk.get_orders_rejected());
+}
+
+std::string series(const char* family, const char* label, size_t value) {
+    return std::string(family) + "{" + label + "=\"" + std::to_string(value) + "\"}";
+}
+
+// --metrics series that the main loop samples. All of them come from
+// counters the matcher, risk slots, pool workers and feed already keep as
+// relaxed atomics, seqlocks or per-thread histograms, so sampling takes no
+// lock and adds no work to the matcher. The main thread is their only writer.
+struct MonitorMetrics {
+    std::vector<Metric> shard_orders, shard_cancels, shard_modifies, shard_trades;
+    std::vector<Metric> best_bid, best_ask, dropped_trades, match_latency;
+    std::vector<Metric> pool_tasks, pool_steals, pool_parks;
+    Metric stage_latency[PerformanceMonitor::NUM_STAGES];
+    Metric events_per_second, risk_rejected, risk_volume, self_trades, strategy_fills;
+    Metric feed_records, feed_duplicates, feed_gaps, feed_lost, load_sent;
+
+    void add(MetricsPage& page, const EngineRouter& router, const ThreadPool& pool) {
+        auto counter = [&page](const char* family, const char* label, size_t i) {
+            return page.add(series(family, label, i), MetricKind::COUNTER);
+        };
+        for (size_t shard = 0; shard < router.num_shards(); ++shard) {
+            shard_orders.push_back(counter("nanoex_shard_orders_total", "shard", shard));
+            shard_cancels.push_back(counter("nanoex_shard_cancels_total", "shard", shard));
+            shard_modifies.push_back(counter("nanoex_shard_modifies_total", "shard", shard));
+            shard_trades.push_back(counter("nanoex_shard_trades_total", "shard", shard));
+        }
+        for (size_t symbol = 0; symbol < router.num_symbols(); ++symbol) {
+            best_bid.push_back(page.add(series("nanoex_best_bid", "symbol", symbol), MetricKind::GAUGE));
+            best_ask.push_back(page.add(series("nanoex_best_ask", "symbol", symbol), MetricKind::GAUGE));
+            dropped_trades.push_back(counter("nanoex_dropped_trades_total", "symbol", symbol));
+            match_latency.push_back(page.add(series("nanoex_match_latency_seconds", "symbol", symbol),
+                                             MetricKind::HISTOGRAM));
+        }
+        for (size_t worker = 0; worker < pool.size(); ++worker) {
+            pool_tasks.push_back(counter("nanoex_pool_tasks_total", "worker", worker));
+            pool_steals.push_back(counter("nanoex_pool_steals_total", "worker", worker));
+            pool_parks.push_back(counter("nanoex_pool_parks_total", "worker", worker));
+        }
+        for (size_t stage = 0; stage < PerformanceMonitor::NUM_STAGES; ++stage) {
+            stage_latency[stage] = page.add(std::string("nanoex_stage_latency_seconds{stage=\"") +
+                                                latency_stage_name(static_cast<LatencyStage>(stage)) + "\"}",
+                                            MetricKind::HISTOGRAM);
+        }
+        events_per_second = page.add("nanoex_events_per_second", MetricKind::GAUGE);
+        risk_rejected = page.add("nanoex_risk_rejected_total", MetricKind::COUNTER);
+        risk_volume = page.add("nanoex_risk_daily_volume", MetricKind::GAUGE);
+        self_trades = page.add("nanoex_self_trades_prevented_total", MetricKind::COUNTER);
+        strategy_fills = page.add("nanoex_strategy_fills_total", MetricKind::COUNTER);
+        feed_records = page.add("nanoex_feed_records_total", MetricKind::COUNTER);
+        feed_duplicates = page.add("nanoex_feed_duplicates_total", MetricKind::COUNTER);
+        feed_gaps = page.add("nanoex_feed_gaps_total", MetricKind::COUNTER);
+        feed_lost = page.add("nanoex_feed_lost_total", MetricKind::COUNTER);
+        load_sent = page.add("nanoex_load_sent_total", MetricKind::COUNTER);
+    }
+
+    void sample(const EngineRouter& router, const PerformanceMonitor& perf, const RiskManager& risk,
+                const ThreadPool& pool, const FeedStats& feed, uint64_t load_messages, uint64_t fills) {
+        for (size_t shard = 0; shard < shard_orders.size(); ++shard) {
+            ShardStats stats = router.get_shard_stats(shard);
+            shard_orders[shard].set(static_cast<double>(stats.orders));
+            shard_cancels[shard].set(static_cast<double>(stats.cancels));
+            shard_modifies[shard].set(static_cast<double>(stats.modifies));
+            shard_trades[shard].set(static_cast<double>(stats.trades));
+        }
+        for (size_t symbol = 0; symbol < best_bid.size(); ++symbol) {
+            const MatchingEngine& engine = router.engine(static_cast<SymbolId>(symbol));
+            auto [bid, ask] = engine.get_best_bid_ask();
+            best_bid[symbol].set(price_to_double(bid));
+            best_ask[symbol].set(price_to_double(ask));
+            dropped_trades[symbol].set(static_cast<double>(engine.get_dropped_trades()));
+            match_latency[symbol].set(engine.get_match_latency().stats());
+        }
+        for (size_t worker = 0; worker < pool_tasks.size(); ++worker) {
+            ThreadPoolStats stats = pool.get_worker_stats(worker);
+            pool_tasks[worker].set(static_cast<double>(stats.tasks));
+            pool_steals[worker].set(static_cast<double>(stats.steals));
+            pool_parks[worker].set(static_cast<double>(stats.parks));
+        }
+        for (size_t stage = 0; stage < PerformanceMonitor::NUM_STAGES; ++stage) {
+            stage_latency[stage].set(perf.get_latency_stats(static_cast<LatencyStage>(stage)));
+        }
+        events_per_second.set(perf.get_events_per_second());
+        risk_rejected.set(static_cast<double>(risk.get_orders_rejected()));
+        risk_volume.set(static_cast<double>(risk.get_daily_volume()));
+        self_trades.set(static_cast<double>(router.get_self_trades_prevented()));
+        strategy_fills.set(static_cast<double>(fills));
+        feed_records.set(static_cast<double>(feed.records));
+        feed_duplicates.set(static_cast<double>(feed.duplicates));
+        feed_gaps.set(static_cast<double>(feed.gaps));
+        feed_lost.set(static_cast<double>(feed.lost));
+        load_sent.set(static_cast<double>(load_messages));
+    }
+};
+
+// Strategy state is plain data owned by the strategy strand, so the strand
+// publishes these itself.
+struct StrandMetrics {
+    Metric in_position, entry_price, price_history;
+
+    void add(MetricsPage& page) {
+        in_position = page.add("nanoex_strategy_in_position", MetricKind::GAUGE);
+        entry_price = page.add("nanoex_strategy_entry_price", MetricKind::GAUGE);
+        price_history = page.add("nanoex_strategy_price_history", MetricKind::GAUGE);
+    }
+
+    void sample(const StrategyEngine& strategy) {
+        in_position.set(strategy.is_in_position() ? 1.0 : 0.0);
+        entry_price.set(strategy.is_in_position() ? strategy.get_entry_price() : 0.0);
+        price_history.set(static_cast<double>(strategy.get_price_history_size()));
+    }
+};
+
+// Runs one feed batch through strategy, risk and the router on the
+// strategy strand. `Batch` is a vector of feed orders or a span of replayed
+// capture records. A sampled batch's `trace` follows its first order to the
+// matcher, or ends here if the batch produced none.
+template <typename Batch>
+void run_strategy_batch(StrategyContext& ctx, const Batch& batch, uint64_t feed_ticks, TraceContext* trace) {
+    uint64_t strategy_ticks = TscClock::now();
+    if (trace) trace->stamp(TraceStage::STRATEGY_START);
+    ctx.perf.record_latency(LatencyStage::FEED_TO_STRATEGY, strategy_ticks - feed_ticks);
+    ctx.orders.clear();
+    size_t signals = ctx.strategy.generate_signals(batch, ctx.orders);
+    uint64_t risk_ticks = TscClock::stamp_batch(ctx.orders);  // One read stamps every order and times the stage
+    if (trace) trace->stamp(TraceStage::STRATEGY_DONE);
+    ctx.perf.record_latency(LatencyStage::STRATEGY_TO_RISK, risk_ticks - strategy_ticks);
+    if (signals == 0) {
+        if (trace) trace->finish();
+        ctx.telemetry.publish_indicators(ctx.strategy.get_indicators());
+        return;
+    }
+
+    // Position limits are checked against the depth the matcher last
+    // published; accepted orders stay in flight until reported on.
+    SymbolId depth_symbol = std::numeric_limits<SymbolId>::max();
+    for (const Order& order : ctx.orders) {
+        if (order.symbol == depth_symbol || order.symbol >= ctx.router.num_symbols()) continue;
+        depth_symbol = order.symbol;
+        ctx.risk.set_book_quantity(depth_symbol, book_quantity(ctx.router.engine(depth_symbol).get_l2()));
+    }
+    ctx.risk.filter_orders(ctx.orders);
+    ctx.in_flight.insert(ctx.in_flight.end(), ctx.orders.begin(), ctx.orders.end());
+    if (trace) {
+        trace->stamp(TraceStage::RISK_DONE);
+        if (!ctx.orders.empty()) trace->stamp(TraceStage::SUBMITTED);
+    }
+    // The matcher owns the trace now, or submit_batch ends it if risk
+    // rejected every order.
+    ctx.router.submit_batch(ctx.orders, trace);
+    ctx.perf.record_latency(LatencyStage::RISK_TO_ENGINE, TscClock::now() - risk_ticks);
+
+    // Reporting happens after the orders are on their way, and as binary
+    // telemetry; --verbose also queues them on the async logger.
+    ctx.telemetry.publish_indicators(ctx.strategy.get_indicators());
+    ctx.telemetry.publish_signal(ctx.strategy, ctx.strategy.get_indicators().price);
+    if (ctx.verbose) log_signal(ctx.strategy);
+    for (const Order& order : ctx.orders) {
+        ctx.perf.record_event();
+        ctx.telemetry.publish_order(order);
+        if (ctx.verbose) log_order(order);
+    }
+}
+
+// Load-mode records go straight to the router.
+void submit_record(EngineRouter& router, const MarketRecord& record) {
+    switch (record.kind) {
+    case MarketRecord::Kind::ADD:
+        router.submit_order(record.to_order());
+        break;
+    case MarketRecord::Kind::CANCEL:
+        router.submit_cancel(record.symbol, record.order_id);
+        break;
+    case MarketRecord::Kind::MODIFY:
+        router.submit_modify(record.symbol, record.order_id, record.price, record.quantity);
+        break;
+    case MarketRecord::Kind::TRADE:
+        break;
+    }
+}
+
+// Parses "<group>:<port>" into a multicast endpoint.
+bool parse_endpoint(const std::string& text, UdpEndpoint& endpoint) {
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == text.size()) return false;
+    endpoint.group = text.substr(0, colon);
+    endpoint.port = static_cast<uint16_t>(std::stoul(text.substr(colon + 1)));
+    return true;
+}
+
+struct StageWait {
+    const char* stage;
+    WaitMode* mode;
+};
+
+// Parses "<stage>=<block|spin|busy>;..." into the matching stages' modes.
+bool parse_stage_waits(const std::string& spec, const std::vector<StageWait>& stages, std::string& error) {
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t end = std::min(spec.find(';', pos), spec.size());
+        std::string entry = spec.substr(pos, end - pos);
+        pos = end + 1;
+        if (entry.empty()) continue;
+        size_t equals = entry.find('=');
+        std::string name = entry.substr(0, equals);
+        auto stage = std::find_if(stages.begin(), stages.end(), [&](const StageWait& s) { return name == s.stage; });
+        if (stage == stages.end()) {
+            error = "unknown wait stage '" + name + "'";
+            return false;
+        }
+        if (equals == std::string::npos || !parse_wait_mode(entry.substr(equals + 1), *stage->mode)) {
+            error = "wait mode for " + name + " must be block, spin or busy";
+            return false;
+        }
+    }
+    return true;
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    // --replay <file> [--paced] replays a capture instead of the simulated
+    // feed; --record <file> captures the simulated feed for later replay.
+    // --record-ticks <file> writes the simulated or multicast feed to a
+    // columnar tick store from a background thread, and --record-trades
+    // <file> does the same for every engine trade.
+    // --load <msgs/s> [--producers <n>] drives the engine directly with
+    // synthetic order flow to find its saturation point.
+    // --feed <group:port> [--feed-b <group:port>] [--feed-interface <addr>]
+    // takes live multicast market data, arbitrating A/B when both are given.
+    // --telemetry <name> renames the shared-memory ring nanoex_gui reads;
+    // --verbose also logs every signal and order as text.
+    // --metrics <name> publishes engine, risk, strategy, pool and feed
+    // counters, gauges and latency summaries to a shared-memory page (e.g.
+    // /nanoex.metrics) every 100 ms for nanoex_metrics to scrape, in place
+    // of the 5 s status lines.
+    // --publish-book <prefix> streams book deltas into shared-memory rings
+    // named <prefix>.<symbol> (e.g. /nanoex.book.0).
+    // --journal <prefix> recovers each book from its snapshot
+    // <prefix>.<symbol>.snap and journal <prefix>.<symbol>, journals every
+    // command from then on and snapshots every --snapshot-interval seconds
+    // (default 60, 0 = only at shutdown).
+    // --trace <n> traces one feed batch in n from feed to match and prints a
+    // per-stage breakdown; --trace-out <file> also writes the traces as a
+    // Chrome trace (chrome://tracing, Perfetto) at shutdown.
+    // --topology <spec> places each thread role on its own cores, e.g.
+    // "feed=2@80;strategy=3-5;matcher=6@90;logger=0;telemetry=3" (see
+    // topology.h); without it only the matcher is pinned, to the last core.
+    // --wait <stage>=<block|spin|busy>;... picks how each hand-off idles:
+    // feed (default busy), strategy pool (block), matcher (spin) and
+    // journal writer (block). busy never enters the kernel and needs the
+    // stage on a dedicated core.
+    // --stp <none|cancel-newest|cancel-oldest|decrement> sets what happens
+    // when the strategy's orders meet its own resting orders.
+    // --max-position-pct <fraction> caps the strategy's worst-case position
+    // at that fraction of the quantity resting in the book's top levels.
+    std::string replay_path;
+    std::string record_path;
+    std::string ticks_path;
+    std::string trades_path;
+    ReplayConfig replay_config;
+    LoadConfig load_config;
+    bool load_mode = false;
+    FeedConfig feed_config;
+    bool feed_mode = false;
+    bool bad_args = false;
+    std::string book_prefix;
+    std::string journal_prefix;
+    int snapshot_interval_s = 60;
+    std::string telemetry_name = DEFAULT_TELEMETRY_RING;
+    std::string metrics_name;
+    TraceConfig trace_config;
+    std::string trace_path;
+    TopologyConfig topology;
+    std::string wait_spec;
+    SelfTradePrevention self_trade = SelfTradePrevention::NONE;
+    RiskConfig risk_config;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (arg == "--record-ticks" && i + 1 < argc) {
+            ticks_path = argv[++i];
+        } else if (arg == "--record-trades" && i + 1 < argc) {
+            trades_path = argv[++i];
+        } else if (arg == "--paced") {
+            replay_config.paced = true;
+        } else if (arg == "--load" && i + 1 < argc) {
+            load_mode = true;
+            load_config.messages_per_second = std::stod(argv[++i]);
+        } else if (arg == "--producers" && i + 1 < argc) {
+            load_config.producers = std::stoul(argv[++i]);
+        } else if (arg == "--feed" && i + 1 < argc) {
+            feed_mode = true;
+            bad_args = !parse_endpoint(argv[++i], feed_config.feed_a);
+        } else if (arg == "--feed-b" && i + 1 < argc) {
+            bad_args = !parse_endpoint(argv[++i], feed_config.feed_b);
+        } else if (arg == "--telemetry" && i + 1 < argc) {
+            telemetry_name = argv[++i];
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metrics_name = argv[++i];
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else if (arg == "--journal" && i + 1 < argc) {
+            journal_prefix = argv[++i];
+        } else if (arg == "--snapshot-interval" && i + 1 < argc) {
+            snapshot_interval_s = std::stoi(argv[++i]);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_config.sample_every = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--trace-out" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--topology" && i + 1 < argc) {
+            std::string error;
+            if (!parse_topology(argv[++i], topology, error)) {
+                std::cerr << error << "\n";
+                bad_args = true;
+            }
+        } else if (arg == "--wait" && i + 1 < argc) {
+            wait_spec = argv[++i];
+        } else if (arg == "--stp" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (!parse_self_trade_prevention(mode, self_trade)) {
+                std::cerr << "unknown self-trade prevention mode '" << mode << "'\n";
+                bad_args = true;
+            }
+        } else if (arg == "--max-position-pct" && i + 1 < argc) {
+            risk_config.max_position_pct = std::stod(argv[++i]);
+        } else if (arg == "--publish-book" && i + 1 < argc) {
+            book_prefix = argv[++i];
+        } else if (arg == "--feed-interface" && i + 1 < argc) {
+            feed_config.feed_a.interface_addr = argv[i + 1];
+            feed_config.feed_b.interface_addr = argv[++i];
+        } else {
+            bad_args = true;
+        }
+        if (bad_args) {
+            std::cerr << "usage: " << argv[0] << " [--replay <file> [--paced]] [--record <file>]"
+                      << " [--record-ticks <file>] [--record-trades <file>]"
+                      << " [--load <msgs/s> [--producers <n>]]"
+                      << " [--feed <group:port> [--feed-b <group:port>] [--feed-interface <addr>]]"
+                      << " [--publish-book <prefix>] [--journal <prefix> [--snapshot-interval <s>]] [--telemetry <name>]"
+                      << " [--metrics <name>]"
+                      << " [--trace <n> [--trace-out <file>]] [--topology <role>=<cpus>[@<prio>];...]"
+                      << " [--wait <stage>=<block|spin|busy>;...] [--stp <mode>] [--max-position-pct <fraction>]"
+                      << " [--verbose]\n";
+            return 1;
+        }
+    }
+
     std::cout << "NanoEX HFT System starting.\n";
+    const RolePlacement& logger_role = topology.role(ThreadRole::LOGGER);
+    Logger::instance().start(stdout, topology.cpu(ThreadRole::LOGGER), logger_role.fifo_priority);
+
+    // By default one core is reserved for the matcher shard, which owns the
+    // books, and the strategy pool floats over the rest.
+    unsigned cores = std::max(2u, std::thread::hardware_concurrency());
 
-    MatchingEngine engine;
-    MarketData market_data;
-    RiskManager risk;
+    // The simulated feed quotes 99.00-101.00, so a 1024-tick ladder keeps
+    // the whole book off the allocator.
+    RouterConfig router_config;
+    router_config.num_symbols = 1;
+    router_config.num_shards = 1;
+    router_config.first_cpu = static_cast<int>(cores) - 1;
+    router_config.engine.ladder_levels = 1024;
+    router_config.engine.self_trade = self_trade;
+    if (topology.assigned(ThreadRole::MATCHER)) {
+        const RolePlacement& matcher_role = topology.role(ThreadRole::MATCHER);
+        router_config.num_shards = std::min(matcher_role.cpus.size(), router_config.num_symbols);
+        router_config.shard_cpus = matcher_role.cpus;
+        router_config.fifo_priority = matcher_role.fifo_priority;
+    }
+    ThreadPoolConfig pool_config;
+    pool_config.num_threads = cores - 1;
+    if (topology.assigned(ThreadRole::STRATEGY)) {
+        const RolePlacement& strategy_role = topology.role(ThreadRole::STRATEGY);
+        pool_config.num_threads = strategy_role.cpus.size();
+        pool_config.cpus = strategy_role.cpus;
+        pool_config.fifo_priority = strategy_role.fifo_priority;
+    }
+    const RolePlacement& feed_role = topology.role(ThreadRole::FEED);
+    feed_config.cpu = topology.cpu(ThreadRole::FEED);
+    feed_config.fifo_priority = feed_role.fifo_priority;
+    JournalConfig journal_config;
+    std::string wait_error;
+    if (!parse_stage_waits(wait_spec,
+                           {{"feed", &feed_config.wait},
+                            {"strategy", &pool_config.wait},
+                            {"matcher", &router_config.wait},
+                            {"journal", &journal_config.wait}},
+                           wait_error)) {
+        std::cerr << wait_error << "\n";
+        return 1;
+    }
+    if (!topology.empty()) {
+        std::cout << "Thread topology:\n";
+        print_topology(std::cout, topology);
+    }
+    if (topology.wants_fifo()) {
+        // Probe once on a scratch thread; every role thread applies its own
+        // priority and carries on unprivileged if refused.
+        bool fifo_ok = false;
+        std::thread([&fifo_ok]() { fifo_ok = set_fifo_priority(1); }).join();
+        if (!fifo_ok) std::cerr << "SCHED_FIFO refused (needs CAP_SYS_NICE); roles run at default priority\n";
+    }
+
+    EngineRouter router(router_config);
+    const MatchingEngine& engine = router.engine(0);
+    MarketData market_data(router_config.num_symbols);
+    market_data.set_cpus(feed_role.cpus, feed_role.fifo_priority);
+    FeedHandler feed(feed_config);
+    RiskManager risk(risk_config);
     PerformanceMonitor perf;
-    ThreadPool pool(std::thread::hardware_concurrency());
+    Tracer tracer(trace_config);
+    ThreadPool pool(pool_config);
+    // Strategy and risk state is owned by one strand, so batches reach it in
+    // feed order and never run concurrently. Each independent strategy (or
+    // per-symbol strategy) would post under its own key.
+    OrderedDispatcher dispatcher(pool, pool.size());
+    constexpr uint64_t STRATEGY_KEY = 0;
     std::atomic<bool> running{true};
 
     StrategyConfig strategy_config;
@@ -59,56 +569,216 @@ int main() {
 
     StrategyEngine strategy(strategy_config);
     print_strategy_config(strategy);
+    // Recovery replays into the books before anything is listening, so the
+    // rebuilt history reaches neither the strategy nor the delta rings.
+    if (!journal_prefix.empty()) {
+        RecoveryStats recovered;
+        auto recovery_start = std::chrono::steady_clock::now();
+        if (!router.recover(journal_prefix, recovered) || !router.open_journals(journal_prefix, journal_config)) {
+            std::cerr << "Cannot journal to " << journal_prefix << ": " << router.get_journal_error() << "\n";
+            return 1;
+        }
+        if (recovered.snapshots > 0 || recovered.journal.entries > 0) {
+            const JournalReplayStats& tail = recovered.journal;
+            auto [bid, ask] = engine.get_best_bid_ask();
+            auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - recovery_start).count();
+            std::cout << "Recovered " << recovered.snapshot_orders << " resting orders from " << recovered.snapshots
+                      << " snapshot(s) and " << tail.entries << " journaled commands (" << tail.adds << " adds, "
+                      << tail.cancels << " cancels, " << tail.modifies << " modifies)"
+                      << (tail.truncated ? ", torn tail discarded" : "") << " in " << elapsed_ms
+                      << " ms; best bid=" << price_to_double(bid) << " best_ask=" << price_to_double(ask) << "\n";
+        }
+        std::cout << "Journaling commands to " << journal_prefix << ".<symbol>\n";
+    }
 
-    perf.start();
+    // The ring's pages are first touched at creation; place them where the
+    // GUI's reader runs.
+    TelemetryPublisher telemetry;
+    bool telemetry_open = false;
+    run_on_cpu(topology.cpu(ThreadRole::TELEMETRY), [&]() { telemetry_open = telemetry.open(telemetry_name); });
+    if (!telemetry_open) {
+        std::cerr << "Telemetry disabled: " << telemetry.error() << "\n";
+    }
+    telemetry.publish_config(strategy_config);
 
-    market_data.start([&](const std::vector<std::shared_ptr<Order>>& market_orders) {
-        pool.enqueue([&]() {
-            auto signals = strategy.generate_signals(market_orders);
-
-            if (strategy.get_last_signal_type() != SignalType::HOLD) {
-                if (strategy.get_last_signal_type() == SignalType::BUY) {
-                    std::cout << "BUY Signal: " << strategy.get_last_signal_reason()
-                              << " (Confidence: " << std::fixed << std::setprecision(2)
-                              << strategy.get_last_signal_confidence() * 100 << "%)\n";
-                } else {
-                    std::cout << "SELL Signal: " << strategy.get_last_signal_reason()
-                              << " (Confidence: " << std::fixed << std::setprecision(2)
-                              << strategy.get_last_signal_confidence() * 100
-                              << "%, P&L: " << strategy.get_last_signal_pnl_pct() << "%)\n";
-                }
-            }
+    StrategyContext ctx{strategy, risk, router, perf, telemetry, verbose, {}, {}};
+
+    // The strategy's own executions, routed by participant on the matcher
+    // and settled against risk on the strategy strand.
+    std::atomic<uint64_t> strategy_fills{0};
+    const ParticipantId participant = strategy_config.participant;
+    router.set_participant_callback(participant, [&strategy_fills, &dispatcher, &ctx,
+                                                  participant](const TradeEvent& trade) {
+        strategy_fills.fetch_add(1, std::memory_order_relaxed);
+        OrderId order_id = trade.buy_participant == participant ? trade.buy_order_id : trade.sell_order_id;
+        Quantity quantity = trade.quantity;
+        dispatcher.post(STRATEGY_KEY, [&ctx, order_id, quantity]() { settle(ctx, order_id, quantity, true); });
+    });
+    router.set_unfilled_callback(participant, [&dispatcher, &ctx](const Order& order) {
+        OrderId order_id = order.order_id;
+        Quantity quantity = order.quantity;
+        dispatcher.post(STRATEGY_KEY, [&ctx, order_id, quantity]() { settle(ctx, order_id, quantity, false); });
+    });
+
+    // Registered before anything runs; each series then has one writer.
+    MetricsPage metrics;
+    MonitorMetrics monitor_metrics;
+    StrandMetrics strand_metrics;
+    if (!metrics_name.empty()) {
+        if (!metrics.create(metrics_name)) {
+            std::cerr << "Cannot publish metrics: " << metrics.error() << "\n";
+            return 1;
+        }
+        monitor_metrics.add(metrics, router, pool);
+        strand_metrics.add(metrics);
+        std::cout << "Publishing " << metrics.size() << " metrics to " << metrics_name << "\n";
+    }
+
+    if (!book_prefix.empty()) {
+        if (!router.open_delta_rings(book_prefix, 1 << 16)) {
+            std::cerr << "Cannot publish book deltas: " << router.get_delta_error() << "\n";
+            return 1;
+        }
+        std::cout << "Publishing book deltas to " << book_prefix << ".<symbol>\n";
+    }
+
+    // Trade rings have to be subscribed before the matchers start.
+    TickRecorder tick_recorder;
+    TickRecorder trade_recorder;
+    if (!trades_path.empty()) {
+        for (SymbolId symbol = 0; symbol < router_config.num_symbols; ++symbol) {
+            trade_recorder.add_trade_source(router.engine(symbol).subscribe_trades(1 << 16));
+        }
+        if (!trade_recorder.open(trades_path)) {
+            std::cerr << "Cannot record trades: " << trade_recorder.error() << "\n";
+            return 1;
+        }
+    }
+    if (!ticks_path.empty() && !tick_recorder.open(ticks_path)) {
+        std::cerr << "Cannot record ticks: " << tick_recorder.error() << "\n";
+        return 1;
+    }
+
+    perf.start();
+    router.start();
 
-            auto filtered = risk.filter_orders(signals);
+    CaptureWriter capture;
+    if (!record_path.empty() && !capture.open(record_path)) {
+        std::cerr << "Cannot record to " << record_path << "\n";
+        return 1;
+    }
 
-            for (const auto& order : filtered) {
-                engine.add_order(order);
-                perf.record_event();
-                std::cout << "Order: " << (order->side == OrderSide::BUY ? "BUY" : "SELL")
-                          << " @ " << std::fixed << std::setprecision(2) << (order->price / 100.0)
-                          << " x " << order->quantity << "\n";
+    if (load_mode) {
+        load_config.num_symbols = router_config.num_symbols;
+        std::cout << "Load mode: " << load_config.messages_per_second << " msgs/s from "
+                  << load_config.producers << " producer(s)\n";
+        market_data.start_load(load_config, [&router](Span<MarketRecord> records) {
+            for (const MarketRecord& record : records) submit_record(router, record);
+        });
+    } else if (feed_mode) {
+        // Feed spans are reused once the callback returns, so the strand
+        // gets its own copy.
+        bool started = feed.start([&](Span<MarketRecord> records) {
+            uint64_t feed_ticks = TscClock::now();
+            TraceContext* trace = tracer.begin();
+            auto batch = std::make_shared<std::vector<MarketRecord>>(records.begin(), records.end());
+            if (tick_recorder.is_open()) {
+                for (const MarketRecord& record : records) tick_recorder.record(record);
             }
+            dispatcher.post(STRATEGY_KEY, [&ctx, batch, feed_ticks, trace]() {
+                run_strategy_batch(ctx, Span<MarketRecord>(*batch), feed_ticks, trace);
+            });
         });
-    });
+        if (!started) {
+            std::cerr << "Feed failed: " << feed.get_error() << "\n";
+            return 1;
+        }
+        std::cout << "Feed: " << feed_config.feed_a.group << ":" << feed_config.feed_a.port;
+        if (feed_config.feed_b.port != 0) {
+            std::cout << " + " << feed_config.feed_b.group << ":" << feed_config.feed_b.port;
+        }
+        std::cout << "\n";
+    } else if (!replay_path.empty()) {
+        bool started = market_data.start_replay(replay_path, replay_config, [&](Span<MarketRecord> records) {
+            uint64_t feed_ticks = TscClock::now();
+            TraceContext* trace = tracer.begin();
+            dispatcher.post(STRATEGY_KEY, [&ctx, records, feed_ticks, trace]() {
+                run_strategy_batch(ctx, records, feed_ticks, trace);
+            });
+        });
+        if (!started) {
+            std::cerr << "Replay failed: " << market_data.get_error() << "\n";
+            return 1;
+        }
+    } else {
+        market_data.start([&](const std::vector<std::shared_ptr<Order>>& market_orders) {
+            uint64_t feed_ticks = TscClock::now();
+            TraceContext* trace = tracer.begin();
+            if (capture.is_open() || tick_recorder.is_open()) {
+                for (const auto& order : market_orders) {
+                    uint64_t wall_ns = static_cast<uint64_t>(TscClock::to_wall_ns(order->timestamp));
+                    MarketRecord record = MarketRecord::from_order(*order, wall_ns);
+                    if (capture.is_open()) capture.write(record);
+                    if (tick_recorder.is_open()) tick_recorder.record(record);
+                }
+            }
+            dispatcher.post(STRATEGY_KEY, [&ctx, market_orders, feed_ticks, trace]() {
+                run_strategy_batch(ctx, market_orders, feed_ticks, trace);
+            });
+        });
+    }
 
     auto start_time = std::chrono::steady_clock::now();
+    auto last_snapshot = start_time;
     int update_counter = 0;
 
-    std::cout << "Running. Press Enter to stop. Status every 5s.\n";
+    std::cout << "Running. Press Enter to stop." << (metrics.is_open() ? "\n" : " Status every 5s.\n");
 
     while (running) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         ++update_counter;
-        if (update_counter >= 50) {
-            update_counter = 0;
+        if (metrics.is_open()) {
+            monitor_metrics.sample(router, perf, risk, pool, feed.get_stats(), market_data.get_messages_sent(),
+                                   strategy_fills.load(std::memory_order_relaxed));
+            dispatcher.post(STRATEGY_KEY, [&strand_metrics, &strategy]() { strand_metrics.sample(strategy); });
+        }
+        if (update_counter % 10 == 0) {
+            dispatcher.post(STRATEGY_KEY, [&ctx]() { publish_stats(ctx); });
+            tracer.drain();
+            auto now = std::chrono::steady_clock::now();
+            if (!journal_prefix.empty() && snapshot_interval_s > 0 &&
+                now - last_snapshot >= std::chrono::seconds(snapshot_interval_s)) {
+                router.request_snapshots(journal_prefix);
+                last_snapshot = now;
+            }
+        }
+        if (update_counter >= 50) update_counter = 0;
+        if (update_counter == 0 && !metrics.is_open()) {
             auto now = std::chrono::steady_clock::now();
             auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time);
             auto [best_bid, best_ask] = engine.get_best_bid_ask();
-            std::cout << "Status " << elapsed.count() << "s | orders=" << engine.get_processed_orders()
-                      << " trades=" << engine.get_matched_trades()
+            std::cout << "Status " << elapsed.count() << "s | orders=" << router.get_processed_orders()
+                      << " trades=" << router.get_matched_trades()
                       << " events/s=" << std::fixed << std::setprecision(1) << perf.get_events_per_second()
                       << " avg_ns=" << engine.get_average_processing_time_ns()
-                      << " bid=" << (best_bid / 100.0) << " ask=" << (best_ask / 100.0) << "\n";
+                      << " bid=" << price_to_double(best_bid) << " ask=" << price_to_double(best_ask) << "\n";
+            if (load_mode) {
+                std::cout << "  load sent=" << market_data.get_messages_sent()
+                          << " msgs/s=" << market_data.get_messages_sent() / std::max<int64_t>(elapsed.count(), 1) << "\n";
+            }
+            if (feed_mode) {
+                FeedStats stats = feed.get_stats();
+                std::cout << "  feed records=" << stats.records << " packets_a=" << stats.packets_a
+                          << " packets_b=" << stats.packets_b << " duplicates=" << stats.duplicates
+                          << " gaps=" << stats.gaps << " lost=" << stats.lost << "\n";
+            }
+            print_latency(perf, router);
+            if (tracer.enabled()) tracer.print_report(std::cout);
+        }
+        if (!replay_path.empty() && market_data.is_finished()) {
+            std::cout << "Replay complete.\n";
+            running = false;
         }
         if (std::cin.rdbuf()->in_avail()) {
             std::string input;
@@ -119,20 +789,56 @@ int main() {
 
     std::cout << "Shutting down.\n";
     market_data.stop();
+    feed.stop();
+    tick_recorder.close();
     pool.shutdown();
+    Logger::instance().stop();
+    capture.close();
+    router.stop();
+    trade_recorder.close();
     perf.stop();
+    tracer.drain();
+    // A fresh snapshot at shutdown makes the next start replay nothing.
+    if (!journal_prefix.empty() && !router.save_snapshots(journal_prefix)) {
+        std::cerr << "Snapshot failed: " << router.get_journal_error() << "\n";
+    }
 
-    std::cout << "Final: orders=" << engine.get_processed_orders()
-              << " trades=" << engine.get_matched_trades()
+    std::cout << "Final: orders=" << router.get_processed_orders()
+              << " trades=" << router.get_matched_trades()
               << " events/s=" << std::fixed << std::setprecision(1) << perf.get_events_per_second()
               << " avg_ns=" << engine.get_average_processing_time_ns() << "\n";
+    std::cout << "Strategy fills=" << strategy_fills.load(std::memory_order_relaxed)
+              << " self_trades_prevented=" << router.get_self_trades_prevented() << "\n";
     auto [final_bid, final_ask] = engine.get_best_bid_ask();
-    std::cout << "Best bid=" << (final_bid / 100.0) << " best_ask=" << (final_ask / 100.0) << "\n";
+    std::cout << "Best bid=" << price_to_double(final_bid) << " best_ask=" << price_to_double(final_ask) << "\n";
+    print_latency(perf, router);
+    if (tracer.enabled()) {
+        tracer.print_report(std::cout);
+        if (!trace_path.empty()) {
+            if (tracer.write_chrome_trace(trace_path)) {
+                std::cout << "Wrote " << tracer.get_completed() << " traces to " << trace_path << "\n";
+            } else {
+                std::cerr << "Cannot write " << trace_path << "\n";
+            }
+        }
+    }
     print_strategy_config(strategy);
     print_strategy_status(strategy);
+    if (const Journal* journal = engine.get_journal()) {
+        std::cout << "Journal: appended=" << journal->get_appended() << " synced=" << journal->get_synced()
+                  << " stalls=" << journal->get_stalls() << " snapshots=" << engine.get_snapshots_written() << "\n";
+    }
+    for (const TickRecorder* recorder : {&tick_recorder, &trade_recorder}) {
+        if (recorder->get_recorded() == 0 && recorder->get_dropped() == 0) continue;
+        std::cout << (recorder == &tick_recorder ? "Tick store: " : "Trade store: ")
+                  << "recorded=" << recorder->get_recorded() << " dropped=" << recorder->get_dropped() << "\n";
+    }
     if (risk.get_orders_rejected() > 0) {
         std::cout << "Risk rejected " << risk.get_orders_rejected() << " orders.\n";
     }
+    if (Logger::instance().get_dropped() > 0) {
+        std::cout << "Logger dropped " << Logger::instance().get_dropped() << " records.\n";
+    }
     std::cout << "Shutdown complete.\n";
     return 0;
 }
@@ -1,38 +1,144 @@
 #include "market_data.h"
+#include "tsc_clock.h"
+#include "lockfree_ring.h"
+#include "order_id.h"
+#include "threading.h"
+#include <algorithm>
 #include <chrono>
 
-MarketData::MarketData() {}
+MarketData::MarketData(size_t num_symbols) : num_symbols_(num_symbols > 0 ? num_symbols : 1) {}
 MarketData::~MarketData() { stop(); }
 
+void MarketData::set_cpus(const std::vector<int>& cpus, int fifo_priority) {
+    cpus_ = cpus;
+    fifo_priority_ = fifo_priority;
+}
+
 void MarketData::start(MarketDataCallback callback) {
     running_ = true;
     feed_thread_ = std::thread(&MarketData::feed_loop, this, callback);
 }
 
+bool MarketData::start_replay(const std::string& path, const ReplayConfig& config, MarketRecordCallback callback) {
+    if (!capture_.open(path)) return false;
+    running_ = true;
+    finished_ = false;
+    feed_thread_ = std::thread(&MarketData::replay_loop, this, config, callback);
+    return true;
+}
+
+void MarketData::start_load(const LoadConfig& config, MarketRecordCallback callback) {
+    size_t producers = std::max<size_t>(config.producers, 1);
+    // Generate everything up front so the producers only pace and hand out.
+    LoadGenerator generator(config);
+    load_streams_.clear();
+    for (size_t i = 0; i < producers; ++i) {
+        run_on_cpu(cpu_for(i), [&]() { load_streams_.push_back(generator.generate(i)); });
+    }
+    running_ = true;
+    messages_sent_ = 0;
+    double rate = config.messages_per_second / static_cast<double>(producers);
+    size_t batch_size = std::max<size_t>(config.batch_size, 1);
+    for (size_t i = 0; i < producers; ++i) {
+        load_threads_.emplace_back(&MarketData::load_loop, this, i, rate, batch_size, callback);
+    }
+}
+
 void MarketData::stop() {
     running_ = false;
     if (feed_thread_.joinable()) feed_thread_.join();
+    for (auto& thread : load_threads_) {
+        if (thread.joinable()) thread.join();
+    }
+    load_threads_.clear();
 }
 
 void MarketData::feed_loop(MarketDataCallback callback) {
+    place_current_thread(cpu_for(0), fifo_priority_);
     std::mt19937 rng(std::random_device{}());
     std::uniform_int_distribution<int> side_dist(0, 1);
     std::uniform_real_distribution<double> price_dist(99.0, 101.0);
     std::uniform_int_distribution<int> qty_dist(1, 10);
     std::uniform_int_distribution<int> type_dist(0, 1);
-    OrderId next_id = 1;
+    std::uniform_int_distribution<SymbolId> symbol_dist(0, static_cast<SymbolId>(num_symbols_ - 1));
+    OrderIdGenerator order_ids(OrderIdGenerator::SIMULATED_FEED_SOURCE);
     while (running_) {
         std::vector<std::shared_ptr<Order>> orders;
         for (int i = 0; i < 10; ++i) {
             auto order = std::make_shared<Order>();
-            order->order_id = next_id++;
+            order->order_id = order_ids.next();
             order->side = side_dist(rng) == 0 ? OrderSide::BUY : OrderSide::SELL;
-            order->price = static_cast<Price>(price_dist(rng) * 100.0);
+            order->price = double_to_price(price_dist(rng));
             order->quantity = static_cast<Quantity>(qty_dist(rng));
             order->type = type_dist(rng) == 0 ? OrderType::LIMIT : OrderType::MARKET;
+            order->symbol = symbol_dist(rng);
             orders.push_back(order);
         }
+        TscClock::stamp_batch(orders);
         callback(orders);
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
-} 
\ No newline at end of file
+}
+
+void MarketData::replay_loop(ReplayConfig config, MarketRecordCallback callback) {
+    place_current_thread(cpu_for(0), fifo_priority_);
+    Span<MarketRecord> records = capture_.records();
+    size_t batch_size = config.batch_size > 0 ? config.batch_size : 1;
+    double speed = config.speed > 0.0 ? config.speed : 1.0;
+    auto wall_start = std::chrono::steady_clock::now();
+    uint64_t first_ns = records.empty() ? 0 : records[0].timestamp_ns;
+    size_t pos = 0;
+    while (running_ && pos < records.size()) {
+        size_t end = std::min(pos + batch_size, records.size());
+        if (config.paced) {
+            // Deliver the batch when its first record is due, and never
+            // include records that are not due yet.
+            auto due = [&](size_t i) {
+                uint64_t elapsed = records[i].timestamp_ns > first_ns ? records[i].timestamp_ns - first_ns : 0;
+                auto offset = std::chrono::nanoseconds(static_cast<int64_t>(elapsed / speed));
+                return wall_start + offset;
+            };
+            auto first_due = due(pos);
+            while (running_ && std::chrono::steady_clock::now() < first_due) {
+                auto wait = first_due - std::chrono::steady_clock::now();
+                if (wait > std::chrono::microseconds(200)) std::this_thread::sleep_for(wait - std::chrono::microseconds(100));
+            }
+            auto now = std::chrono::steady_clock::now();
+            size_t ready = pos + 1;
+            while (ready < end && due(ready) <= now) ++ready;
+            end = ready;
+        }
+        callback(Span<MarketRecord>(records.data() + pos, end - pos));
+        pos = end;
+    }
+    finished_.store(true, std::memory_order_release);
+}
+
+void MarketData::load_loop(size_t producer, double rate, size_t batch_size, MarketRecordCallback callback) {
+    place_current_thread(cpu_for(producer), fifo_priority_);
+    const std::vector<MarketRecord>& stream = load_streams_[producer];
+    if (stream.empty() || rate <= 0.0) return;
+    // Batches are released on a fixed schedule; if the consumer falls
+    // behind, the schedule is not reset, so the producer catches up with
+    // back-to-back batches and the long-run rate stays on target.
+    auto interval = std::chrono::duration<double>(static_cast<double>(batch_size) / rate);
+    auto next = std::chrono::steady_clock::now();
+    size_t pos = 0;
+    while (running_) {
+        size_t count = std::min(batch_size, stream.size() - pos);
+        callback(Span<MarketRecord>(stream.data() + pos, count));
+        messages_sent_.fetch_add(count, std::memory_order_relaxed);
+        pos = pos + count == stream.size() ? 0 : pos + count;
+
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval * (static_cast<double>(count) / batch_size));
+        while (running_) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= next) break;
+            if (next - now > std::chrono::microseconds(200)) {
+                std::this_thread::sleep_for(next - now - std::chrono::microseconds(100));
+            } else {
+                cpu_relax();
+            }
+        }
+    }
+}
@@ -4,17 +4,48 @@
 #include <thread>
 #include <atomic>
 #include <random>
+#include <string>
 #include "order_book.h"
+#include "replay.h"
+#include "load_generator.h"
 
 class MarketData {
 public:
     using MarketDataCallback = std::function<void(const std::vector<std::shared_ptr<Order>>&)>;
-    MarketData();
+    // Replay batches point straight into the mapped capture file and stay
+    // valid until the next start_replay() or destruction, so consumers may
+    // still be draining them after stop().
+    using MarketRecordCallback = std::function<void(Span<MarketRecord>)>;
+    explicit MarketData(size_t num_symbols = 1);
     ~MarketData();
+    // Simulated feed: random orders, 10 per batch every 10ms.
     void start(MarketDataCallback callback);
+    // Replays a capture file, then stops on its own (see is_finished()).
+    bool start_replay(const std::string& path, const ReplayConfig& config, MarketRecordCallback callback);
+    // Load mode: each producer thread loops over its own pregenerated stream
+    // at its share of the target rate. The callback runs concurrently on
+    // every producer thread; batches stay valid as long as the MarketData.
+    void start_load(const LoadConfig& config, MarketRecordCallback callback);
+    // Call before starting: the feed or replay thread pins to cpus[0] and
+    // load producer i to cpus[i % size], which also builds its stream.
+    void set_cpus(const std::vector<int>& cpus, int fifo_priority = 0);
     void stop();
+    uint64_t get_messages_sent() const { return messages_sent_.load(std::memory_order_relaxed); }
+    bool is_finished() const { return finished_.load(std::memory_order_acquire); }
+    const std::string& get_error() const { return capture_.error(); }
 private:
     std::thread feed_thread_;
     std::atomic<bool> running_{false};
+    std::atomic<bool> finished_{false};
+    size_t num_symbols_;
+    CaptureFile capture_;
+    std::vector<std::thread> load_threads_;
+    std::vector<std::vector<MarketRecord>> load_streams_;
+    std::atomic<uint64_t> messages_sent_{0};
+    std::vector<int> cpus_;
+    int fifo_priority_ = 0;
+    int cpu_for(size_t thread) const { return cpus_.empty() ? -1 : cpus_[thread % cpus_.size()]; }
     void feed_loop(MarketDataCallback callback);
+    void load_loop(size_t producer, double rate, size_t batch_size, MarketRecordCallback callback);
+    void replay_loop(ReplayConfig config, MarketRecordCallback callback);
 }; 
\ No newline at end of file
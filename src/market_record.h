@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include "order_book.h"
+
+// Fixed-size record in a market-data capture file. Records are packed
+// back to back after a CaptureHeader and read in place from the mapping.
+struct MarketRecord {
+    enum class Kind : uint8_t { ADD = 0, CANCEL = 1, TRADE = 2, MODIFY = 3 };
+
+    uint64_t timestamp_ns;  // Capture time (Unix ns); drives paced replay
+    OrderId order_id;       // TRADE: the aggressing order; MODIFY: the order to replace
+    Price price;            // MODIFY: new price and quantity
+    Quantity quantity;
+    SymbolId symbol;
+    Kind kind;
+    OrderSide side;
+    OrderType type;
+    ParticipantId participant;  // 0 in captures written before participants existed
+
+    static MarketRecord from_order(const Order& order, uint64_t timestamp_ns) {
+        return MarketRecord{timestamp_ns, order.order_id, order.price, order.quantity, order.symbol,
+                            Kind::ADD, order.side, order.type, order.participant};
+    }
+    // An engine trade as a print: the aggressing order's ID, side and owner
+    // (the passive order ID is not kept).
+    static MarketRecord from_trade(const TradeEvent& trade, uint64_t timestamp_ns) {
+        bool buy = trade.aggressor == OrderSide::BUY;
+        return MarketRecord{timestamp_ns, buy ? trade.buy_order_id : trade.sell_order_id, trade.price, trade.quantity,
+                            trade.symbol, Kind::TRADE, trade.aggressor, OrderType::MARKET,
+                            buy ? trade.buy_participant : trade.sell_participant};
+    }
+    Order to_order() const {
+        Order order(order_id, side, price, quantity, type, symbol);
+        order.participant = participant;
+        return order;
+    }
+    // Records the strategies read as a price print.
+    bool is_price_observation() const {
+        return kind == Kind::TRADE || (kind == Kind::ADD && type == OrderType::MARKET);
+    }
+};
+
+static_assert(sizeof(MarketRecord) == 40, "MarketRecord layout is part of the capture file format");
+static_assert(std::is_trivially_copyable<MarketRecord>::value, "MarketRecord must be readable in place");
+
+struct CaptureHeader {
+    static constexpr uint32_t MAGIC = 0x444d584e;  // "NXMD"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t record_size = sizeof(MarketRecord);
+    uint32_t reserved = 0;
+    uint64_t record_count = 0;
+};
+
+static_assert(sizeof(CaptureHeader) == 24, "CaptureHeader layout is part of the capture file format");
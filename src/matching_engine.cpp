@@ -1,110 +1,711 @@
 #include "matching_engine.h"
+#include "threading.h"
+#include "tsc_clock.h"
 #include <algorithm>
+#include <chrono>
+#include <limits>
 
-MatchingEngine::MatchingEngine() : bid_side_(true), ask_side_(false) {}
+MatchingEngine::MatchingEngine() : MatchingEngine(EngineConfig()) {}
 
-void MatchingEngine::add_order(std::shared_ptr<Order> order) {
+MatchingEngine::MatchingEngine(const EngineConfig& config)
+    : config_(config),
+      order_pool_(config.order_capacity),
+      bid_side_(true, config.ladder_levels),
+      ask_side_(false, config.ladder_levels),
+      order_lookup_(config.order_capacity) {
+    trade_tail_.reserve(config.trade_tail_capacity);
+    publish_top_of_book();
+    TscClock::ns_per_tick();  // Calibrate before the first order is timed
+}
+
+MatchingEngine::~MatchingEngine() {
+    stop();
+    std::lock_guard<std::mutex> lock(snapshot_thread_mutex_);
+    if (snapshot_thread_.joinable()) snapshot_thread_.join();
+}
+
+void MatchingEngine::add_order(const Order& order) {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    if (journal_) journal(MarketRecord::Kind::ADD, order);
+    process_order(order);
+    poll_snapshot();
+}
+
+bool MatchingEngine::cancel_order(OrderId order_id) {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    if (journal_) {
+        Order order;
+        order.order_id = order_id;
+        journal(MarketRecord::Kind::CANCEL, order);
+    }
+    bool cancelled = process_cancel(order_id);
+    poll_snapshot();
+    return cancelled;
+}
+
+bool MatchingEngine::modify_order(OrderId order_id, Price new_price, Quantity new_quantity) {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    if (journal_) {
+        Order order;
+        order.order_id = order_id;
+        order.price = new_price;
+        order.quantity = new_quantity;
+        journal(MarketRecord::Kind::MODIFY, order);
+    }
+    bool modified = process_modify(order_id, new_price, new_quantity);
+    poll_snapshot();
+    return modified;
+}
+
+void MatchingEngine::execute(const EngineCommand& command) {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    process_command(command);
+}
+
+void MatchingEngine::execute(Span<EngineCommand> commands) {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    process_batch(commands);
+}
+
+size_t MatchingEngine::submit_batch(Span<Order> orders, TradeEvent* fills, size_t max_fills) {
+    if (orders.empty()) return 0;
+    if (is_running()) {
+        size_t chunk = std::min(orders.size(), ingress_->capacity());
+        for (size_t done = 0; done < orders.size(); done += chunk) {
+            size_t count = std::min(chunk, orders.size() - done);
+            auto command_at = [&](size_t i) {
+                EngineCommand command;
+                command.order = orders[done + i];
+                return command;
+            };
+            while (!ingress_->try_push_n(count, command_at)) std::this_thread::yield();
+        }
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    fill_out_ = fills;
+    fill_capacity_ = fills ? max_fills : 0;
+    fill_count_ = 0;
+    uint64_t start_ticks = TscClock::now();
+    match_time_ = start_ticks;
+    for (const Order& order : orders) {
+        if (journal_) journal(MarketRecord::Kind::ADD, order);
+        match_order(order);
+    }
+    uint64_t ticks = TscClock::now() - start_ticks;
+    bump(counters_.total_processing_ticks, ticks);
+    match_latency_.record(TscClock::to_ns(ticks) / orders.size());
+    bump(counters_.processed_orders, orders.size());
+    size_t copied = fill_count_;
+    fill_out_ = nullptr;
+    fill_capacity_ = 0;
+    poll_snapshot();
+    return copied;
+}
+
+void MatchingEngine::start(int cpu) {
+    if (is_running()) return;
+    // The ring must exist before a submitter can see is_running().
+    if (!ingress_) ingress_ = std::make_unique<MpscRing<EngineCommand>>(config_.ingress_capacity);
+    matcher_running_.store(true, std::memory_order_release);
+    matcher_thread_ = std::thread(&MatchingEngine::matcher_loop, this, cpu);
+}
+
+void MatchingEngine::stop() {
+    matcher_running_.store(false, std::memory_order_release);
+    if (matcher_thread_.joinable()) matcher_thread_.join();
+}
+
+void MatchingEngine::submit_order(const Order& order, TraceContext* trace) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::ADD;
+    command.order = order;
+    command.trace = trace;
+    if (!is_running()) {
+        execute(command);
+        return;
+    }
+    while (!ingress_->try_push(command)) std::this_thread::yield();
+}
+
+void MatchingEngine::submit_cancel(OrderId order_id) {
+    if (!is_running()) {
+        cancel_order(order_id);
+        return;
+    }
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::CANCEL;
+    command.order.order_id = order_id;
+    while (!ingress_->try_push(command)) std::this_thread::yield();
+}
+
+void MatchingEngine::submit_modify(OrderId order_id, Price new_price, Quantity new_quantity) {
+    if (!is_running()) {
+        modify_order(order_id, new_price, new_quantity);
+        return;
+    }
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::MODIFY;
+    command.order.order_id = order_id;
+    command.order.price = new_price;
+    command.order.quantity = new_quantity;
+    while (!ingress_->try_push(command)) std::this_thread::yield();
+}
+
+void MatchingEngine::matcher_loop(int cpu) {
+    if (cpu >= 0) pin_current_thread(cpu);
+    constexpr size_t MAX_BATCH = 256;
+    EngineCommand command;
+    std::vector<EngineCommand> batch;
+    batch.reserve(MAX_BATCH);
+    IdleWaiter waiter(config_.wait);
+    while (matcher_running_.load(std::memory_order_acquire)) {
+        if (!ingress_->try_pop(command)) {
+            waiter.idle();
+            continue;
+        }
+        waiter.reset();
+        // The lock is uncontended unless a direct caller or a cold reader
+        // runs concurrently; producers never touch it.
+        batch.clear();
+        do {
+            batch.push_back(command);
+        } while (batch.size() < MAX_BATCH && ingress_->try_pop(command));
+        std::lock_guard<std::mutex> lock(engine_mutex_);
+        process_batch(batch);
+    }
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    while (ingress_->try_pop(command)) process_command(command);
+}
+
+void MatchingEngine::process_command(const EngineCommand& command, bool timed) {
+    if (command.trace) command.trace->stamp(TraceStage::MATCH_START);
+    switch (command.kind) {
+    case EngineCommand::Kind::ADD:
+        if (journal_) journal(MarketRecord::Kind::ADD, command.order);
+        if (timed) {
+            process_order(command.order);
+        } else {
+            match_order(command.order);
+        }
+        break;
+    case EngineCommand::Kind::CANCEL:
+        if (journal_) journal(MarketRecord::Kind::CANCEL, command.order);
+        process_cancel(command.order.order_id);
+        break;
+    case EngineCommand::Kind::MODIFY:
+        if (journal_) journal(MarketRecord::Kind::MODIFY, command.order);
+        process_modify(command.order.order_id, command.order.price, command.order.quantity);
+        break;
+    }
+    if (command.trace) {
+        command.trace->stamp(TraceStage::MATCH_DONE);
+        command.trace->finish();
+    }
+    poll_snapshot();
+}
+
+// One pair of clock reads for the batch, as in submit_batch; cancels and
+// modifies stamp their own trades as usual. The sample is the per-command
+// average, and the adds are charged their share of the batch's ticks.
+void MatchingEngine::process_batch(Span<EngineCommand> commands) {
+    uint64_t start_ticks = TscClock::now();
+    match_time_ = start_ticks;
+    uint64_t adds = 0;
+    for (const EngineCommand& command : commands) {
+        if (command.kind == EngineCommand::Kind::ADD) ++adds;
+        process_command(command, false);
+    }
+    if (adds == 0) return;
+    uint64_t ticks = TscClock::now() - start_ticks;
+    bump(counters_.total_processing_ticks, ticks * adds / commands.size());
+    match_latency_.record(TscClock::to_ns(ticks) / commands.size());
+    bump(counters_.processed_orders, adds);
+}
+
+bool MatchingEngine::open_journal(const std::string& path, const JournalConfig& config) {
     std::lock_guard<std::mutex> lock(engine_mutex_);
-    auto start_time = std::chrono::steady_clock::now();
-    if (order->type == OrderType::MARKET) {
-        process_market_order(order);
+    auto journal = std::make_unique<Journal>(config);
+    if (!journal->open(path)) {
+        journal_error_ = journal->error();
+        return false;
+    }
+    journal_ = std::move(journal);
+    return true;
+}
+
+bool MatchingEngine::request_snapshot(const std::string& path) {
+    if (snapshot_busy_.exchange(true, std::memory_order_acq_rel)) return false;
+    std::lock_guard<std::mutex> lock(snapshot_thread_mutex_);
+    // The previous writer has finished (it cleared busy as its last step).
+    if (snapshot_thread_.joinable()) snapshot_thread_.join();
+    snapshot_path_ = path;
+    snapshot_requested_.store(true, std::memory_order_release);
+    snapshot_thread_ = std::thread(&MatchingEngine::write_snapshot, this);
+    return true;
+}
+
+bool MatchingEngine::save_snapshot(const std::string& path) {
+    uint64_t written = get_snapshots_written();
+    // Let a periodic snapshot that is still being written finish first.
+    while (!request_snapshot(path)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    // Another caller may already have joined our writer and started the
+    // next one; waiting on that instead is harmless.
+    std::lock_guard<std::mutex> lock(snapshot_thread_mutex_);
+    if (snapshot_thread_.joinable()) snapshot_thread_.join();
+    return get_snapshots_written() > written;
+}
+
+std::string MatchingEngine::get_snapshot_error() const {
+    std::lock_guard<std::mutex> lock(snapshot_error_mutex_);
+    return snapshot_error_;
+}
+
+// Runs under the book lock on the thread that applies commands.
+void MatchingEngine::capture_snapshot() {
+    snapshot_orders_.clear();
+    snapshot_orders_.reserve(order_lookup_.size());
+    auto copy_level = [this](const OrderBookLevel& level) {
+        for (const RestingOrder* order = level.get_front_order(); order; order = order->next) {
+            snapshot_orders_.push_back(SnapshotOrder::from_order(order->to_order()));
+        }
+        return true;
+    };
+    bid_side_.for_each_level(copy_level);
+    size_t bids = snapshot_orders_.size();
+    ask_side_.for_each_level(copy_level);
+
+    snapshot_header_ = SnapshotHeader();
+    snapshot_header_.symbol = config_.symbol;
+    snapshot_header_.journal_sequence = journal_ ? journal_->get_appended() : 0;
+    snapshot_header_.wall_ns = static_cast<uint64_t>(TscClock::to_wall_ns(TscClock::now()));
+    snapshot_header_.processed_orders = counters_.processed_orders.load(std::memory_order_relaxed);
+    snapshot_header_.matched_trades = counters_.matched_trades.load(std::memory_order_relaxed);
+    snapshot_header_.rejected_orders = counters_.rejected_orders.load(std::memory_order_relaxed);
+    snapshot_header_.bid_orders = bids;
+    snapshot_header_.ask_orders = snapshot_orders_.size() - bids;
+    snapshot_requested_.store(false, std::memory_order_release);
+}
+
+void MatchingEngine::write_snapshot() {
+    // Give the command thread a moment to capture between commands; an
+    // idle engine is captured here instead, where the lock is free.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+    while (snapshot_requested_.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    {
+        std::lock_guard<std::mutex> lock(engine_mutex_);
+        poll_snapshot();
+    }
+    std::string error;
+    // A snapshot must never get ahead of the journal on disk: recovery
+    // replays the journal from the snapshot's sequence, and after a crash
+    // entries still in the journal's ring would be gone.
+    bool ok = true;
+    uint64_t covered = snapshot_header_.journal_sequence;
+    if (journal_ && !journal_->wait_durable(covered, std::chrono::seconds(5))) {
+        error = "journal did not reach sequence " + std::to_string(covered) + " on disk; snapshot skipped";
+        ok = false;
+    }
+    ok = ok && write_snapshot_file(snapshot_path_, snapshot_header_, snapshot_orders_, error);
+    if (ok) {
+        snapshots_written_.fetch_add(1, std::memory_order_relaxed);
     } else {
-        process_limit_order(order);
+        std::lock_guard<std::mutex> lock(snapshot_error_mutex_);
+        snapshot_error_ = error;
     }
-    auto end_time = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time);
-    total_processing_time_ns_ += duration.count();
-    processed_orders_++;
+    snapshot_busy_.store(false, std::memory_order_release);
 }
 
-bool MatchingEngine::cancel_order(OrderId order_id) {
+bool MatchingEngine::restore_snapshot(const std::string& path, SnapshotHeader& restored) {
+    SnapshotFile file;
+    if (!file.open(path)) {
+        std::lock_guard<std::mutex> lock(snapshot_error_mutex_);
+        snapshot_error_ = file.error();
+        return false;
+    }
     std::lock_guard<std::mutex> lock(engine_mutex_);
-    auto it = order_lookup_.find(order_id);
-    if (it == order_lookup_.end()) {
+    if (!order_lookup_.empty()) {
+        std::lock_guard<std::mutex> error_lock(snapshot_error_mutex_);
+        snapshot_error_ = "cannot restore a snapshot into a non-empty book";
         return false;
     }
-    Price price = it->second.first;
-    OrderSide side = it->second.second;
-    bool removed = false;
-    if (side == OrderSide::BUY) {
-        removed = bid_side_.remove_order(order_id, price);
+    Timestamp now = TscClock::now();
+    for (const SnapshotOrder& saved : file.orders()) {
+        Order order(saved.order_id, saved.side, saved.price, saved.quantity, saved.type, config_.symbol);
+        order.participant = saved.participant;
+        order.timestamp = now;
+        rest(saved.side == OrderSide::BUY ? bid_side_ : ask_side_, order);
+    }
+    const SnapshotHeader& header = file.header();
+    counters_.processed_orders.store(header.processed_orders, std::memory_order_relaxed);
+    counters_.matched_trades.store(header.matched_trades, std::memory_order_relaxed);
+    counters_.rejected_orders.store(header.rejected_orders, std::memory_order_relaxed);
+    publish_top_of_book();
+    restored = header;
+    return true;
+}
+
+// Only the command is journaled (the writer fills in wall time); fills
+// are recomputed on replay.
+void MatchingEngine::journal(MarketRecord::Kind kind, const Order& order) {
+    MarketRecord record = MarketRecord::from_order(order, 0);
+    record.kind = kind;
+    if (kind != MarketRecord::Kind::ADD) record.symbol = config_.symbol;
+    journal_->append(record);
+}
+
+void MatchingEngine::process_order(const Order& order) {
+    uint64_t start_ticks = TscClock::now();
+    match_time_ = start_ticks;  // Every trade from this order shares one stamp
+    match_order(order);
+    uint64_t ticks = TscClock::now() - start_ticks;
+    bump(counters_.total_processing_ticks, ticks);
+    match_latency_.record(TscClock::to_ns(ticks));
+    bump(counters_.processed_orders);
+}
+
+void MatchingEngine::match_order(const Order& order) {
+    // Match from a stack copy; a pool node is only taken if the order rests.
+    Order incoming = order;
+    if (incoming.side == OrderSide::BUY) {
+        process_side<OrderSide::BUY>(incoming);
     } else {
-        removed = ask_side_.remove_order(order_id, price);
+        process_side<OrderSide::SELL>(incoming);
     }
-    if (removed) {
-        order_lookup_.erase(it);
+    publish_top_of_book();
+}
+
+bool MatchingEngine::process_cancel(OrderId order_id) {
+    RestingOrder* order = order_lookup_.take(order_id);
+    if (!order) {
+        return false;
+    }
+    match_time_ = TscClock::now();
+    if (order->info().side == OrderSide::BUY) {
+        bid_side_.remove_order(order);
+    } else {
+        ask_side_.remove_order(order);
     }
-    return removed;
+    order_pool_.release(order);
+    publish_top_of_book();
+    return true;
+}
+
+bool MatchingEngine::process_modify(OrderId order_id, Price new_price, Quantity new_quantity) {
+    if (new_quantity == 0) return process_cancel(order_id);
+    RestingOrder* node = order_lookup_.find(order_id);
+    if (!node) {
+        return false;
+    }
+    OrderBookSide& side = node->info().side == OrderSide::BUY ? bid_side_ : ask_side_;
+    if (new_price == node->info().price && new_quantity <= node->quantity) {
+        match_time_ = TscClock::now();
+        side.reduce_order(node, node->quantity - new_quantity);
+        publish_top_of_book();
+        return true;
+    }
+
+    // Sizes a node cannot hold, and post-only orders repriced through the
+    // far side (they would take liquidity), are rejected and leave the
+    // resting order as it was.
+    if (new_quantity > RestingOrder::MAX_QUANTITY) {
+        bump(counters_.rejected_orders);
+        return false;
+    }
+    OrderBookSide& opposite = node->info().side == OrderSide::BUY ? ask_side_ : bid_side_;
+    if (node->info().type == OrderType::POST_ONLY && !opposite.is_empty() &&
+        opposite.crosses(new_price, opposite.get_best_price())) {
+        bump(counters_.rejected_orders);
+        return false;
+    }
+
+    uint64_t start_ticks = TscClock::now();
+    match_time_ = start_ticks;
+    // Losing priority: unlink the node, match a copy of it like a new order,
+    // then requeue the same node with whatever is left.
+    side.remove_order(node);
+    Order order = node->to_order();
+    order.price = new_price;
+    order.quantity = new_quantity;
+    order.timestamp = start_ticks;
+    if (order.side == OrderSide::BUY) {
+        match<OrderSide::BUY>(order, new_price);
+    } else {
+        match<OrderSide::SELL>(order, new_price);
+    }
+    if (order.quantity == 0) {
+        order_lookup_.erase(order_id);
+        order_pool_.release(node);
+    } else {
+        node->quantity = static_cast<uint32_t>(order.quantity);
+        node->info().price = new_price;
+        node->info().timestamp = start_ticks;
+        side.add_order(node);
+    }
+    publish_top_of_book();
+    uint64_t ticks = TscClock::now() - start_ticks;
+    match_latency_.record(TscClock::to_ns(ticks));
+    return true;
+}
+
+void MatchingEngine::publish_top_of_book() {
+    publish_deltas();
+    top_of_book_.store({bid_side_.get_best_price(), ask_side_.get_best_price()});
+    if (!config_.publish_depth || (!bid_side_.depth_changed() && !ask_side_.depth_changed())) return;
+    // Only the side that changed is re-walked; the other keeps its levels.
+    if (bid_side_.depth_changed()) {
+        depth_scratch_.bid_levels = static_cast<uint32_t>(bid_side_.publish_depth(depth_scratch_.bids, BookDepth::LEVELS));
+    }
+    if (ask_side_.depth_changed()) {
+        depth_scratch_.ask_levels = static_cast<uint32_t>(ask_side_.publish_depth(depth_scratch_.asks, BookDepth::LEVELS));
+    }
+    depth_.store(depth_scratch_);
+}
+
+void MatchingEngine::publish_deltas() {
+    if (!deltas_) return;
+    publish_levels(bid_side_, OrderSide::BUY);
+    publish_levels(ask_side_, OrderSide::SELL);
+}
+
+void MatchingEngine::publish_levels(OrderBookSide& side, OrderSide which) {
+    for (const OrderBookSide::LevelChange& change : side.changes()) {
+        const OrderBookLevel* level = side.find_level(change.price);
+        // A level created and emptied by the same command was never seen.
+        if (!level && change.created) continue;
+        BookDelta delta{};
+        delta.price = change.price;
+        delta.side = which;
+        if (level) {
+            delta.kind = change.created ? BookDelta::Kind::LEVEL_ADD : BookDelta::Kind::LEVEL_CHANGE;
+            delta.quantity = level->get_total_quantity();
+            delta.orders = level->get_order_count();
+        } else {
+            delta.kind = BookDelta::Kind::LEVEL_DELETE;
+        }
+        emit_delta(delta);
+    }
+    side.changes().clear();
+}
+
+void MatchingEngine::emit_delta(BookDelta& delta) {
+    uint64_t sequence = delta_sequence_.load(std::memory_order_relaxed);
+    delta.sequence = sequence;
+    delta.timestamp = match_time_;
+    delta.symbol = config_.symbol;
+    deltas_->write(delta);
+    delta_sequence_.store(sequence + 1, std::memory_order_relaxed);
+}
+
+bool MatchingEngine::open_delta_ring(const std::string& name, size_t capacity) {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    auto ring = std::make_unique<BroadcastWriter<BookDelta>>();
+    if (!ring->create(name, capacity)) {
+        delta_error_ = ring->error();
+        return false;
+    }
+    deltas_ = std::move(ring);
+    bid_side_.track_changes(true);
+    ask_side_.track_changes(true);
+    return true;
+}
+
+void MatchingEngine::publish_trade(const TradeEvent& trade) {
+    if (fill_count_ < fill_capacity_) fill_out_[fill_count_++] = trade;
+    if (trade_callback_) trade_callback_(trade);
+    if (!participant_callbacks_.empty()) {
+        const TradeCallback& buyer = participant_callbacks_[trade.buy_participant];
+        if (buyer) buyer(trade);
+        const TradeCallback& seller = participant_callbacks_[trade.sell_participant];
+        if (seller && trade.sell_participant != trade.buy_participant) seller(trade);
+    }
+    if (deltas_) {
+        BookDelta delta{};
+        delta.price = trade.price;
+        delta.quantity = trade.quantity;
+        delta.kind = BookDelta::Kind::TRADE;
+        delta.side = trade.aggressor;
+        emit_delta(delta);
+    }
+    for (const auto& ring : trade_subscribers_) {
+        if (!ring->try_push(trade)) bump(counters_.dropped_trades);
+    }
+    if (config_.trade_tail_capacity == 0) return;
+    if (trade_tail_.size() < config_.trade_tail_capacity) {
+        trade_tail_.push_back(trade);
+    } else {
+        trade_tail_[trade_tail_next_] = trade;
+    }
+    trade_tail_next_ = (trade_tail_next_ + 1) % config_.trade_tail_capacity;
+}
+
+void MatchingEngine::set_trade_callback(TradeCallback callback) {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    trade_callback_ = std::move(callback);
+}
+
+void MatchingEngine::set_participant_callback(ParticipantId participant, TradeCallback callback) {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    if (participant_callbacks_.empty()) participant_callbacks_.resize(std::numeric_limits<ParticipantId>::max() + 1);
+    participant_callbacks_[participant] = std::move(callback);
+}
+
+void MatchingEngine::set_unfilled_callback(ParticipantId participant, OrderCallback callback) {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    if (unfilled_callbacks_.empty()) unfilled_callbacks_.resize(std::numeric_limits<ParticipantId>::max() + 1);
+    unfilled_callbacks_[participant] = std::move(callback);
+}
+
+void MatchingEngine::report_unfilled(const Order& order, Quantity unfilled) {
+    if (unfilled_callbacks_.empty()) return;
+    const OrderCallback& callback = unfilled_callbacks_[order.participant];
+    if (!callback) return;
+    Order report = order;
+    report.quantity = unfilled;
+    callback(report);
+}
+
+std::shared_ptr<TradeRing> MatchingEngine::subscribe_trades(size_t capacity) {
+    auto ring = std::make_shared<TradeRing>(capacity);
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    trade_subscribers_.push_back(ring);
+    return ring;
 }
 
 std::vector<TradeEvent> MatchingEngine::get_trade_events() const {
     std::lock_guard<std::mutex> lock(engine_mutex_);
-    return trade_events_;
+    std::vector<TradeEvent> trades;
+    trades.reserve(trade_tail_.size());
+    // Oldest first: once the tail has wrapped, the next slot is the oldest.
+    size_t start = trade_tail_.size() < config_.trade_tail_capacity ? 0 : trade_tail_next_;
+    for (size_t i = 0; i < trade_tail_.size(); ++i) {
+        trades.push_back(trade_tail_[(start + i) % trade_tail_.size()]);
+    }
+    return trades;
 }
 
-uint64_t MatchingEngine::get_processed_orders() const { return processed_orders_.load(); }
-uint64_t MatchingEngine::get_matched_trades() const { return matched_trades_.load(); }
+uint64_t MatchingEngine::get_processed_orders() const { return counters_.processed_orders.load(std::memory_order_relaxed); }
+uint64_t MatchingEngine::get_matched_trades() const { return counters_.matched_trades.load(std::memory_order_relaxed); }
 double MatchingEngine::get_average_processing_time_ns() const {
-    uint64_t orders = processed_orders_.load();
-    return orders > 0 ? static_cast<double>(total_processing_time_ns_.load()) / orders : 0.0;
+    uint64_t orders = counters_.processed_orders.load(std::memory_order_relaxed);
+    uint64_t ticks = counters_.total_processing_ticks.load(std::memory_order_relaxed);
+    return orders > 0 ? static_cast<double>(TscClock::to_ns(ticks)) / orders : 0.0;
 }
 std::pair<Price, Price> MatchingEngine::get_best_bid_ask() const {
+    TopOfBook top = top_of_book_.load();
+    return {top.best_bid, top.best_ask};
+}
+size_t MatchingEngine::get_depth(OrderSide side, DepthLevel* out, size_t n) const {
     std::lock_guard<std::mutex> lock(engine_mutex_);
-    return {bid_side_.get_best_price(), ask_side_.get_best_price()};
+    return side == OrderSide::BUY ? bid_side_.get_depth(out, n) : ask_side_.get_depth(out, n);
 }
 
-void MatchingEngine::process_market_order(std::shared_ptr<Order> order) {
-    if (order->side == OrderSide::BUY) {
-        match_order_against_side(order, ask_side_);
-    } else {
-        match_order_against_side(order, bid_side_);
+template <OrderSide S>
+void MatchingEngine::process_side(Order& order) {
+    OrderBookSide& opposite = opposite_side<S>();
+    // A market order is an IOC with no price limit.
+    Price limit = order.type != OrderType::MARKET ? order.price
+                : S == OrderSide::BUY ? std::numeric_limits<Price>::max() : 0;
+    const Quantity ordered = order.quantity;
+    Quantity traded = 0;
+    bool rested = false;
+    switch (order.type) {
+    case OrderType::LIMIT:
+        traded = match<S>(order, limit);
+        if (order.quantity > 0) rested = rest(own_side<S>(), order);
+        break;
+    case OrderType::MARKET:
+    case OrderType::IOC:
+        traded = match<S>(order, limit);
+        break;
+    case OrderType::FOK:
+        if (opposite.available_through(limit, order.quantity) < order.quantity) {
+            bump(counters_.rejected_orders);
+            break;
+        }
+        traded = match<S>(order, limit);
+        break;
+    case OrderType::POST_ONLY:
+        if (!opposite.is_empty() && opposite.crosses(limit, opposite.get_best_price())) {
+            bump(counters_.rejected_orders);
+            break;
+        }
+        rested = rest(own_side<S>(), order);
+        break;
     }
+    // What neither traded nor rests: IOC remainders, rejections, and
+    // whatever self-trade prevention cancelled.
+    Quantity unfilled = ordered - traded - (rested ? order.quantity : 0);
+    if (unfilled > 0) report_unfilled(order, unfilled);
 }
 
-void MatchingEngine::process_limit_order(std::shared_ptr<Order> order) {
-    if (order->side == OrderSide::BUY) {
-        match_order_against_side(order, ask_side_);
-        if (order->quantity > 0) {
-            bid_side_.add_order(order);
-            order_lookup_[order->order_id] = {order->price, order->side};
-        }
-    } else {
-        match_order_against_side(order, bid_side_);
-        if (order->quantity > 0) {
-            ask_side_.add_order(order);
-            order_lookup_[order->order_id] = {order->price, order->side};
-        }
+bool MatchingEngine::rest(OrderBookSide& side, const Order& order) {
+    if (order.quantity > RestingOrder::MAX_QUANTITY) {
+        bump(counters_.rejected_orders);
+        return false;
     }
+    RestingOrder* node = order_pool_.acquire(order);
+    side.add_order(node);
+    order_lookup_.assign(order.order_id, node);
+    return true;
 }
 
-void MatchingEngine::match_order_against_side(std::shared_ptr<Order> incoming_order, OrderBookSide& opposite_side) {
-    while (incoming_order->quantity > 0 && !opposite_side.is_empty()) {
-        auto resting_order = opposite_side.get_best_order();
-        if (!resting_order) break;
-        bool can_match = false;
-        if (incoming_order->type == OrderType::MARKET) {
-            can_match = true;
-        } else {
-            if (incoming_order->side == OrderSide::BUY) {
-                can_match = (incoming_order->price >= resting_order->price);
+// Fills `incoming` level by level while the best opposite price crosses
+// `limit`. The price test runs once per level, not once per resting order;
+// the self-trade test is one compare of the hot node's owner per order.
+template <OrderSide S>
+Quantity MatchingEngine::match(Order& incoming, Price limit) {
+    OrderBookSide& opposite = opposite_side<S>();
+    // The owner a resting order must have to be a self-match; -1 matches
+    // nothing, so unattributed orders and NONE skip every branch below.
+    const int self = config_.self_trade != SelfTradePrevention::NONE && incoming.participant != 0
+                         ? incoming.participant : -1;
+    Quantity traded = 0;
+    while (incoming.quantity > 0) {
+        OrderBookLevel* level = opposite.get_best_level();
+        if (!level || !opposite.crosses(limit, level->get_price())) break;
+        Price trade_price = level->get_price();
+        bool level_done = false;
+        while (incoming.quantity > 0 && !level_done) {
+            RestingOrder* resting = level->get_front_order();
+            Quantity trade_quantity = std::min<Quantity>(incoming.quantity, resting->quantity);
+            if (resting->participant == self) {
+                bump(counters_.self_trades_prevented);
+                if (config_.self_trade == SelfTradePrevention::CANCEL_NEWEST) {
+                    incoming.quantity = 0;
+                    return traded;
+                }
+                // CANCEL_OLDEST removes the whole resting order; DECREMENT
+                // takes the overlap off both.
+                if (config_.self_trade == SelfTradePrevention::CANCEL_OLDEST) {
+                    trade_quantity = resting->quantity;
+                } else {
+                    incoming.quantity -= trade_quantity;
+                }
             } else {
-                can_match = (incoming_order->price <= resting_order->price);
+                bool buy = S == OrderSide::BUY;
+                TradeEvent trade(incoming.symbol, buy ? incoming.order_id : resting->order_id,
+                                 buy ? resting->order_id : incoming.order_id, trade_price, trade_quantity, match_time_);
+                trade.buy_participant = buy ? incoming.participant : resting->participant;
+                trade.sell_participant = buy ? resting->participant : incoming.participant;
+                trade.aggressor = S;
+                publish_trade(trade);
+                bump(counters_.matched_trades);
+                incoming.quantity -= trade_quantity;
+                traded += trade_quantity;
+            }
+            opposite.reduce_order(level, resting, trade_quantity);
+            if (resting->quantity == 0) {
+                // Removing the last order releases the level.
+                level_done = resting->next == nullptr;
+                opposite.remove_best_order();
+                order_lookup_.erase(resting->order_id);
+                order_pool_.release(resting);
             }
-        }
-        if (!can_match) break;
-        Price trade_price = resting_order->price;
-        Quantity trade_quantity = std::min(incoming_order->quantity, resting_order->quantity);
-        OrderId buy_id = (incoming_order->side == OrderSide::BUY) ? 
-                       incoming_order->order_id : resting_order->order_id;
-        OrderId sell_id = (incoming_order->side == OrderSide::SELL) ? 
-                        incoming_order->order_id : resting_order->order_id;
-        trade_events_.emplace_back(buy_id, sell_id, trade_price, trade_quantity);
-        matched_trades_++;
-        incoming_order->quantity -= trade_quantity;
-        resting_order->quantity -= trade_quantity;
-        if (resting_order->quantity == 0) {
-            opposite_side.remove_best_order();
-            order_lookup_.erase(resting_order->order_id);
         }
     }
-} 
\ No newline at end of file
+    return traded;
+}
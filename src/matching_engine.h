@@ -1,29 +1,295 @@
 #pragma once
 #include "order_book.h"
+#include "order_pool.h"
+#include "order_lookup.h"
+#include "lockfree_ring.h"
+#include "wait_strategy.h"
+#include "seqlock.h"
+#include "latency_histogram.h"
+#include "book_delta.h"
+#include "broadcast_ring.h"
+#include "journal.h"
+#include "snapshot.h"
+#include "trace.h"
+#include "span.h"
+#include <functional>
+#include <string>
 #include <vector>
 #include <mutex>
 #include <atomic>
+#include <thread>
+
+// What happens when an order would trade against a resting order of the
+// same (non-zero) participant. Checked per resting order in the match loop.
+enum class SelfTradePrevention : uint8_t {
+    NONE,           // Own orders trade with each other
+    CANCEL_NEWEST,  // Cancel the incoming order's remainder; the resting order keeps its place
+    CANCEL_OLDEST,  // Cancel the resting order and keep matching
+    DECREMENT,      // Shrink both by the smaller size without trading; whichever reaches zero is cancelled
+};
+
+inline const char* self_trade_prevention_name(SelfTradePrevention mode) {
+    switch (mode) {
+    case SelfTradePrevention::NONE: return "none";
+    case SelfTradePrevention::CANCEL_NEWEST: return "cancel-newest";
+    case SelfTradePrevention::CANCEL_OLDEST: return "cancel-oldest";
+    case SelfTradePrevention::DECREMENT: return "decrement";
+    }
+    return "unknown";
+}
+
+inline bool parse_self_trade_prevention(const std::string& name, SelfTradePrevention& mode) {
+    for (SelfTradePrevention candidate : {SelfTradePrevention::NONE, SelfTradePrevention::CANCEL_NEWEST,
+                                          SelfTradePrevention::CANCEL_OLDEST, SelfTradePrevention::DECREMENT}) {
+        if (name == self_trade_prevention_name(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Per-instrument book configuration.
+struct EngineConfig {
+    SymbolId symbol = 0;                                  // Instrument this book serves (stamped on deltas)
+    size_t order_capacity = OrderPool::DEFAULT_CAPACITY;  // Preallocated resting orders
+    size_t ladder_levels = 0;                             // Dense price ladder size in ticks (0 = map only)
+    size_t ingress_capacity = 1 << 16;                    // Command ring size in single-writer mode
+    size_t trade_tail_capacity = 1024;                    // Recent trades kept for get_trade_events (0 = none)
+    bool publish_depth = true;                            // Maintain the lock-free L2 view (get_l2)
+    WaitMode wait = WaitMode::SPIN_YIELD;                 // Matcher thread's idle policy in single-writer mode
+    SelfTradePrevention self_trade = SelfTradePrevention::NONE;  // Orders meeting their owner's resting orders
+};
+
+struct TopOfBook {
+    Price best_bid;
+    Price best_ask;
+};
+
+// Top levels of both sides, republished whenever a change lands inside
+// the levels last published.
+struct BookDepth {
+    static constexpr size_t LEVELS = 10;
+    DepthLevel bids[LEVELS];
+    DepthLevel asks[LEVELS];
+    uint32_t bid_levels;
+    uint32_t ask_levels;
+};
+
+struct EngineCommand {
+    enum class Kind : uint8_t { ADD = 0, CANCEL = 1, MODIFY = 2 };
+    Kind kind = Kind::ADD;
+    Order order;  // MODIFY: order_id plus the new price and quantity
+    TraceContext* trace = nullptr;  // Sampled commands: stamped around matching, then finished
+};
+
+using TradeRing = SpscRing<TradeEvent>;
+using TradeCallback = std::function<void(const TradeEvent&)>;
+using OrderCallback = std::function<void(const Order&)>;
 
 class MatchingEngine {
 public:
     MatchingEngine();
-    void add_order(std::shared_ptr<Order> order);
+    explicit MatchingEngine(const EngineConfig& config);
+    ~MatchingEngine();
+    void add_order(const Order& order);
+    void add_order(const std::shared_ptr<Order>& order) { add_order(*order); }
     bool cancel_order(OrderId order_id);
+    // Amends a resting order in place. A pure size reduction keeps queue
+    // priority; a size increase or a new price sends the order to the back
+    // of its (new) level, matching first if the new price crosses. The pool
+    // node is reused throughout. Zero quantity cancels. Returns false if the
+    // order is not resting, if the new quantity exceeds
+    // RestingOrder::MAX_QUANTITY, or if a POST_ONLY order's new price would
+    // cross (both counted as rejected; the order rests unchanged).
+    bool modify_order(OrderId order_id, Price new_price, Quantity new_quantity);
+    // Applies one command with the same locking as the direct calls.
+    void execute(const EngineCommand& command);
+    // Applies a run of commands under one lock acquisition; the adds share
+    // one timing sample (see submit_batch).
+    void execute(Span<EngineCommand> commands);
+    // Adds a batch of orders under one lock acquisition and one pair of
+    // clock reads: every trade in the batch carries the same timestamp, and
+    // the batch is one match-latency sample of its per-order average. Up to
+    // `max_fills` trades are copied into `fills` (callbacks and rings still
+    // see all of them); returns how many were copied. With the matcher
+    // thread running, the batch is instead published to its ring in one
+    // claim and fills arrive only through the callback and rings.
+    size_t submit_batch(Span<Order> orders, TradeEvent* fills = nullptr, size_t max_fills = 0);
+
+    // Trade output. Callbacks run inline on the matching thread; rings are
+    // drained by their consumer and drop (and count) trades when full.
+    // get_trade_events() returns only the bounded tail of recent trades.
+    void set_trade_callback(TradeCallback callback);
+    // Execution reports for one participant: `callback` runs, after the
+    // global callback, only for trades where `participant` bought or sold.
+    // Callbacks sit in a table indexed by participant, so routing a fill is
+    // an array read rather than a lookup or a filter over every trade.
+    void set_participant_callback(ParticipantId participant, TradeCallback callback);
+    // The other half of a participant's execution reports: `callback` runs
+    // once for each of its new orders that leaves quantity which neither
+    // traded nor rests (IOC and market remainders, rejections, self-trade
+    // cancels), with that quantity in `quantity`. Same thread as the fills.
+    void set_unfilled_callback(ParticipantId participant, OrderCallback callback);
+    std::shared_ptr<TradeRing> subscribe_trades(size_t capacity);
     std::vector<TradeEvent> get_trade_events() const;
+    uint64_t get_dropped_trades() const { return counters_.dropped_trades.load(std::memory_order_relaxed); }
+
     uint64_t get_processed_orders() const;
     uint64_t get_matched_trades() const;
+    // Post-only orders that would have crossed, FOK orders that could not
+    // fill, and limit orders too large to rest (RestingOrder::MAX_QUANTITY).
+    // A FOK's liquidity check counts its owner's resting orders, so under
+    // self-trade prevention it can still end short.
+    uint64_t get_rejected_orders() const { return counters_.rejected_orders.load(std::memory_order_relaxed); }
+    // Resting orders a self-trade check cancelled or decremented instead of trading.
+    uint64_t get_self_trades_prevented() const {
+        return counters_.self_trades_prevented.load(std::memory_order_relaxed);
+    }
     double get_average_processing_time_ns() const;
+    // Per-order match time, recorded on whichever thread runs the book.
+    const LatencyHistogram& get_match_latency() const { return match_latency_; }
     std::pair<Price, Price> get_best_bid_ask() const;
+    // Copies up to `n` levels of one side, best first, into `out` under the
+    // book lock; no allocation. Returns the number written.
+    size_t get_depth(OrderSide side, DepthLevel* out, size_t n) const;
+    // Lock-free read of the incrementally maintained top-of-book depth.
+    BookDepth get_l2() const { return depth_.load(); }
+
+    // Publishes BookDelta events (level add/change/delete and trades) into
+    // a shared-memory broadcast ring named `name`, which any number of
+    // BroadcastReader<BookDelta> instances can map. Each command emits at
+    // most one event per level it touched, after it completes.
+    bool open_delta_ring(const std::string& name, size_t capacity);
+    uint64_t get_published_deltas() const { return delta_sequence_.load(std::memory_order_relaxed); }
+    const std::string& get_delta_error() const { return delta_error_; }
+
+    // Journals every inbound add, cancel and modify to `path` before it is
+    // applied (see Journal). Replay an existing journal with replay_journal
+    // first to recover the book; appending then continues its sequence.
+    bool open_journal(const std::string& path, const JournalConfig& config = JournalConfig());
+    const Journal* get_journal() const { return journal_.get(); }
+    const std::string& get_journal_error() const { return journal_error_; }
+
+    // Point-in-time snapshot of every resting order, in queue order, plus
+    // the last journal sequence it covers. The capture runs on whichever
+    // thread applies the next command, right after it, and only copies the
+    // resting orders into a reused buffer; a background thread writes the
+    // file once the journal is on disk through that sequence. An idle
+    // engine is captured by that thread after a short wait.
+    // Returns false while the previous snapshot is still being written.
+    // Safe to call from several threads at once.
+    bool request_snapshot(const std::string& path);
+    bool save_snapshot(const std::string& path);  // Requests and waits for the write
+    // Loads a snapshot into an empty engine, before start() and before
+    // replaying the journal after `restored.journal_sequence`. Trades are
+    // not re-reported.
+    bool restore_snapshot(const std::string& path, SnapshotHeader& restored);
+    uint64_t get_snapshots_written() const { return snapshots_written_.load(std::memory_order_relaxed); }
+    std::string get_snapshot_error() const;
+
+    // Single-writer mode: a dedicated (optionally pinned) matcher thread owns
+    // the book and drains commands that any thread submits through a
+    // lock-free ring. Direct add_order/cancel_order calls stay valid.
+    // start() and stop() are called by the owner, not by producers. Stop
+    // every producer before stop(): a submit that saw is_running() just
+    // before the matcher's final drain could otherwise leave its command in
+    // the ring unprocessed.
+    void start(int cpu = -1);
+    void stop();
+    bool is_running() const { return matcher_running_.load(std::memory_order_acquire); }
+    void submit_order(const Order& order, TraceContext* trace = nullptr);
+    void submit_cancel(OrderId order_id);
+    void submit_modify(OrderId order_id, Price new_price, Quantity new_quantity);
 private:
+    EngineConfig config_;
+    OrderPool order_pool_;
     OrderBookSide bid_side_;
     OrderBookSide ask_side_;
-    std::unordered_map<OrderId, std::pair<Price, OrderSide>> order_lookup_;
-    std::vector<TradeEvent> trade_events_;
+    OrderLookup order_lookup_;
+    TradeCallback trade_callback_;
+    std::vector<TradeCallback> participant_callbacks_;  // Empty, or one slot per ParticipantId
+    std::vector<OrderCallback> unfilled_callbacks_;     // Likewise
+    std::vector<std::shared_ptr<TradeRing>> trade_subscribers_;
+    std::vector<TradeEvent> trade_tail_;
+    size_t trade_tail_next_ = 0;
+    TradeEvent* fill_out_ = nullptr;  // submit_batch's caller buffer while it runs
+    size_t fill_capacity_ = 0;
+    size_t fill_count_ = 0;
     mutable std::mutex engine_mutex_;
-    std::atomic<uint64_t> processed_orders_{0};
-    std::atomic<uint64_t> matched_trades_{0};
-    std::atomic<uint64_t> total_processing_time_ns_{0};
-    void process_market_order(std::shared_ptr<Order> order);
-    void process_limit_order(std::shared_ptr<Order> order);
-    void match_order_against_side(std::shared_ptr<Order> incoming_order, OrderBookSide& opposite_side);
-}; 
\ No newline at end of file
+    // Written only by whichever thread is applying commands (the matcher,
+    // or a direct caller holding engine_mutex_), so updates are plain
+    // relaxed stores; a line of their own keeps readers polling them off
+    // the lock and the book state.
+    struct alignas(CACHE_LINE_SIZE) Counters {
+        std::atomic<uint64_t> processed_orders{0};
+        std::atomic<uint64_t> matched_trades{0};
+        std::atomic<uint64_t> rejected_orders{0};
+        std::atomic<uint64_t> dropped_trades{0};
+        std::atomic<uint64_t> self_trades_prevented{0};
+        std::atomic<uint64_t> total_processing_ticks{0};
+    };
+    Counters counters_;
+    LatencyHistogram match_latency_;
+    Timestamp match_time_ = 0;
+    SeqLock<TopOfBook> top_of_book_;
+    SeqLock<BookDepth> depth_;
+    BookDepth depth_scratch_{};
+    std::unique_ptr<BroadcastWriter<BookDelta>> deltas_;
+    std::atomic<uint64_t> delta_sequence_{0};
+    std::string delta_error_;
+    std::unique_ptr<Journal> journal_;
+    std::string journal_error_;
+    std::vector<SnapshotOrder> snapshot_orders_;
+    SnapshotHeader snapshot_header_;
+    std::string snapshot_path_;
+    std::atomic<bool> snapshot_requested_{false};
+    std::atomic<bool> snapshot_busy_{false};
+    std::mutex snapshot_thread_mutex_;  // Callers of request_snapshot/save_snapshot join and replace the thread
+    std::thread snapshot_thread_;
+    std::atomic<uint64_t> snapshots_written_{0};
+    mutable std::mutex snapshot_error_mutex_;
+    std::string snapshot_error_;
+
+    std::unique_ptr<MpscRing<EngineCommand>> ingress_;
+    std::thread matcher_thread_;
+    std::atomic<bool> matcher_running_{false};
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    void process_order(const Order& order);
+    void match_order(const Order& order);
+    bool process_cancel(OrderId order_id);
+    bool process_modify(OrderId order_id, Price new_price, Quantity new_quantity);
+    // `timed` = false leaves an add's clock reads and counters to the
+    // enclosing batch.
+    void process_command(const EngineCommand& command, bool timed = true);
+    void process_batch(Span<EngineCommand> commands);
+    void journal(MarketRecord::Kind kind, const Order& order);
+    void poll_snapshot() {
+        if (snapshot_requested_.load(std::memory_order_acquire)) capture_snapshot();
+    }
+    void capture_snapshot();
+    void write_snapshot();
+    void publish_top_of_book();
+    void publish_trade(const TradeEvent& trade);
+    void report_unfilled(const Order& order, Quantity unfilled);
+    void publish_deltas();
+    void publish_levels(OrderBookSide& side, OrderSide which);
+    void emit_delta(BookDelta& delta);
+    void matcher_loop(int cpu);
+    // Side-specialised so the fill loop carries no side or type branches;
+    // the order type is resolved once in process_side.
+    template <OrderSide S>
+    void process_side(Order& order);
+    // Returns the quantity traded, which self-trade prevention can leave
+    // short of what came off `incoming`.
+    template <OrderSide S>
+    Quantity match(Order& incoming, Price limit);
+    template <OrderSide S>
+    OrderBookSide& own_side() { return S == OrderSide::BUY ? bid_side_ : ask_side_; }
+    template <OrderSide S>
+    OrderBookSide& opposite_side() { return S == OrderSide::BUY ? ask_side_ : bid_side_; }
+    bool rest(OrderBookSide& side, const Order& order);
+};
@@ -0,0 +1,46 @@
+#include "mean_reversion_strategy.h"
+#include <algorithm>
+#include <cmath>
+
+MeanReversionStrategy::MeanReversionStrategy() : MeanReversionStrategy(StrategyConfig()) {}
+
+MeanReversionStrategy::MeanReversionStrategy(const StrategyConfig& config) : StrategyBase(config) {}
+
+MeanReversionStrategy::MeanReversionStrategy(IndicatorBank& bank, const StrategyConfig& config)
+    : StrategyBase(bank, config) {}
+
+Signal MeanReversionStrategy::evaluate(const IndicatorSnapshot& ind) const {
+    Signal signal;
+    signal.type = SignalType::HOLD;
+    signal.price = ind.price;
+    signal.quantity = config.position_size;
+    signal.confidence = 0.0;
+
+    if (check_exit(ind, signal)) return signal;
+    if (ind.long_sma <= 0.0) return signal;
+
+    double deviation_pct = ((ind.price - ind.long_sma) / ind.long_sma) * 100.0;
+    if (!in_position) {
+        // BUY: stretched below the mean and oversold
+        if (deviation_pct <= -config.reversion_threshold_pct && ind.rsi < config.rsi_oversold) {
+            signal.type = SignalType::BUY;
+        }
+    } else {
+        // SELL: back at the mean, or the bounce has overshot
+        if (deviation_pct >= 0.0 || ind.rsi > config.rsi_overbought) {
+            signal.type = SignalType::SELL;
+        }
+    }
+
+    if (signal.type != SignalType::HOLD) {
+        // Full confidence at twice the entry stretch
+        signal.confidence = config.reversion_threshold_pct > 0.0
+            ? std::min(std::abs(deviation_pct) / (2.0 * config.reversion_threshold_pct), 1.0) : 1.0;
+        signal.reason.kind = SignalReason::Kind::REVERSION;
+        signal.reason.rsi = ind.rsi;
+        signal.reason.long_sma = ind.long_sma;
+        signal.reason.short_sma = ind.short_sma;
+        signal.reason.deviation_pct = deviation_pct;
+    }
+    return signal;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "strategy.h"
+
+// Mean reversion: buy when price has stretched reversion_threshold_pct
+// below the long MA with RSI oversold, sell once it is back at the MA or
+// RSI turns overbought. Shares StrategyCore's stop loss / take profit.
+class MeanReversionStrategy : public StrategyBase<MeanReversionStrategy> {
+public:
+    MeanReversionStrategy();
+    explicit MeanReversionStrategy(const StrategyConfig& config);
+    MeanReversionStrategy(IndicatorBank& bank, const StrategyConfig& config);
+
+    Signal evaluate(const IndicatorSnapshot& ind) const;
+};
@@ -0,0 +1,139 @@
+#include "metrics.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <vector>
+
+namespace {
+
+size_t region_size(size_t capacity) {
+    return sizeof(MetricsPageHeader) + capacity * sizeof(MetricSlot);
+}
+
+// Splits `series` into its family name and label list (without braces).
+void split_series(const char* series, std::string& family, std::string& labels) {
+    const char* brace = std::strchr(series, '{');
+    if (!brace) {
+        family = series;
+        labels.clear();
+        return;
+    }
+    family.assign(series, brace);
+    labels.assign(brace + 1);
+    if (!labels.empty() && labels.back() == '}') labels.pop_back();
+}
+
+void write_sample(std::ostream& out, const std::string& family, const char* suffix, const std::string& labels,
+                  const char* quantile, double value) {
+    out << family << suffix;
+    if (!labels.empty() || quantile) {
+        out << '{' << labels;
+        if (quantile) out << (labels.empty() ? "" : ",") << "quantile=\"" << quantile << '"';
+        out << '}';
+    }
+    out << ' ' << value << '\n';
+}
+
+}  // namespace
+
+const char* metric_kind_name(MetricKind kind) {
+    switch (kind) {
+    case MetricKind::COUNTER: return "counter";
+    case MetricKind::GAUGE: return "gauge";
+    case MetricKind::HISTOGRAM: return "summary";
+    }
+    return "untyped";
+}
+
+bool MetricsPage::create(const std::string& name, size_t capacity) {
+    if (!memory_.create(name, region_size(capacity))) {
+        error_ = memory_.error();
+        return false;
+    }
+    header_ = new (memory_.data()) MetricsPageHeader{MetricsPageHeader::MAGIC, MetricsPageHeader::VERSION,
+                                                     sizeof(MetricSlot), static_cast<uint32_t>(capacity), {0}};
+    slots_ = reinterpret_cast<MetricSlot*>(static_cast<unsigned char*>(memory_.data()) + sizeof(MetricsPageHeader));
+    return true;
+}
+
+Metric MetricsPage::add(const std::string& series, MetricKind kind) {
+    if (!header_) return Metric();
+    uint32_t index = header_->count.load(std::memory_order_relaxed);
+    if (index == header_->capacity) {
+        error_ = "metrics page is full; dropped " + series;
+        return Metric();
+    }
+    MetricSlot* slot = new (&slots_[index]) MetricSlot;
+    size_t length = std::min(series.size(), MetricSlot::NAME_SIZE - 1);
+    std::memcpy(slot->name, series.data(), length);
+    slot->name[length] = '\0';
+    slot->kind = kind;
+    // Publishes the name and kind to readers before they can see the slot.
+    header_->count.store(index + 1, std::memory_order_release);
+    return Metric(slot);
+}
+
+bool MetricsReader::open(const std::string& name) {
+    if (!memory_.open(name)) {
+        error_ = memory_.error();
+        return false;
+    }
+    header_ = static_cast<const MetricsPageHeader*>(memory_.data());
+    if (memory_.size() < sizeof(MetricsPageHeader) || header_->magic != MetricsPageHeader::MAGIC ||
+        header_->version != MetricsPageHeader::VERSION || header_->slot_size != sizeof(MetricSlot) ||
+        memory_.size() < region_size(header_->capacity)) {
+        memory_.close();
+        header_ = nullptr;
+        error_ = name + " is not a compatible metrics page";
+        return false;
+    }
+    slots_ = reinterpret_cast<const MetricSlot*>(static_cast<const unsigned char*>(memory_.data()) +
+                                                 sizeof(MetricsPageHeader));
+    return true;
+}
+
+void MetricsReader::close() {
+    memory_.close();
+    header_ = nullptr;
+    slots_ = nullptr;
+}
+
+void MetricsReader::write_prometheus(std::ostream& out) const {
+    // The format wants each family's samples together under one TYPE line.
+    size_t count = size();
+    std::vector<std::string> families(count);
+    std::vector<std::string> labels(count);
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; ++i) {
+        split_series(name(i), families[i], labels[i]);
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return families[a] < families[b]; });
+    // Enough digits that counters print as exact integers.
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision(15);
+    out.unsetf(std::ios::floatfield);
+
+    const std::string* previous = nullptr;
+    for (size_t i : order) {
+        const std::string& family = families[i];
+        if (!previous || *previous != family) {
+            out << "# TYPE " << family << ' ' << metric_kind_name(kind(i)) << '\n';
+            previous = &family;
+        }
+        MetricValue sample = value(i);
+        if (kind(i) != MetricKind::HISTOGRAM) {
+            write_sample(out, family, "", labels[i], nullptr, sample.value);
+            continue;
+        }
+        const LatencyStats& latency = sample.latency;
+        write_sample(out, family, "", labels[i], "0.5", latency.p50_ns * 1e-9);
+        write_sample(out, family, "", labels[i], "0.99", latency.p99_ns * 1e-9);
+        write_sample(out, family, "", labels[i], "0.999", latency.p999_ns * 1e-9);
+        write_sample(out, family, "", labels[i], "1", latency.max_ns * 1e-9);
+        write_sample(out, family, "_sum", labels[i], nullptr, latency.mean_ns * latency.count * 1e-9);
+        write_sample(out, family, "_count", labels[i], nullptr, static_cast<double>(latency.count));
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
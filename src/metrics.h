@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "latency_histogram.h"
+#include "seqlock.h"
+#include "shared_memory.h"
+
+constexpr const char* DEFAULT_METRICS_PAGE = "/nanoex.metrics";
+
+enum class MetricKind : uint32_t { COUNTER, GAUGE, HISTOGRAM };
+
+// Prometheus TYPE name; histograms are exported as summaries of their
+// quantiles.
+const char* metric_kind_name(MetricKind kind);
+
+struct MetricValue {
+    double value = 0.0;    // Counters and gauges; a histogram's sample count
+    LatencyStats latency;  // Histograms only
+};
+
+// One series: registered once, then rewritten in place by a single writer
+// thread. Readers copy the value through the seqlock and never block it.
+struct MetricSlot {
+    static constexpr size_t NAME_SIZE = 96;
+
+    char name[NAME_SIZE];  // Prometheus series, e.g. nanoex_shard_orders_total{shard="0"}
+    MetricKind kind;
+    SeqLock<MetricValue> value;
+};
+
+// Layout at the start of a metrics page's shared-memory region. Slots
+// follow at offset sizeof(MetricsPageHeader).
+struct MetricsPageHeader {
+    static constexpr uint32_t MAGIC = 0x544d584e;  // "NXMT"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_size;
+    uint32_t capacity;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> count;  // Slots registered so far
+};
+
+// A registered series. Every Metric has exactly one writer thread, so
+// set() is a seqlock store with no read-modify-write; a default Metric (or
+// one from a page that is not open) ignores it.
+class Metric {
+public:
+    Metric() = default;
+    explicit Metric(MetricSlot* slot) : slot_(slot) {}
+
+    void set(double value) {
+        if (slot_) slot_->value.store(MetricValue{value, LatencyStats()});
+    }
+    void set(const LatencyStats& stats) {
+        if (slot_) slot_->value.store(MetricValue{static_cast<double>(stats.count), stats});
+    }
+private:
+    MetricSlot* slot_ = nullptr;
+};
+
+// Shared-memory page of metric slots that scrapers (nanoex_metrics) read
+// at whatever rate they like. Series are registered up front from one
+// thread; after that each is written only by its owner and readers take
+// no lock anywhere, so scraping cannot contend with the publishers.
+class MetricsPage {
+public:
+    bool create(const std::string& name = DEFAULT_METRICS_PAGE, size_t capacity = 512);
+    bool is_open() const { return header_ != nullptr; }
+    const std::string& error() const { return error_; }
+
+    // Registers `series` (truncated to fit). Returns a no-op Metric once the
+    // page is full or if it is not open.
+    Metric add(const std::string& series, MetricKind kind);
+    size_t size() const { return header_ ? header_->count.load(std::memory_order_relaxed) : 0; }
+private:
+    SharedMemory memory_;
+    MetricsPageHeader* header_ = nullptr;
+    MetricSlot* slots_ = nullptr;
+    std::string error_;
+};
+
+// Read-only view of another process's metrics page.
+class MetricsReader {
+public:
+    bool open(const std::string& name = DEFAULT_METRICS_PAGE);
+    void close();
+    bool is_open() const { return header_ != nullptr; }
+    const std::string& error() const { return error_; }
+
+    size_t size() const { return header_ ? header_->count.load(std::memory_order_acquire) : 0; }
+    const char* name(size_t i) const { return slots_[i].name; }
+    MetricKind kind(size_t i) const { return slots_[i].kind; }
+    MetricValue value(size_t i) const { return slots_[i].value.load(); }
+
+    // Prometheus text exposition of every series; histogram latencies are
+    // converted to seconds.
+    void write_prometheus(std::ostream& out) const;
+private:
+    SharedMemory memory_;
+    const MetricsPageHeader* header_ = nullptr;
+    const MetricSlot* slots_ = nullptr;
+    std::string error_;
+};
@@ -1,109 +1,334 @@
 #include "order_book.h"
+#include "tsc_clock.h"
 #include <algorithm>
 
-Order::Order(OrderId id, OrderSide s, Price p, Quantity q, OrderType t)
-    : order_id(id), timestamp(std::chrono::steady_clock::now()),
-      side(s), price(p), quantity(q), type(t) {}
+Order::Order(OrderId id, OrderSide s, Price p, Quantity q, OrderType t, SymbolId sym)
+    : order_id(id), price(p), quantity(q), timestamp(TscClock::now()), symbol(sym), side(s), type(t), participant(0) {}
 
-TradeEvent::TradeEvent(OrderId buy_id, OrderId sell_id, Price p, Quantity q)
-    : buy_order_id(buy_id), sell_order_id(sell_id), price(p), quantity(q),
-      timestamp(std::chrono::steady_clock::now()) {}
+TradeEvent::TradeEvent(SymbolId sym, OrderId buy_id, OrderId sell_id, Price p, Quantity q)
+    : TradeEvent(sym, buy_id, sell_id, p, q, TscClock::now()) {}
 
-OrderBookLevel::OrderBookLevel(Price price) : price_(price), total_quantity_(0) {}
+TradeEvent::TradeEvent(SymbolId sym, OrderId buy_id, OrderId sell_id, Price p, Quantity q, Timestamp ts)
+    : buy_order_id(buy_id), sell_order_id(sell_id), price(p), quantity(q), timestamp(ts), symbol(sym),
+      buy_participant(0), sell_participant(0), aggressor(OrderSide::BUY) {}
 
-void OrderBookLevel::add_order(std::shared_ptr<Order> order) {
-    orders_.push(order);
-    total_quantity_ += order->quantity;
+OrderBookLevel::OrderBookLevel(Price price)
+    : price_(price), head_(nullptr), tail_(nullptr), total_quantity_(0), order_count_(0) {}
+
+void OrderBookLevel::reset(Price price) {
+    price_ = price;
+    head_ = nullptr;
+    tail_ = nullptr;
+    total_quantity_ = 0;
+    order_count_ = 0;
 }
 
-std::shared_ptr<Order> OrderBookLevel::get_front_order() {
-    return orders_.empty() ? nullptr : orders_.front();
+void OrderBookLevel::splice_from(OrderBookLevel& other) {
+    for (RestingOrder* order = other.head_; order; order = order->next) {
+        order->info().level = this;
+    }
+    if (!other.head_) return;
+    if (tail_) {
+        tail_->next = other.head_;
+        other.head_->prev = tail_;
+    } else {
+        head_ = other.head_;
+    }
+    tail_ = other.tail_;
+    total_quantity_ += other.total_quantity_;
+    order_count_ += other.order_count_;
+    other.head_ = nullptr;
+    other.tail_ = nullptr;
+    other.total_quantity_ = 0;
+    other.order_count_ = 0;
 }
 
-void OrderBookLevel::remove_front_order() {
-    if (!orders_.empty()) {
-        total_quantity_ -= orders_.front()->quantity;
-        orders_.pop();
+void OrderBookLevel::add_order(RestingOrder* order) {
+    order->prev = tail_;
+    order->next = nullptr;
+    order->info().level = this;
+    if (tail_) {
+        tail_->next = order;
+    } else {
+        head_ = order;
     }
+    tail_ = order;
+    total_quantity_ += order->quantity;
+    ++order_count_;
 }
 
-bool OrderBookLevel::remove_order(OrderId order_id) {
-    std::queue<std::shared_ptr<Order>> temp_queue;
-    bool found = false;
-    while (!orders_.empty()) {
-        auto order = orders_.front();
-        orders_.pop();
-        if (order->order_id == order_id) {
-            total_quantity_ -= order->quantity;
-            found = true;
-        } else {
-            temp_queue.push(order);
-        }
+RestingOrder* OrderBookLevel::get_front_order() {
+    return head_;
+}
+
+RestingOrder* OrderBookLevel::remove_front_order() {
+    RestingOrder* order = head_;
+    if (order) remove_order(order);
+    return order;
+}
+
+// Leaves the cold half's level pointer stale; it is rewritten on the
+// next add_order.
+void OrderBookLevel::remove_order(RestingOrder* order) {
+    if (order->prev) {
+        order->prev->next = order->next;
+    } else {
+        head_ = order->next;
     }
-    orders_ = std::move(temp_queue);
-    return found;
+    if (order->next) {
+        order->next->prev = order->prev;
+    } else {
+        tail_ = order->prev;
+    }
+    total_quantity_ -= order->quantity;
+    --order_count_;
+    order->prev = nullptr;
+    order->next = nullptr;
+}
+
+void OrderBookLevel::reduce_order(RestingOrder* order, Quantity amount) {
+    order->quantity -= amount;
+    total_quantity_ -= amount;
 }
 
 Price OrderBookLevel::get_price() const { return price_; }
 Quantity OrderBookLevel::get_total_quantity() const { return total_quantity_; }
-bool OrderBookLevel::is_empty() const { return orders_.empty(); }
+bool OrderBookLevel::is_empty() const { return head_ == nullptr; }
 
-OrderBookSide::OrderBookSide(bool is_bid) : is_bid_side_(is_bid) {}
+OrderBookSide::OrderBookSide(bool is_bid, size_t ladder_levels) : is_bid_side_(is_bid) {
+    if (ladder_levels == 0) return;
+    // Round up to a power of two of at least one bitmap word.
+    size_t size = 64;
+    while (size < ladder_levels) size <<= 1;
+    ladder_.resize(size);
+    ladder_bits_.assign(size / 64, 0);
+    ladder_mask_ = size - 1;
+}
+
+void OrderBookSide::add_order(RestingOrder* order) {
+    Price price = order->info().price;
+    OrderBookLevel* level = level_for(price);
+    bool created = level->is_empty();
+    level->add_order(order);
+    touch(price, created);
+}
+
+RestingOrder* OrderBookSide::get_best_order() {
+    OrderBookLevel* level = best_level();
+    return level ? level->get_front_order() : nullptr;
+}
+
+RestingOrder* OrderBookSide::remove_best_order() {
+    OrderBookLevel* level = best_level();
+    if (!level) return nullptr;
+    RestingOrder* order = level->remove_front_order();
+    touch(level->get_price());
+    if (level->is_empty()) release_level(level);
+    return order;
+}
+
+void OrderBookSide::remove_order(RestingOrder* order) {
+    OrderBookLevel* level = order->info().level;
+    level->remove_order(order);
+    touch(level->get_price());
+    if (level->is_empty()) release_level(level);
+}
 
-void OrderBookSide::add_order(std::shared_ptr<Order> order) {
-    Price price = order->price;
-    if (levels_.find(price) == levels_.end()) {
-        levels_[price] = std::make_unique<OrderBookLevel>(price);
+void OrderBookSide::reduce_order(RestingOrder* order, Quantity amount) {
+    reduce_order(order->info().level, order, amount);
+}
+
+Price OrderBookSide::get_best_price() const {
+    Price best = 0;
+    bool found = false;
+    if (ladder_count_ > 0) {
+        best = ladder_best_;
+        found = true;
     }
-    levels_[price]->add_order(order);
+    if (!levels_.empty()) {
+        Price map_best = is_bid_side_ ? levels_.rbegin()->first : levels_.begin()->first;
+        if (!found || better(map_best, best)) best = map_best;
+    }
+    return best;
 }
 
-std::shared_ptr<Order> OrderBookSide::get_best_order() {
-    if (levels_.empty()) return nullptr;
-    if (is_bid_side_) {
-        auto rit = levels_.rbegin();
-        return rit->second->get_front_order();
-    } else {
-        auto it = levels_.begin();
-        return it->second->get_front_order();
+const OrderBookLevel* OrderBookSide::find_level(Price price) const {
+    if (in_window(price)) {
+        size_t slot = slot_of(price);
+        bool occupied = (ladder_bits_[slot >> 6] >> (slot & 63)) & 1;
+        return occupied ? &ladder_[slot] : nullptr;
+    }
+    auto it = levels_.find(price);
+    return it != levels_.end() ? it->second.get() : nullptr;
+}
+
+void OrderBookSide::note_change(Price price, bool created) {
+    for (const LevelChange& change : changes_) {
+        if (change.price == price) return;
     }
+    changes_.push_back(LevelChange{price, created});
 }
 
-void OrderBookSide::remove_best_order() {
-    if (levels_.empty()) return;
+Quantity OrderBookSide::available_through(Price limit, Quantity wanted) const {
+    Quantity total = 0;
+    if (ladder_count_ > 0) {
+        Price price = ladder_best_;
+        do {
+            if (!crosses(limit, price)) break;
+            total += ladder_[slot_of(price)].get_total_quantity();
+        } while (total < wanted && next_ladder_price(price));
+    }
     if (is_bid_side_) {
-        auto best_it = levels_.rbegin();
-        best_it->second->remove_front_order();
-        if (best_it->second->is_empty()) {
-            levels_.erase(std::next(best_it).base());
+        for (auto it = levels_.rbegin(); it != levels_.rend() && total < wanted && crosses(limit, it->first); ++it) {
+            total += it->second->get_total_quantity();
         }
     } else {
-        auto best_it = levels_.begin();
-        best_it->second->remove_front_order();
-        if (best_it->second->is_empty()) {
-            levels_.erase(best_it);
+        for (auto it = levels_.begin(); it != levels_.end() && total < wanted && crosses(limit, it->first); ++it) {
+            total += it->second->get_total_quantity();
         }
     }
+    return total;
 }
 
-bool OrderBookSide::remove_order(OrderId order_id, Price price) {
-    auto it = levels_.find(price);
-    if (it == levels_.end()) return false;
-    bool removed = it->second->remove_order(order_id);
-    if (removed && it->second->is_empty()) {
-        levels_.erase(it);
+size_t OrderBookSide::get_depth(DepthLevel* out, size_t n) const {
+    size_t count = 0;
+    if (n == 0) return 0;
+    for_each_level([&](const OrderBookLevel& level) {
+        out[count++] = DepthLevel{level.get_price(), level.get_total_quantity(), level.get_order_count()};
+        return count < n;
+    });
+    return count;
+}
+
+size_t OrderBookSide::publish_depth(DepthLevel* out, size_t n) {
+    size_t count = get_depth(out, n);
+    depth_full_ = count == n && n > 0;
+    depth_bound_ = count > 0 ? out[count - 1].price : 0;
+    depth_dirty_ = false;
+    return count;
+}
+
+bool OrderBookSide::is_empty() const { return ladder_count_ == 0 && levels_.empty(); }
+
+OrderBookLevel* OrderBookSide::best_level() {
+    OrderBookLevel* best = ladder_count_ > 0 ? &ladder_[slot_of(ladder_best_)] : nullptr;
+    if (!levels_.empty()) {
+        OrderBookLevel* map_best = is_bid_side_ ? levels_.rbegin()->second.get() : levels_.begin()->second.get();
+        if (!best || better(map_best->get_price(), best->get_price())) best = map_best;
     }
-    return removed;
+    return best;
 }
 
-Price OrderBookSide::get_best_price() const {
-    if (levels_.empty()) return 0;
+OrderBookLevel* OrderBookSide::level_for(Price price) {
+    if (!ladder_.empty() && (in_window(price) || move_window(price))) {
+        OrderBookLevel* level = &ladder_[slot_of(price)];
+        return level->is_empty() ? occupy_slot(price) : level;
+    }
+    auto& level = levels_[price];
+    if (!level) level = std::make_unique<OrderBookLevel>(price);
+    return level.get();
+}
+
+void OrderBookSide::release_level(OrderBookLevel* level) {
+    Price price = level->get_price();
+    if (!in_window(price)) {
+        levels_.erase(price);
+        return;
+    }
+    size_t slot = slot_of(price);
+    ladder_bits_[slot >> 6] &= ~(uint64_t{1} << (slot & 63));
+    if (--ladder_count_ == 0 || price != ladder_best_) return;
+    // The best level emptied: walk the bitmap away from the touch.
     if (is_bid_side_) {
-        auto best_it = levels_.rbegin();
-        return best_it->second->get_price();
+        ladder_best_ = price - scan_down(slot, static_cast<size_t>(price - ladder_base_) + 1);
     } else {
-        auto best_it = levels_.begin();
-        return best_it->second->get_price();
+        ladder_best_ = price + scan_up(slot, static_cast<size_t>(ladder_base_ + ladder_mask_ - price) + 1);
+    }
+}
+
+OrderBookLevel* OrderBookSide::occupy_slot(Price price) {
+    size_t slot = slot_of(price);
+    OrderBookLevel* level = &ladder_[slot];
+    level->reset(price);
+    ladder_bits_[slot >> 6] |= uint64_t{1} << (slot & 63);
+    if (ladder_count_++ == 0 || better(price, ladder_best_)) ladder_best_ = price;
+    return level;
+}
+
+// Steps `price` to the next occupied ladder level away from the touch.
+bool OrderBookSide::next_ladder_price(Price& price) const {
+    size_t step;
+    if (is_bid_side_) {
+        if (price == ladder_base_) return false;
+        step = scan_down(slot_of(price - 1), static_cast<size_t>(price - 1 - ladder_base_) + 1);
+        if (step == NPOS) return false;
+        price -= step + 1;
+    } else {
+        Price top = ladder_base_ + ladder_mask_;
+        if (price == top) return false;
+        step = scan_up(slot_of(price + 1), static_cast<size_t>(top - price - 1) + 1);
+        if (step == NPOS) return false;
+        price += step + 1;
+    }
+    return true;
+}
+
+// Distance from `slot` to the nearest occupied slot at or above it, walking
+// at most `limit` slots (with wrap-around). Returns NPOS if none.
+size_t OrderBookSide::scan_up(size_t slot, size_t limit) const {
+    size_t steps = 0;
+    while (steps < limit) {
+        size_t bit = slot & 63;
+        uint64_t word = ladder_bits_[slot >> 6] & (~uint64_t{0} << bit);
+        if (word) {
+            size_t found = steps + static_cast<size_t>(__builtin_ctzll(word)) - bit;
+            return found < limit ? found : NPOS;
+        }
+        steps += 64 - bit;
+        slot = (slot + 64 - bit) & ladder_mask_;
+    }
+    return NPOS;
+}
+
+// Distance from `slot` to the nearest occupied slot at or below it.
+size_t OrderBookSide::scan_down(size_t slot, size_t limit) const {
+    size_t steps = 0;
+    while (steps < limit) {
+        size_t bit = slot & 63;
+        uint64_t mask = bit == 63 ? ~uint64_t{0} : (uint64_t{2} << bit) - 1;
+        uint64_t word = ladder_bits_[slot >> 6] & mask;
+        if (word) {
+            size_t found = steps + bit - (63 - static_cast<size_t>(__builtin_clzll(word)));
+            return found < limit ? found : NPOS;
+        }
+        steps += bit + 1;
+        slot = (slot - bit - 1) & ladder_mask_;
+    }
+    return NPOS;
+}
+
+// Try to move the ladder window so that it covers `price` while still
+// holding every occupied ladder level. Map levels that fall inside the new
+// window are spliced into the ladder to keep one level per price.
+bool OrderBookSide::move_window(Price price) {
+    size_t size = ladder_mask_ + 1;
+    Price lo = price;
+    Price hi = price;
+    if (ladder_count_ > 0) {
+        Price ladder_lo = ladder_base_ + scan_up(slot_of(ladder_base_), size);
+        Price ladder_hi = ladder_base_ + ladder_mask_ - scan_down(slot_of(ladder_base_ + ladder_mask_), size);
+        lo = std::min(lo, ladder_lo);
+        hi = std::max(hi, ladder_hi);
+    }
+    if (hi - lo > ladder_mask_) return false;
+    // Centre the occupied span in the new window.
+    Price slack = (ladder_mask_ - (hi - lo)) / 2;
+    ladder_base_ = lo > slack ? lo - slack : 0;
+
+    auto it = levels_.lower_bound(ladder_base_);
+    while (it != levels_.end() && in_window(it->first)) {
+        occupy_slot(it->first)->splice_from(*it->second);
+        it = levels_.erase(it);
     }
+    return true;
 }
-bool OrderBookSide::is_empty() const { return levels_.empty(); } 
\ No newline at end of file
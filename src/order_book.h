@@ -1,67 +1,283 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <chrono>
 #include <memory>
-#include <queue>
 #include <map>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
+#include "fixed_point.h"
 
 // Core Types and Enums
 
 enum class OrderSide : uint8_t { BUY = 0, SELL = 1 };
-enum class OrderType : uint8_t { LIMIT = 0, MARKET = 1 };
+// IOC takes what crosses at its limit and drops the rest; FOK trades its
+// full size at its limit or not at all; POST_ONLY rests, and is rejected
+// rather than taking liquidity if it would cross.
+enum class OrderType : uint8_t { LIMIT = 0, MARKET = 1, IOC = 2, FOK = 3, POST_ONLY = 4 };
 using OrderId = uint64_t;
-using Price = uint64_t;
-using Quantity = uint64_t;
-using Timestamp = std::chrono::steady_clock::time_point;
+using SymbolId = uint32_t;
+// Raw tick counts, as carried on the wire and in the book; FixedPrice and
+// FixedQuantity are the same values with their scale attached.
+using Price = FixedPrice::rep;
+using Quantity = FixedQuantity::rep;
+using Timestamp = uint64_t;  // TscClock ticks; TscClock::to_wall_ns for wall time
+// Account an order belongs to; 0 is unattributed flow (e.g. the public
+// feed) and never self-trades. Eight bits, so it fits the reserved byte of
+// the capture, journal and snapshot records and the padding of Order and
+// TradeEvent.
+using ParticipantId = uint8_t;
 
+inline double price_to_double(Price ticks) { return FixedPrice::from_ticks(ticks).to_double(); }
+inline Price double_to_price(double price) { return FixedPrice::from_double(price).ticks(); }
+
+class OrderBookLevel;
+
+// An order as it travels through the system. Inside the book it is split
+// into a RestingOrder and its RestingOrderInfo (see OrderPool).
 struct Order {
     OrderId order_id;
+    Price price;
+    Quantity quantity;
     Timestamp timestamp;
+    SymbolId symbol;
     OrderSide side;
+    OrderType type;
+    ParticipantId participant;
+    // The default constructor leaves the order unstamped (timestamp 0) so
+    // batch producers can stamp with one read via TscClock::stamp_batch.
+    Order()
+        : order_id(0), price(0), quantity(0), timestamp(0), symbol(0), side(OrderSide::BUY), type(OrderType::LIMIT),
+          participant(0) {}
+    Order(OrderId id, OrderSide s, Price p, Quantity q, OrderType t, SymbolId sym = 0);
+};
+
+static_assert(sizeof(Order) == 40, "Order fields should pack without holes");
+
+struct RestingOrderInfo;
+
+// Hot half of a resting order: only what the match loop reads and writes,
+// so a level's queue walks two orders per cache line. Intrusive links are
+// owned by the level the order rests on. The resting size is 32-bit to
+// make room for the owner the self-trade check reads; larger orders are
+// rejected rather than rested.
+struct RestingOrder {
+    static constexpr Quantity MAX_QUANTITY = UINT32_MAX;
+
+    RestingOrder* prev;
+    RestingOrder* next;
+    OrderId order_id;
+    uint32_t quantity;
+    ParticipantId participant;
+
+    // The cold half, at a fixed offset in the same pool slab.
+    RestingOrderInfo& info();
+    const RestingOrderInfo& info() const;
+    Order to_order() const;
+};
+
+// Cold half, kept in a side table: read on add, cancel, modify and
+// snapshot, never while matching.
+struct RestingOrderInfo {
+    OrderBookLevel* level;
     Price price;
-    Quantity quantity;
+    Timestamp timestamp;
+    SymbolId symbol;
+    OrderSide side;
     OrderType type;
-    Order() : order_id(0), timestamp(std::chrono::steady_clock::now()), side(OrderSide::BUY), price(0), quantity(0), type(OrderType::LIMIT) {}
-    Order(OrderId id, OrderSide s, Price p, Quantity q, OrderType t);
 };
 
+static_assert(sizeof(RestingOrder) == 32, "two resting orders per cache line");
+static_assert(sizeof(RestingOrderInfo) == sizeof(RestingOrder), "hot and cold slab tables share an index");
+
+// One pool slab: hot nodes and their cold halves in parallel tables, so
+// either half is found from the other by a constant offset.
+struct RestingOrderSlab {
+    static constexpr size_t SIZE = 4096;
+    RestingOrder hot[SIZE];
+    RestingOrderInfo cold[SIZE];
+};
+
+inline RestingOrderInfo& RestingOrder::info() {
+    return *reinterpret_cast<RestingOrderInfo*>(reinterpret_cast<char*>(this) + offsetof(RestingOrderSlab, cold));
+}
+inline const RestingOrderInfo& RestingOrder::info() const {
+    return *reinterpret_cast<const RestingOrderInfo*>(reinterpret_cast<const char*>(this) +
+                                                      offsetof(RestingOrderSlab, cold));
+}
+inline Order RestingOrder::to_order() const {
+    const RestingOrderInfo& cold = info();
+    Order order;
+    order.order_id = order_id;
+    order.price = cold.price;
+    order.quantity = quantity;
+    order.timestamp = cold.timestamp;
+    order.symbol = cold.symbol;
+    order.side = cold.side;
+    order.type = cold.type;
+    order.participant = participant;
+    return order;
+}
+
 struct TradeEvent {
     OrderId buy_order_id;
     OrderId sell_order_id;
     Price price;
     Quantity quantity;
     Timestamp timestamp;
-    TradeEvent(OrderId buy_id, OrderId sell_id, Price p, Quantity q);
+    SymbolId symbol;
+    ParticipantId buy_participant;
+    ParticipantId sell_participant;
+    OrderSide aggressor;  // Side of the incoming order that took liquidity
+    TradeEvent()
+        : buy_order_id(0), sell_order_id(0), price(0), quantity(0), timestamp(0), symbol(0), buy_participant(0),
+          sell_participant(0), aggressor(OrderSide::BUY) {}
+    TradeEvent(SymbolId sym, OrderId buy_id, OrderId sell_id, Price p, Quantity q);
+    TradeEvent(SymbolId sym, OrderId buy_id, OrderId sell_id, Price p, Quantity q, Timestamp ts);
+};
+
+static_assert(sizeof(TradeEvent) == 48, "TradeEvent should keep its ring slot size");
+
+// One aggregated price level as seen in a depth snapshot.
+struct DepthLevel {
+    Price price;
+    Quantity quantity;
+    uint32_t orders;
 };
 
 class OrderBookLevel {
 public:
+    OrderBookLevel() : OrderBookLevel(0) {}
     explicit OrderBookLevel(Price price);
-    void add_order(std::shared_ptr<Order> order);
-    std::shared_ptr<Order> get_front_order();
-    void remove_front_order();
-    bool remove_order(OrderId order_id);
+    void reset(Price price);
+    void splice_from(OrderBookLevel& other);
+    void add_order(RestingOrder* order);
+    RestingOrder* get_front_order();
+    const RestingOrder* get_front_order() const { return head_; }
+    RestingOrder* remove_front_order();
+    void remove_order(RestingOrder* order);
+    // Shrinks a resting order without touching its queue position.
+    void reduce_order(RestingOrder* order, Quantity amount);
     Price get_price() const;
     Quantity get_total_quantity() const;
+    uint32_t get_order_count() const { return order_count_; }
     bool is_empty() const;
 private:
     Price price_;
-    std::queue<std::shared_ptr<Order>> orders_;
+    RestingOrder* head_;
+    RestingOrder* tail_;
     Quantity total_quantity_;
+    uint32_t order_count_;
 };
 
+// One side of the book. Levels live either in a dense price ladder (a ring
+// of preallocated levels indexed by price, with an occupancy bitmap and a
+// best-price cursor) or, for prices outside the ladder window or when the
+// ladder is disabled, in an ordered map. The ladder window slides or
+// re-centres when the orders it holds allow it; map levels are migrated
+// into the ladder whenever the window moves over them.
 class OrderBookSide {
 public:
-    explicit OrderBookSide(bool is_bid);
-    void add_order(std::shared_ptr<Order> order);
-    std::shared_ptr<Order> get_best_order();
-    void remove_best_order();
-    bool remove_order(OrderId order_id, Price price);
+    explicit OrderBookSide(bool is_bid, size_t ladder_levels = 0);
+    void add_order(RestingOrder* order);
+    OrderBookLevel* get_best_level() { return best_level(); }
+    RestingOrder* get_best_order();
+    RestingOrder* remove_best_order();
+    void remove_order(RestingOrder* order);
+    void reduce_order(RestingOrder* order, Quantity amount);
+    // For the match loop, which already holds the order's level: leaves
+    // the cold half untouched.
+    void reduce_order(OrderBookLevel* level, RestingOrder* order, Quantity amount) {
+        level->reduce_order(order, amount);
+        touch(level->get_price());
+    }
     Price get_best_price() const;
     bool is_empty() const;
+    // Writes up to `n` levels, best first, into `out`; returns the count.
+    size_t get_depth(DepthLevel* out, size_t n) const;
+    // Visits every level best first until `fn(const OrderBookLevel&)`
+    // returns false.
+    template <typename Fn>
+    void for_each_level(Fn&& fn) const;
+    // Incremental depth publishing: changes are tracked only while they land
+    // at or inside the window last handed out by publish_depth().
+    bool depth_changed() const { return depth_dirty_; }
+    size_t publish_depth(DepthLevel* out, size_t n);
+
+    // Change journal for delta publishing: while enabled, each price a
+    // command touches is noted once, with whether the level was created.
+    struct LevelChange {
+        Price price;
+        bool created;
+    };
+    void track_changes(bool enabled) { track_changes_ = enabled; }
+    std::vector<LevelChange>& changes() { return changes_; }
+    const OrderBookLevel* find_level(Price price) const;
+    // Whether an incoming order limited at `limit` would trade against this side.
+    bool crosses(Price limit, Price level_price) const { return is_bid_side_ ? level_price >= limit : level_price <= limit; }
+    // Resting quantity at prices that cross `limit`, summed level by level
+    // from the aggregates and stopping once `wanted` is reached.
+    Quantity available_through(Price limit, Quantity wanted) const;
 private:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
     std::map<Price, std::unique_ptr<OrderBookLevel>> levels_;
     bool is_bid_side_;
-}; 
\ No newline at end of file
+
+    std::vector<OrderBookLevel> ladder_;
+    std::vector<uint64_t> ladder_bits_;
+    size_t ladder_mask_ = 0;
+    size_t ladder_count_ = 0;
+    Price ladder_base_ = 0;
+    Price ladder_best_ = 0;
+
+    bool depth_dirty_ = true;
+    bool depth_full_ = false;
+    Price depth_bound_ = 0;
+
+    bool track_changes_ = false;
+    std::vector<LevelChange> changes_;
+
+    OrderBookLevel* best_level();
+    OrderBookLevel* level_for(Price price);
+    void release_level(OrderBookLevel* level);
+
+    bool in_window(Price price) const { return !ladder_.empty() && price >= ladder_base_ && price - ladder_base_ <= ladder_mask_; }
+    size_t slot_of(Price price) const { return static_cast<size_t>(price) & ladder_mask_; }
+    bool better(Price a, Price b) const { return is_bid_side_ ? a > b : a < b; }
+    OrderBookLevel* occupy_slot(Price price);
+    size_t scan_up(size_t slot, size_t limit) const;
+    size_t scan_down(size_t slot, size_t limit) const;
+    bool next_ladder_price(Price& price) const;
+    void touch(Price price, bool created = false) {
+        if (!depth_full_ || !better(depth_bound_, price)) depth_dirty_ = true;
+        if (track_changes_) note_change(price, created);
+    }
+    void note_change(Price price, bool created);
+    bool move_window(Price price);
+};
+
+template <typename Fn>
+void OrderBookSide::for_each_level(Fn&& fn) const {
+    // Map levels sit outside the ladder window, on either side of it, so
+    // merge the two price-ordered walks.
+    bool have_ladder = ladder_count_ > 0;
+    Price ladder_price = ladder_best_;
+    auto merge = [&](auto it, auto end) {
+        while (have_ladder || it != end) {
+            if (have_ladder && (it == end || better(ladder_price, it->first))) {
+                if (!fn(static_cast<const OrderBookLevel&>(ladder_[slot_of(ladder_price)]))) return;
+                have_ladder = next_ladder_price(ladder_price);
+            } else {
+                if (!fn(static_cast<const OrderBookLevel&>(*it->second))) return;
+                ++it;
+            }
+        }
+    };
+    if (is_bid_side_) {
+        merge(levels_.rbegin(), levels_.rend());
+    } else {
+        merge(levels_.begin(), levels_.end());
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "order_book.h"
+
+// Monotonic order IDs from one partition of the 64-bit ID space: the top
+// 16 bits name the source and the low 48 count its orders. Each generator
+// owns its source and lives on one thread, so next() is a plain increment
+// and no two sources can hand out the same ID.
+class OrderIdGenerator {
+public:
+    static constexpr int SEQUENCE_BITS = 48;
+    static constexpr uint16_t EXTERNAL_SOURCE = 0;           // IDs assigned upstream (captures, the UDP feed)
+    static constexpr uint16_t FIRST_LOAD_SOURCE = 1;         // Load producer i is FIRST_LOAD_SOURCE + i
+    static constexpr uint16_t SIMULATED_FEED_SOURCE = 0x3fff;  // MarketData's random feed
+    static constexpr uint16_t FIRST_STRATEGY_SOURCE = 0x4000;  // Strategies: every ID at or above 2^62
+    static constexpr uint16_t STRATEGY_SOURCES = 0x4000;
+
+    explicit OrderIdGenerator(uint16_t source)
+        : prefix_(static_cast<OrderId>(source) << SEQUENCE_BITS), next_(prefix_ + 1) {}
+
+    OrderId next() { return next_++; }
+    uint16_t source() const { return source_of(prefix_); }
+    static uint16_t source_of(OrderId id) { return static_cast<uint16_t>(id >> SEQUENCE_BITS); }
+    static bool is_strategy_order(OrderId id) { return source_of(id) >= FIRST_STRATEGY_SOURCE; }
+
+    // A source no other live strategy holds, taken once when a strategy is
+    // built rather than per order. Wraps after STRATEGY_SOURCES strategies,
+    // which only matters if that many trade into the same book at once.
+    static uint16_t claim_strategy_source() {
+        static std::atomic<uint32_t> claimed{0};
+        uint32_t index = claimed.fetch_add(1, std::memory_order_relaxed) % STRATEGY_SOURCES;
+        return static_cast<uint16_t>(FIRST_STRATEGY_SOURCE + index);
+    }
+private:
+    OrderId prefix_;
+    OrderId next_;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "lockfree_ring.h"
+#include "order_book.h"
+
+// Order ID -> resting node map for the matcher: one flat array of 16-byte
+// slots, Robin Hood probing and backward-shift deletion, so a lookup is one
+// or two adjacent cache lines and nothing is allocated per order. Sized at
+// construction for at most half full; it only rehashes if the book outgrows
+// that (as the order pool only grows when it runs dry).
+class OrderLookup {
+public:
+    explicit OrderLookup(size_t expected = 0) { reserve(expected); }
+
+    void reserve(size_t expected) {
+        size_t capacity = round_up_pow2(expected * 2 > MIN_CAPACITY ? expected * 2 : MIN_CAPACITY);
+        if (capacity > slots_.size()) rehash(capacity);
+    }
+
+    RestingOrder* find(OrderId id) const {
+        size_t slot = locate(id);
+        return slot == NOT_FOUND ? nullptr : slots_[slot].node;
+    }
+
+    // Inserts, or repoints an ID that is already present.
+    void assign(OrderId id, RestingOrder* node) {
+        if (size_ >= slots_.size() - slots_.size() / 8) rehash(slots_.size() * 2);
+        size_t slot = home(id);
+        for (size_t dist = 0;; ++dist, slot = (slot + 1) & mask_) {
+            Slot& resident = slots_[slot];
+            if (!resident.node) {
+                resident = Slot{id, node};
+                ++size_;
+                return;
+            }
+            if (resident.id == id) {
+                resident.node = node;
+                return;
+            }
+            // Take the slot from a resident closer to its home; it moves on.
+            size_t resident_dist = distance(resident.id, slot);
+            if (resident_dist < dist) {
+                std::swap(resident.id, id);
+                std::swap(resident.node, node);
+                dist = resident_dist;
+            }
+        }
+    }
+
+    // Removes `id` and returns its node, or nullptr if absent.
+    RestingOrder* take(OrderId id) {
+        size_t slot = locate(id);
+        if (slot == NOT_FOUND) return nullptr;
+        RestingOrder* node = slots_[slot].node;
+        // Pull the rest of the run back one slot instead of leaving a tombstone.
+        for (size_t next = (slot + 1) & mask_; slots_[next].node && distance(slots_[next].id, next) > 0;
+             slot = next, next = (next + 1) & mask_) {
+            slots_[slot] = slots_[next];
+        }
+        slots_[slot].node = nullptr;
+        --size_;
+        return node;
+    }
+    bool erase(OrderId id) { return take(id) != nullptr; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return slots_.size(); }
+private:
+    struct Slot {
+        OrderId id;
+        RestingOrder* node;  // nullptr marks an empty slot, so every ID is a valid key
+    };
+    static constexpr size_t MIN_CAPACITY = 16;
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    int shift_ = 64;
+    size_t size_ = 0;
+
+    // Fibonacci hashing: IDs are mostly sequential within a source prefix,
+    // and the multiply spreads both the prefix and the sequence.
+    size_t home(OrderId id) const { return static_cast<size_t>((id * 0x9e3779b97f4a7c15ULL) >> shift_); }
+    size_t distance(OrderId id, size_t slot) const { return (slot - home(id)) & mask_; }
+
+    size_t locate(OrderId id) const {
+        size_t slot = home(id);
+        for (size_t dist = 0;; ++dist, slot = (slot + 1) & mask_) {
+            const Slot& resident = slots_[slot];
+            // Robin Hood order: past a resident nearer its home, `id` cannot appear.
+            if (!resident.node || distance(resident.id, slot) < dist) return NOT_FOUND;
+            if (resident.id == id) return slot;
+        }
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old(capacity, Slot{0, nullptr});
+        old.swap(slots_);
+        mask_ = capacity - 1;
+        shift_ = 64;
+        for (size_t bits = capacity; bits > 1; bits >>= 1) --shift_;
+        size_ = 0;
+        for (const Slot& slot : old) {
+            if (slot.node) assign(slot.id, slot.node);
+        }
+    }
+};
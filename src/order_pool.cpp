@@ -0,0 +1,41 @@
+#include "order_pool.h"
+
+OrderPool::OrderPool(size_t initial_capacity) {
+    size_t slabs = (initial_capacity + SLAB_SIZE - 1) / SLAB_SIZE;
+    if (slabs == 0) slabs = 1;
+    free_list_.reserve(slabs * SLAB_SIZE);
+    for (size_t i = 0; i < slabs; ++i) grow();
+}
+
+RestingOrder* OrderPool::acquire(const Order& order) {
+    if (free_list_.empty()) grow();
+    RestingOrder* node = free_list_.back();
+    free_list_.pop_back();
+    node->prev = nullptr;
+    node->next = nullptr;
+    node->order_id = order.order_id;
+    node->quantity = static_cast<uint32_t>(order.quantity);  // Callers check MAX_QUANTITY
+    node->participant = order.participant;
+    RestingOrderInfo& info = node->info();
+    info.level = nullptr;
+    info.price = order.price;
+    info.timestamp = order.timestamp;
+    info.symbol = order.symbol;
+    info.side = order.side;
+    info.type = order.type;
+    return node;
+}
+
+void OrderPool::release(RestingOrder* order) {
+    if (order) free_list_.push_back(order);
+}
+
+void OrderPool::grow() {
+    slabs_.push_back(std::make_unique<RestingOrderSlab>());
+    RestingOrder* slab = slabs_.back()->hot;
+    free_list_.reserve(slabs_.size() * SLAB_SIZE);
+    // Push in reverse so acquire() walks each slab front to back.
+    for (size_t i = SLAB_SIZE; i-- > 0;) {
+        free_list_.push_back(&slab[i]);
+    }
+}
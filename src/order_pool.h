@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "order_book.h"
+
+// Slab allocator for resting orders. Orders are handed out as raw intrusive
+// handles (RestingOrder*) that stay valid until released; slabs are never
+// freed or moved, so the book can link nodes directly. Each slab holds the
+// hot nodes and their cold halves side by side (RestingOrderSlab).
+// Allocation only happens when the pool runs dry, never in steady state.
+class OrderPool {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+    static constexpr size_t SLAB_SIZE = RestingOrderSlab::SIZE;
+
+    explicit OrderPool(size_t initial_capacity = DEFAULT_CAPACITY);
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    RestingOrder* acquire(const Order& order);
+    void release(RestingOrder* order);
+
+    size_t capacity() const { return slabs_.size() * SLAB_SIZE; }
+    size_t in_use() const { return capacity() - free_list_.size(); }
+private:
+    std::vector<std::unique_ptr<RestingOrderSlab>> slabs_;
+    std::vector<RestingOrder*> free_list_;
+    void grow();
+};
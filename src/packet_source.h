@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Receive buffers for one poll of a packet source, allocated once and
+// reused. Datagrams land at fixed MTU-sized offsets.
+struct PacketBatch {
+    static constexpr size_t MAX_PACKETS = 64;
+    static constexpr size_t MTU = 2048;
+
+    PacketBatch() : data(new uint8_t[MAX_PACKETS * MTU]) {}
+    uint8_t* packet(size_t i) { return data.get() + i * MTU; }
+    const uint8_t* packet(size_t i) const { return data.get() + i * MTU; }
+
+    std::unique_ptr<uint8_t[]> data;
+    size_t lengths[MAX_PACKETS] = {};
+    size_t count = 0;
+};
+
+// Backend that delivers raw datagrams to the feed handler. The kernel UDP
+// socket is one implementation; AF_XDP or DPDK rings slot in behind the
+// same call. Dispatch is virtual but per batch, not per message.
+class PacketSource {
+public:
+    virtual ~PacketSource() = default;
+    // Fills `batch` with whatever is ready, up to MAX_PACKETS, without
+    // blocking. Returns the number of packets.
+    virtual size_t receive(PacketBatch& batch) = 0;
+};
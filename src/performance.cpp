@@ -1,8 +1,37 @@
 #include "performance.h"
+#include "threading.h"
+#include "tsc_clock.h"
+#include <iomanip>
 
-PerformanceMonitor::PerformanceMonitor() {}
+const char* latency_stage_name(LatencyStage stage) {
+    switch (stage) {
+    case LatencyStage::FEED_TO_STRATEGY: return "feed->strategy";
+    case LatencyStage::STRATEGY_TO_RISK: return "strategy->risk";
+    case LatencyStage::RISK_TO_ENGINE: return "risk->engine";
+    case LatencyStage::COUNT: break;
+    }
+    return "unknown";
+}
+
+void print_latency_line(std::ostream& out, const char* name, const LatencyStats& stats) {
+    out << "  " << std::left << std::setw(16) << name << std::right
+        << " n=" << stats.count
+        << " p50=" << stats.p50_ns << "ns"
+        << " p99=" << stats.p99_ns << "ns"
+        << " p99.9=" << stats.p999_ns << "ns"
+        << " max=" << stats.max_ns << "ns\n";
+}
+
+PerformanceMonitor::PerformanceMonitor() : slots_(new std::atomic<ThreadHistograms*>[THREAD_SLOTS]) {
+    for (size_t i = 0; i < THREAD_SLOTS; ++i) slots_[i].store(nullptr, std::memory_order_relaxed);
+}
+
+PerformanceMonitor::~PerformanceMonitor() {
+    for (size_t i = 0; i < THREAD_SLOTS; ++i) delete slots_[i].load(std::memory_order_relaxed);
+}
 
 void PerformanceMonitor::start() {
+    TscClock::ns_per_tick();  // Calibrate now rather than on the first sample
     running_ = true;
     event_count_ = 0;
     start_time_ = std::chrono::steady_clock::now();
@@ -22,4 +51,35 @@ double PerformanceMonitor::get_events_per_second() const {
     auto duration = std::chrono::duration_cast<std::chrono::seconds>(end - start_time_).count();
     if (duration <= 0) return 0.0;
     return static_cast<double>(event_count_.load()) / duration;
-} 
\ No newline at end of file
+}
+
+PerformanceMonitor::ThreadHistograms& PerformanceMonitor::local_histograms() {
+    std::atomic<ThreadHistograms*>& slot = slots_[current_thread_index() % THREAD_SLOTS];
+    ThreadHistograms* histograms = slot.load(std::memory_order_acquire);
+    if (histograms) return *histograms;
+    auto* fresh = new ThreadHistograms();
+    if (slot.compare_exchange_strong(histograms, fresh, std::memory_order_acq_rel)) return *fresh;
+    // Another thread sharing this slot won the race.
+    delete fresh;
+    return *histograms;
+}
+
+void PerformanceMonitor::record_latency(LatencyStage stage, uint64_t ticks) {
+    local_histograms().stages[static_cast<size_t>(stage)].record(TscClock::to_ns(ticks));
+}
+
+LatencyStats PerformanceMonitor::get_latency_stats(LatencyStage stage) const {
+    LatencyHistogram merged;
+    for (size_t i = 0; i < THREAD_SLOTS; ++i) {
+        const ThreadHistograms* histograms = slots_[i].load(std::memory_order_acquire);
+        if (histograms) merged.merge(histograms->stages[static_cast<size_t>(stage)]);
+    }
+    return merged.stats();
+}
+
+void PerformanceMonitor::print_latency_report(std::ostream& out) const {
+    for (size_t i = 0; i < NUM_STAGES; ++i) {
+        LatencyStage stage = static_cast<LatencyStage>(i);
+        print_latency_line(out, latency_stage_name(stage), get_latency_stats(stage));
+    }
+}
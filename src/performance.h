@@ -1,17 +1,55 @@
 #pragma once
 #include <chrono>
 #include <atomic>
+#include <memory>
+#include <ostream>
+#include "latency_histogram.h"
+
+// Pipeline stages timed by PerformanceMonitor. Match time is recorded by
+// each MatchingEngine on its own thread.
+enum class LatencyStage {
+    FEED_TO_STRATEGY,   // Feed batch produced -> strategy starts on it
+    STRATEGY_TO_RISK,   // Strategy evaluation
+    RISK_TO_ENGINE,     // Risk checks and hand-off to the engine
+    COUNT
+};
+
+const char* latency_stage_name(LatencyStage stage);
 
 class PerformanceMonitor {
 public:
+    static constexpr size_t THREAD_SLOTS = 64;
+    static constexpr size_t NUM_STAGES = static_cast<size_t>(LatencyStage::COUNT);
+
     PerformanceMonitor();
+    ~PerformanceMonitor();
+    PerformanceMonitor(const PerformanceMonitor&) = delete;
+    PerformanceMonitor& operator=(const PerformanceMonitor&) = delete;
     void start();
     void stop();
     void record_event();
     double get_events_per_second() const;
+
+    // Lock-free; each thread records into its own histograms (threads past
+    // THREAD_SLOTS share one and may drop an occasional sample). `ticks`
+    // are TscClock ticks.
+    void record_latency(LatencyStage stage, uint64_t ticks);
+    // Merges every thread's histogram for the stage.
+    LatencyStats get_latency_stats(LatencyStage stage) const;
+    void print_latency_report(std::ostream& out) const;
 private:
+    struct ThreadHistograms {
+        LatencyHistogram stages[NUM_STAGES];
+    };
     std::chrono::steady_clock::time_point start_time_;
     std::chrono::steady_clock::time_point end_time_;
     std::atomic<uint64_t> event_count_{0};
     std::atomic<bool> running_{false};
-}; 
\ No newline at end of file
+    // Allocated on a thread's first sample so idle slots cost one pointer.
+    std::unique_ptr<std::atomic<ThreadHistograms*>[]> slots_;
+
+    ThreadHistograms& local_histograms();
+};
+
+// One "name count p50 p99 p99.9 max" line, shared by engine and pipeline reports.
+void print_latency_line(std::ostream& out, const char* name, const LatencyStats& stats);
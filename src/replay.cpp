@@ -0,0 +1,113 @@
+#include "replay.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NANOEX_HAVE_MMAP 1
+#endif
+
+CaptureFile::~CaptureFile() {
+    close();
+}
+
+bool CaptureFile::open(const std::string& path) {
+    close();
+    const char* bytes = nullptr;
+#ifdef NANOEX_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CaptureHeader))) {
+        ::close(fd);
+        error_ = path + " is not a capture file";
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        error_ = "cannot map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    // Replay walks the file front to back.
+    madvise(data_, size_, MADV_SEQUENTIAL);
+    bytes = static_cast<const char*>(data_);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    size_ = fallback_.size();
+    if (size_ < sizeof(CaptureHeader)) {
+        error_ = path + " is not a capture file";
+        return false;
+    }
+    bytes = fallback_.data();
+#endif
+    CaptureHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (header.magic != CaptureHeader::MAGIC || header.version != CaptureHeader::VERSION ||
+        header.record_size != sizeof(MarketRecord)) {
+        close();
+        error_ = path + " has an unsupported capture header";
+        return false;
+    }
+    // A writer that never closed leaves the count at 0; trust the file size.
+    size_t available = (size_ - sizeof(CaptureHeader)) / sizeof(MarketRecord);
+    count_ = header.record_count != 0 && header.record_count < available
+        ? static_cast<size_t>(header.record_count) : available;
+    records_ = reinterpret_cast<const MarketRecord*>(bytes + sizeof(CaptureHeader));
+    open_ = true;
+    return true;
+}
+
+void CaptureFile::close() {
+#ifdef NANOEX_HAVE_MMAP
+    if (data_) munmap(data_, size_);
+#endif
+    data_ = nullptr;
+    fallback_.clear();
+    size_ = 0;
+    records_ = nullptr;
+    count_ = 0;
+    open_ = false;
+}
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+bool CaptureWriter::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) return false;
+    count_ = 0;
+    CaptureHeader header;
+    return std::fwrite(&header, sizeof(header), 1, file_) == 1;
+}
+
+bool CaptureWriter::write(const MarketRecord& record) {
+    if (!file_ || std::fwrite(&record, sizeof(record), 1, file_) != 1) return false;
+    ++count_;
+    return true;
+}
+
+bool CaptureWriter::close() {
+    if (!file_) return true;
+    CaptureHeader header;
+    header.record_count = count_;
+    bool ok = std::fseek(file_, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file_) == 1;
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+}
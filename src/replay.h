@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "market_record.h"
+#include "span.h"
+
+// Read-only view of a capture file. On POSIX the file is memory-mapped and
+// records are read in place; elsewhere it is read into memory once.
+class CaptureFile {
+public:
+    CaptureFile() = default;
+    ~CaptureFile();
+    CaptureFile(const CaptureFile&) = delete;
+    CaptureFile& operator=(const CaptureFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return open_; }
+    Span<MarketRecord> records() const { return Span<MarketRecord>(records_, count_); }
+    const std::string& error() const { return error_; }
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<char> fallback_;
+    const MarketRecord* records_ = nullptr;
+    size_t count_ = 0;
+    bool open_ = false;
+    std::string error_;
+};
+
+// Appends records to a capture file; the header's record count is written
+// on close().
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool open(const std::string& path);
+    bool write(const MarketRecord& record);
+    bool close();
+    bool is_open() const { return file_ != nullptr; }
+    uint64_t count() const { return count_; }
+private:
+    std::FILE* file_ = nullptr;
+    uint64_t count_ = 0;
+};
+
+struct ReplayConfig {
+    size_t batch_size = 64;   // Records per callback
+    bool paced = false;       // false = as fast as possible, true = recorded pace
+    double speed = 1.0;       // Pace multiplier when paced (2.0 = twice as fast)
+};
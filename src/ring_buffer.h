@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "span.h"
+
+// Fixed-capacity ring buffer whose storage is mirrored (every element is
+// written twice, capacity apart), so any window of recent elements is one
+// contiguous span with no wrap-around handling in the consumer.
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity)
+        : capacity_(capacity > 0 ? capacity : 1), storage_(2 * capacity_) {}
+
+    void push_back(const T& value) {
+        storage_[head_] = value;
+        storage_[head_ + capacity_] = value;
+        head_ = head_ + 1 == capacity_ ? 0 : head_ + 1;
+        if (size_ < capacity_) ++size_;
+    }
+
+    // The most recent `count` elements, oldest first.
+    Span<T> window(size_t count) const {
+        size_t n = count < size_ ? count : size_;
+        return Span<T>(storage_.data() + head_ + capacity_ - n, n);
+    }
+    Span<T> view() const { return window(size_); }
+
+    const T& back() const { return storage_[head_ + capacity_ - 1]; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    void clear() { head_ = size_ = 0; }
+private:
+    size_t capacity_;
+    std::vector<T> storage_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
@@ -1,46 +1,185 @@
 #include "risk.h"
+#include "threading.h"
+#include <algorithm>
+#include <cmath>
 
-RiskManager::RiskManager() : config_() {}
+RiskManager::RiskManager() : RiskManager(RiskConfig()) {}
 
-RiskManager::RiskManager(const RiskConfig& config) : config_(config) {}
+RiskManager::RiskManager(const RiskConfig& config)
+    : config_(config), exposures_(config.num_symbols), slots_(new CounterSlot[COUNTER_SLOTS]) {}
 
 void RiskManager::set_config(const RiskConfig& config) {
     config_ = config;
+    exposures_.resize(config.num_symbols);
 }
 
 const RiskConfig& RiskManager::get_config() const {
     return config_;
 }
 
-std::vector<std::shared_ptr<Order>> RiskManager::filter_orders(
-    const std::vector<std::shared_ptr<Order>>& orders) {
-    std::vector<std::shared_ptr<Order>> out;
-    out.reserve(orders.size());
+size_t RiskManager::check_batch(Span<Order> orders, uint64_t* reject) {
+    // Limits are hoisted out of the loop; 0 (or 0.0) disables a check.
+    const uint64_t max_qty = config_.max_order_quantity;
+    const uint64_t max_notional = config_.max_notional_per_order;
+    const uint64_t max_batch = config_.max_orders_per_batch;
+    const uint64_t max_daily = config_.max_daily_volume;
+    const double max_position_pct = config_.max_position_pct;
 
-    for (const auto& order : orders) {
-        if (config_.max_order_quantity != 0 && order->quantity > config_.max_order_quantity) {
-            ++orders_rejected_;
+    std::fill(reject, reject + (orders.size() + MASK_BITS - 1) / MASK_BITS, 0);
+    CounterSlot& slot = local_slot();
+    size_t accepted = 0;
+    size_t rejected = 0;
+    uint64_t volume = 0;
+    for (size_t i = 0; i < orders.size(); ++i) {
+        const Order& order = orders[i];
+        if (order.symbol >= exposures_.size()) {
+            reject[i / MASK_BITS] |= uint64_t{1} << (i % MASK_BITS);
+            ++rejected;
             continue;
         }
-        if (config_.max_notional_per_order != 0) {
-            uint64_t notional = order->price * order->quantity;
-            if (notional > config_.max_notional_per_order) {
-                ++orders_rejected_;
-                continue;
-            }
+        SymbolExposure& exp = exposures_[order.symbol];
+        uint64_t notional = order.price * order.quantity;
+        bool buy = order.side == OrderSide::BUY;
+
+        bool bad = (max_qty != 0 && order.quantity > max_qty)
+                 | (max_notional != 0 && notional > max_notional)
+                 | (max_batch != 0 && accepted >= max_batch);
+        if (!bad && max_position_pct > 0.0 && exp.book_quantity != 0) {
+            // Worst case: every open order on this side fills as well.
+            int64_t projected = buy
+                ? exp.net_position + static_cast<int64_t>(exp.open_buy + order.quantity)
+                : exp.net_position - static_cast<int64_t>(exp.open_sell + order.quantity);
+            bad = static_cast<double>(std::llabs(projected)) > max_position_pct * exp.book_quantity;
+        }
+        // Spend daily volume last, so rejected orders never consume budget.
+        if (!bad && max_daily != 0) bad = !take_volume(slot, order.quantity);
+        if (bad) {
+            reject[i / MASK_BITS] |= uint64_t{1} << (i % MASK_BITS);
+            ++rejected;
+            continue;
         }
-        if (config_.max_orders_per_batch != 0 && out.size() >= config_.max_orders_per_batch) {
-            ++orders_rejected_;
+        (buy ? exp.open_buy : exp.open_sell) += order.quantity;
+        exp.open_notional += notional;
+        volume += order.quantity;
+        ++accepted;
+    }
+    if (rejected != 0) slot.rejected.fetch_add(rejected, std::memory_order_relaxed);
+    if (volume != 0) slot.volume_used.fetch_add(volume, std::memory_order_relaxed);
+    return rejected;
+}
+
+uint64_t RiskManager::check_batch(Span<Order> orders) {
+    if (orders.size() > MASK_BITS) {
+        // Cannot report every order in one word, so nothing passes.
+        local_slot().rejected.fetch_add(orders.size(), std::memory_order_relaxed);
+        return ~uint64_t{0};
+    }
+    uint64_t reject = 0;
+    check_batch(orders, &reject);
+    return reject;
+}
+
+size_t RiskManager::filter_orders(std::vector<Order>& orders) {
+    thread_local std::vector<uint64_t> mask;
+    mask.resize((orders.size() + MASK_BITS - 1) / MASK_BITS);
+    if (check_batch(orders, mask.data()) == 0) return orders.size();
+    size_t kept = 0;
+    for (size_t i = 0; i < orders.size(); ++i) {
+        if (mask[i / MASK_BITS] & (uint64_t{1} << (i % MASK_BITS))) continue;
+        if (kept != i) orders[kept] = orders[i];
+        ++kept;
+    }
+    orders.resize(kept);
+    return kept;
+}
+
+void RiskManager::release_open(SymbolExposure& exp, OrderSide side, Price price, Quantity quantity) {
+    uint64_t& open = side == OrderSide::BUY ? exp.open_buy : exp.open_sell;
+    open -= std::min(open, quantity);
+    exp.open_notional -= std::min(exp.open_notional, price * quantity);
+}
+
+RiskManager::CounterSlot& RiskManager::local_slot() {
+    return slots_[current_thread_index() % COUNTER_SLOTS];
+}
+
+bool RiskManager::take_volume(CounterSlot& slot, uint64_t quantity) {
+    // Only the owning thread spends from a slot, so this rarely retries;
+    // reclaim_leases() is the other writer.
+    uint64_t lease = slot.lease.load(std::memory_order_relaxed);
+    while (lease >= quantity) {
+        if (slot.lease.compare_exchange_weak(lease, lease - quantity, std::memory_order_relaxed)) return true;
+    }
+    return renew_lease(slot, quantity);
+}
+
+bool RiskManager::renew_lease(CounterSlot& slot, uint64_t quantity) {
+    const uint64_t budget = config_.max_daily_volume;
+    uint64_t chunk = config_.volume_lease != 0
+        ? config_.volume_lease : std::max<uint64_t>(budget / (COUNTER_SLOTS * 4), 1);
+    chunk = std::max(chunk, quantity);
+    uint64_t granted = volume_granted_.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t available = granted < budget ? budget - granted : 0;
+        if (available < quantity) {
+            // Near the limit, pull back what other slots have not spent.
+            if (reclaim_leases() == 0) return false;
+            granted = volume_granted_.load(std::memory_order_relaxed);
             continue;
         }
-        if (config_.max_daily_volume != 0) {
-            if (daily_volume_ + order->quantity > config_.max_daily_volume) {
-                ++orders_rejected_;
-                continue;
-            }
-            daily_volume_ += order->quantity;
+        uint64_t grant = std::min(chunk, available);
+        if (volume_granted_.compare_exchange_weak(granted, granted + grant, std::memory_order_relaxed)) {
+            slot.lease.fetch_add(grant - quantity, std::memory_order_relaxed);
+            return true;
         }
-        out.push_back(order);
     }
-    return out;
+}
+
+uint64_t RiskManager::reclaim_leases() {
+    uint64_t reclaimed = 0;
+    for (size_t i = 0; i < COUNTER_SLOTS; ++i) {
+        reclaimed += slots_[i].lease.exchange(0, std::memory_order_relaxed);
+    }
+    if (reclaimed != 0) volume_granted_.fetch_sub(reclaimed, std::memory_order_relaxed);
+    return reclaimed;
+}
+
+uint64_t RiskManager::get_orders_rejected() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < COUNTER_SLOTS; ++i) total += slots_[i].rejected.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t RiskManager::get_daily_volume() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < COUNTER_SLOTS; ++i) total += slots_[i].volume_used.load(std::memory_order_relaxed);
+    return total;
+}
+
+void RiskManager::reset_counters() {
+    for (size_t i = 0; i < COUNTER_SLOTS; ++i) slots_[i].rejected.store(0, std::memory_order_relaxed);
+    reset_daily_volume();
+}
+
+void RiskManager::reset_daily_volume() {
+    for (size_t i = 0; i < COUNTER_SLOTS; ++i) {
+        slots_[i].volume_used.store(0, std::memory_order_relaxed);
+        slots_[i].lease.store(0, std::memory_order_relaxed);
+    }
+    volume_granted_.store(0, std::memory_order_relaxed);
+}
+
+void RiskManager::on_fill(SymbolId symbol, OrderSide side, Price price, Quantity quantity) {
+    if (symbol >= exposures_.size()) return;
+    SymbolExposure& exp = exposures_[symbol];
+    release_open(exp, side, price, quantity);
+    exp.net_position += side == OrderSide::BUY ? static_cast<int64_t>(quantity) : -static_cast<int64_t>(quantity);
+}
+
+void RiskManager::on_cancel(SymbolId symbol, OrderSide side, Price price, Quantity remaining) {
+    if (symbol < exposures_.size()) release_open(exposures_[symbol], side, price, remaining);
+}
+
+void RiskManager::set_book_quantity(SymbolId symbol, Quantity quantity) {
+    if (symbol < exposures_.size()) exposures_[symbol].book_quantity = quantity;
 }
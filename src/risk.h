@@ -2,8 +2,11 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
 #include <cstdint>
 #include "order_book.h"
+#include "lockfree_ring.h"
+#include "span.h"
 
 struct RiskConfig {
     uint64_t max_order_quantity = 0;      // 0 = no limit
@@ -11,25 +14,76 @@ struct RiskConfig {
     uint32_t max_orders_per_batch = 0;    // 0 = no limit
     uint64_t max_daily_volume = 0;        // 0 = no limit
     double max_position_pct = 0.0;        // 0 = no limit (e.g. 0.01 = 1% of book)
+    size_t num_symbols = 1;               // Exposure is tracked for [0, num_symbols); others are rejected
+    uint64_t volume_lease = 0;            // Daily volume taken from the shared budget at a time (0 = auto)
 };
 
+// Pre-trade state for one symbol. Open quantities cover orders that passed
+// risk and have not yet been reported filled or cancelled.
+struct SymbolExposure {
+    int64_t net_position = 0;     // Filled buys minus filled sells
+    uint64_t open_buy = 0;
+    uint64_t open_sell = 0;
+    uint64_t open_notional = 0;   // price * qty of open orders
+    uint64_t book_quantity = 0;   // Reference for max_position_pct; 0 = not enforced
+};
+
+// Batches may be checked from any thread. Rejection counts and the daily
+// volume budget live in per-thread, cache-line-padded slots: each thread
+// leases a slice of max_daily_volume and spends it locally, touching the
+// shared budget only to renew. Per-symbol exposure is not sharded, so each
+// symbol's batches must be serialized (e.g. one OrderedDispatcher key per
+// symbol).
 class RiskManager {
 public:
+    static constexpr size_t MASK_BITS = 64;
+    static constexpr size_t COUNTER_SLOTS = 64;
+
     explicit RiskManager();
     explicit RiskManager(const RiskConfig& config);
 
     void set_config(const RiskConfig& config);
     const RiskConfig& get_config() const;
 
-    std::vector<std::shared_ptr<Order>> filter_orders(
-        const std::vector<std::shared_ptr<Order>>& orders);
+    // Checks a whole batch in one pass. Bit i of reject[i / 64] is set if
+    // orders[i] is rejected; `reject` must hold (size + 63) / 64 words.
+    // Accepted orders are booked as open exposure, so later orders in the
+    // batch see earlier ones. Returns the number rejected.
+    size_t check_batch(Span<Order> orders, uint64_t* reject);
+    // Single-word form for batches of at most MASK_BITS orders. A longer
+    // batch is rejected whole: it returns all ones and books nothing.
+    uint64_t check_batch(Span<Order> orders);
+    // Runs check_batch and compacts `orders` to the accepted ones.
+    size_t filter_orders(std::vector<Order>& orders);
 
-    uint64_t get_orders_rejected() const { return orders_rejected_; }
-    void reset_counters() { orders_rejected_ = 0; daily_volume_ = 0; }
-    void reset_daily_volume() { daily_volume_ = 0; }
+    // Incremental updates for orders that passed risk; `price` is the price
+    // the order was checked at.
+    void on_fill(SymbolId symbol, OrderSide side, Price price, Quantity quantity);
+    void on_cancel(SymbolId symbol, OrderSide side, Price price, Quantity remaining);
+    void set_book_quantity(SymbolId symbol, Quantity quantity);
+    const SymbolExposure& get_exposure(SymbolId symbol) const { return exposures_[symbol]; }
+
+    // Aggregated over all thread slots; lock-free and safe to call anytime.
+    uint64_t get_orders_rejected() const;
+    uint64_t get_daily_volume() const;
+    // Resets must not race with check_batch.
+    void reset_counters();
+    void reset_daily_volume();
 
 private:
+    struct alignas(CACHE_LINE_SIZE) CounterSlot {
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> volume_used{0};
+        std::atomic<uint64_t> lease{0};  // Unspent daily volume leased to this slot
+    };
     RiskConfig config_;
-    uint64_t orders_rejected_ = 0;
-    uint64_t daily_volume_ = 0;
+    std::vector<SymbolExposure> exposures_;  // Indexed by SymbolId
+    std::unique_ptr<CounterSlot[]> slots_;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> volume_granted_{0};
+
+    CounterSlot& local_slot();
+    bool take_volume(CounterSlot& slot, uint64_t quantity);
+    bool renew_lease(CounterSlot& slot, uint64_t quantity);
+    uint64_t reclaim_leases();
+    void release_open(SymbolExposure& exp, OrderSide side, Price price, Quantity quantity);
 };
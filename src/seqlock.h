@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "lockfree_ring.h"
+
+// Single-writer sequence lock for small trivially copyable snapshots.
+// Readers retry instead of blocking, so they can never stall the writer.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+public:
+    SeqLock() : value_() {}
+
+    void store(const T& value) {
+        uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&value_, &value, sizeof(T));
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        T out;
+        for (;;) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                cpu_relax();
+                continue;
+            }
+            std::memcpy(&out, &value_, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) return out;
+        }
+    }
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> sequence_{0};
+    T value_;
+};
@@ -0,0 +1,90 @@
+#include "shared_memory.h"
+#include <cerrno>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NANOEX_HAVE_SHM 1
+#endif
+
+SharedMemory::~SharedMemory() {
+    close();
+}
+
+bool SharedMemory::create(const std::string& name, size_t size) {
+    close();
+#ifdef NANOEX_HAVE_SHM
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        error_ = "cannot create " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        error_ = "cannot size " + name + ": " + std::strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        error_ = "cannot map " + name + ": " + std::strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    data_ = data;
+    name_ = name;
+    owner_ = true;
+#else
+    fallback_.reset(new unsigned char[size]());
+    data_ = fallback_.get();
+#endif
+    size_ = size;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name, bool writable) {
+    close();
+#ifdef NANOEX_HAVE_SHM
+    int fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        error_ = "cannot open " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        error_ = name + " is empty";
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        error_ = "cannot map " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    data_ = data;
+    size_ = size;
+    name_ = name;
+    return true;
+#else
+    (void)writable;
+    error_ = "shared memory is not supported on this platform";
+    return false;
+#endif
+}
+
+void SharedMemory::close() {
+#ifdef NANOEX_HAVE_SHM
+    if (data_ && !fallback_) munmap(data_, size_);
+    if (owner_) shm_unlink(name_.c_str());
+#endif
+    fallback_.reset();
+    data_ = nullptr;
+    size_ = 0;
+    name_.clear();
+    owner_ = false;
+}
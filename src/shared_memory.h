@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Named POSIX shared-memory region (shm_open + mmap). The creator owns the
+// name and unlinks it on close. Where shared memory is unavailable,
+// create() falls back to a private heap block, so in-process readers
+// still work but open() fails.
+class SharedMemory {
+public:
+    SharedMemory() = default;
+    ~SharedMemory();
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // Creates (or truncates) `name`, which should start with '/'.
+    bool create(const std::string& name, size_t size);
+    // Maps an existing region created by another process.
+    bool open(const std::string& name, bool writable = false);
+    void close();
+
+    bool is_open() const { return data_ != nullptr; }
+    void* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& error() const { return error_; }
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    std::string name_;
+    bool owner_ = false;
+    std::unique_ptr<unsigned char[]> fallback_;
+    std::string error_;
+};
@@ -0,0 +1,189 @@
+#include "simd_kernels.h"
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+double SimdKernels::sum(const double* values, size_t count) {
+    size_t i = 0;
+    double total = 0.0;
+#if defined(__AVX2__)
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(values + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(values + i + 4));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__ARM_NEON)
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    for (; i + 4 <= count; i += 4) {
+        acc0 = vaddq_f64(acc0, vld1q_f64(values + i));
+        acc1 = vaddq_f64(acc1, vld1q_f64(values + i + 2));
+    }
+    total = vaddvq_f64(vaddq_f64(acc0, acc1));
+#endif
+    for (; i < count; ++i) total += values[i];
+    return total;
+}
+
+uint64_t SimdKernels::sum(const uint32_t* values, size_t count) {
+    size_t i = 0;
+    uint64_t total = 0;
+#if defined(__AVX2__)
+    // Widen to 64-bit lanes so a window of any length cannot overflow.
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 4));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepu32_epi64(lo));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepu32_epi64(hi));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__ARM_NEON)
+    uint64x2_t acc0 = vdupq_n_u64(0);
+    uint64x2_t acc1 = vdupq_n_u64(0);
+    for (; i + 8 <= count; i += 8) {
+        acc0 = vpadalq_u32(acc0, vld1q_u32(values + i));
+        acc1 = vpadalq_u32(acc1, vld1q_u32(values + i + 4));
+    }
+    total = vaddvq_u64(vaddq_u64(acc0, acc1));
+#endif
+    for (; i < count; ++i) total += values[i];
+    return total;
+}
+
+void SimdKernels::min_max(const double* values, size_t count, double& min_out, double& max_out) {
+    if (count == 0) {
+        min_out = max_out = 0.0;
+        return;
+    }
+    size_t i = 0;
+    double lo = values[0];
+    double hi = values[0];
+#if defined(__AVX2__)
+    if (count >= 4) {
+        __m256d vlo = _mm256_loadu_pd(values);
+        __m256d vhi = vlo;
+        for (i = 4; i + 4 <= count; i += 4) {
+            __m256d v = _mm256_loadu_pd(values + i);
+            vlo = _mm256_min_pd(vlo, v);
+            vhi = _mm256_max_pd(vhi, v);
+        }
+        double lanes_lo[4];
+        double lanes_hi[4];
+        _mm256_storeu_pd(lanes_lo, vlo);
+        _mm256_storeu_pd(lanes_hi, vhi);
+        lo = std::min(std::min(lanes_lo[0], lanes_lo[1]), std::min(lanes_lo[2], lanes_lo[3]));
+        hi = std::max(std::max(lanes_hi[0], lanes_hi[1]), std::max(lanes_hi[2], lanes_hi[3]));
+    }
+#elif defined(__ARM_NEON)
+    if (count >= 2) {
+        float64x2_t vlo = vld1q_f64(values);
+        float64x2_t vhi = vlo;
+        for (i = 2; i + 2 <= count; i += 2) {
+            float64x2_t v = vld1q_f64(values + i);
+            vlo = vminq_f64(vlo, v);
+            vhi = vmaxq_f64(vhi, v);
+        }
+        lo = vminvq_f64(vlo);
+        hi = vmaxvq_f64(vhi);
+    }
+#endif
+    for (; i < count; ++i) {
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+    min_out = lo;
+    max_out = hi;
+}
+
+void SimdKernels::min_max(const uint32_t* values, size_t count, uint32_t& min_out, uint32_t& max_out) {
+    if (count == 0) {
+        min_out = max_out = 0;
+        return;
+    }
+    size_t i = 0;
+    uint32_t lo = values[0];
+    uint32_t hi = values[0];
+#if defined(__AVX2__)
+    if (count >= 8) {
+        __m256i vlo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+        __m256i vhi = vlo;
+        for (i = 8; i + 8 <= count; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            vlo = _mm256_min_epu32(vlo, v);
+            vhi = _mm256_max_epu32(vhi, v);
+        }
+        uint32_t lanes_lo[8];
+        uint32_t lanes_hi[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes_lo), vlo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes_hi), vhi);
+        lo = *std::min_element(lanes_lo, lanes_lo + 8);
+        hi = *std::max_element(lanes_hi, lanes_hi + 8);
+    }
+#elif defined(__ARM_NEON)
+    if (count >= 4) {
+        uint32x4_t vlo = vld1q_u32(values);
+        uint32x4_t vhi = vlo;
+        for (i = 4; i + 4 <= count; i += 4) {
+            uint32x4_t v = vld1q_u32(values + i);
+            vlo = vminq_u32(vlo, v);
+            vhi = vmaxq_u32(vhi, v);
+        }
+        lo = vminvq_u32(vlo);
+        hi = vmaxvq_u32(vhi);
+    }
+#endif
+    for (; i < count; ++i) {
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+    min_out = lo;
+    max_out = hi;
+}
+
+void SimdKernels::sum_and_squares(const double* values, size_t count, double& sum_out, double& squares_out) {
+    size_t i = 0;
+    double total = 0.0;
+    double squares = 0.0;
+#if defined(__AVX2__)
+    __m256d acc = _mm256_setzero_pd();
+    __m256d acc_sq = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_loadu_pd(values + i);
+        acc = _mm256_add_pd(acc, v);
+        acc_sq = _mm256_add_pd(acc_sq, _mm256_mul_pd(v, v));
+    }
+    double lanes[4];
+    double lanes_sq[4];
+    _mm256_storeu_pd(lanes, acc);
+    _mm256_storeu_pd(lanes_sq, acc_sq);
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    squares = (lanes_sq[0] + lanes_sq[1]) + (lanes_sq[2] + lanes_sq[3]);
+#elif defined(__ARM_NEON)
+    float64x2_t acc = vdupq_n_f64(0.0);
+    float64x2_t acc_sq = vdupq_n_f64(0.0);
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t v = vld1q_f64(values + i);
+        acc = vaddq_f64(acc, v);
+        acc_sq = vfmaq_f64(acc_sq, v, v);
+    }
+    total = vaddvq_f64(acc);
+    squares = vaddvq_f64(acc_sq);
+#endif
+    for (; i < count; ++i) {
+        total += values[i];
+        squares += values[i] * values[i];
+    }
+    sum_out = total;
+    squares_out = squares;
+}
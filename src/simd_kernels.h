@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Window reductions over contiguous doubles or 32-bit tick counts. Uses
+// AVX2 or NEON when the compiler targets them (e.g. -march=native) and a
+// scalar loop otherwise. The tick kernels are exact and move half the
+// bytes per element of the double ones.
+class SimdKernels {
+public:
+    static double sum(const double* values, size_t count);
+    static uint64_t sum(const uint32_t* values, size_t count);
+    static void min_max(const double* values, size_t count, double& min_out, double& max_out);
+    static void min_max(const uint32_t* values, size_t count, uint32_t& min_out, uint32_t& max_out);
+    static void sum_and_squares(const double* values, size_t count, double& sum_out, double& squares_out);
+};
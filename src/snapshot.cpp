@@ -0,0 +1,103 @@
+#include "snapshot.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NANOEX_HAVE_MMAP 1
+#endif
+
+bool write_snapshot_file(const std::string& path, const SnapshotHeader& header, const std::vector<SnapshotOrder>& orders,
+                         std::string& error) {
+    std::string temp = path + ".tmp";
+    std::FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file) {
+        error = "cannot create " + temp + ": " + std::strerror(errno);
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (orders.empty() || std::fwrite(orders.data(), sizeof(SnapshotOrder), orders.size(), file) == orders.size()) &&
+              std::fflush(file) == 0;
+#ifdef NANOEX_HAVE_MMAP
+    ok = ok && ::fsync(fileno(file)) == 0;
+#endif
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        error = "cannot write " + path + ": " + std::strerror(errno);
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+SnapshotFile::~SnapshotFile() {
+    close();
+}
+
+bool SnapshotFile::open(const std::string& path) {
+    close();
+    const char* bytes = nullptr;
+#ifdef NANOEX_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+        ::close(fd);
+        error_ = path + " is not a snapshot file";
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        error_ = "cannot map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    madvise(data_, size_, MADV_SEQUENTIAL);
+    bytes = static_cast<const char*>(data_);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    size_ = fallback_.size();
+    if (size_ < sizeof(SnapshotHeader)) {
+        error_ = path + " is not a snapshot file";
+        return false;
+    }
+    bytes = fallback_.data();
+#endif
+    std::memcpy(&header_, bytes, sizeof(header_));
+    count_ = static_cast<size_t>(header_.bid_orders + header_.ask_orders);
+    if (header_.magic != SnapshotHeader::MAGIC || header_.version != SnapshotHeader::VERSION ||
+        header_.order_size != sizeof(SnapshotOrder) ||
+        size_ != sizeof(SnapshotHeader) + count_ * sizeof(SnapshotOrder)) {
+        close();
+        error_ = path + " is not a complete snapshot";
+        return false;
+    }
+    orders_ = reinterpret_cast<const SnapshotOrder*>(bytes + sizeof(SnapshotHeader));
+    return true;
+}
+
+void SnapshotFile::close() {
+#ifdef NANOEX_HAVE_MMAP
+    if (data_) munmap(data_, size_);
+#endif
+    data_ = nullptr;
+    fallback_.clear();
+    size_ = 0;
+    header_ = SnapshotHeader();
+    orders_ = nullptr;
+    count_ = 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "order_book.h"
+#include "span.h"
+
+// One resting order in a book snapshot. Orders are stored bids first, then
+// asks, each side best level first and each level in queue order, so
+// re-resting them in file order reproduces time priority exactly.
+struct SnapshotOrder {
+    OrderId order_id;
+    Price price;
+    Quantity quantity;
+    OrderSide side;
+    OrderType type;
+    ParticipantId participant;
+    uint8_t reserved[5];
+
+    static SnapshotOrder from_order(const Order& order) {
+        return SnapshotOrder{order.order_id, order.price, order.quantity, order.side, order.type, order.participant,
+                             {}};
+    }
+};
+
+static_assert(sizeof(SnapshotOrder) == 32, "SnapshotOrder layout is part of the snapshot file format");
+static_assert(std::is_trivially_copyable<SnapshotOrder>::value, "SnapshotOrder must be readable in place");
+
+struct SnapshotHeader {
+    static constexpr uint32_t MAGIC = 0x5353584e;  // "NXSS"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t order_size = sizeof(SnapshotOrder);
+    SymbolId symbol = 0;
+    uint64_t journal_sequence = 0;  // Last journaled command the snapshot includes
+    uint64_t wall_ns = 0;           // When it was taken
+    uint64_t processed_orders = 0;
+    uint64_t matched_trades = 0;
+    uint64_t rejected_orders = 0;
+    uint64_t bid_orders = 0;
+    uint64_t ask_orders = 0;
+};
+
+static_assert(sizeof(SnapshotHeader) == 72, "SnapshotHeader layout is part of the snapshot file format");
+
+// Writes a snapshot to `path` via a temporary file that is synced and then
+// renamed over it, so the file at `path` is always a complete snapshot.
+bool write_snapshot_file(const std::string& path, const SnapshotHeader& header, const std::vector<SnapshotOrder>& orders,
+                         std::string& error);
+
+// Read-only view of a snapshot file; memory-mapped on POSIX, read into
+// memory elsewhere.
+class SnapshotFile {
+public:
+    SnapshotFile() = default;
+    ~SnapshotFile();
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    const SnapshotHeader& header() const { return header_; }
+    Span<SnapshotOrder> orders() const { return Span<SnapshotOrder>(orders_, count_); }
+    const std::string& error() const { return error_; }
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<char> fallback_;
+    SnapshotHeader header_;
+    const SnapshotOrder* orders_ = nullptr;
+    size_t count_ = 0;
+    std::string error_;
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Minimal read-only view over contiguous elements (std::span is C++20).
+template <typename T>
+class Span {
+public:
+    Span() : data_(nullptr), size_(0) {}
+    Span(const T* data, size_t size) : data_(data), size_(size) {}
+    Span(const std::vector<T>& values) : data_(values.data()), size_(values.size()) {}
+
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    Span first(size_t count) const { return Span(data_, count < size_ ? count : size_); }
+    Span last(size_t count) const {
+        size_t n = count < size_ ? count : size_;
+        return Span(data_ + size_ - n, n);
+    }
+private:
+    const T* data_;
+    size_t size_;
+};
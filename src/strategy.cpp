@@ -3,116 +3,123 @@
 #include <sstream>
 #include <iomanip>
 
-StrategyEngine::StrategyEngine() : config() {}
+StrategyCore::StrategyCore(const StrategyConfig& config)
+    : config(config), owned_bank_(std::make_unique<IndicatorBank>()), bank_(owned_bank_.get()),
+      order_ids_(OrderIdGenerator::claim_strategy_source()) {
+    slot_ = bank_->subscribe(config.short_period, config.long_period, config.rsi_period);
+}
 
-StrategyEngine::StrategyEngine(const StrategyConfig& config) : config(config) {}
+StrategyCore::StrategyCore(IndicatorBank& bank, const StrategyConfig& config)
+    : config(config), bank_(&bank), order_ids_(OrderIdGenerator::claim_strategy_source()) {
+    slot_ = bank_->subscribe(config.short_period, config.long_period, config.rsi_period);
+}
 
-void StrategyEngine::set_config(const StrategyConfig& config) {
+void StrategyCore::set_config(const StrategyConfig& config) {
+    bool same_periods = config.short_period == this->config.short_period &&
+                        config.long_period == this->config.long_period &&
+                        config.rsi_period == this->config.rsi_period;
     this->config = config;
+    if (same_periods) return;
+    // Release first, so a slot only this strategy read can take the new periods.
+    bank_->unsubscribe(slot_);
+    slot_ = bank_->subscribe(config.short_period, config.long_period, config.rsi_period);
 }
 
-StrategyConfig StrategyEngine::get_config() const {
+StrategyConfig StrategyCore::get_config() const {
     return config;
 }
 
-std::vector<std::shared_ptr<Order>> StrategyEngine::generate_signals(const std::vector<std::shared_ptr<Order>>& market_orders) {
-    last_signal_type_ = SignalType::HOLD;
-    std::vector<std::shared_ptr<Order>> strategy_orders;
-
+void StrategyCore::update_market_data(const std::vector<std::shared_ptr<Order>>& market_orders) {
     // Update price history from market orders
     for (const auto& order : market_orders) {
         if (order->type == OrderType::MARKET) {
-            price_history.push_back(static_cast<double>(order->price) / 100.0);
-            volume_history.push_back(static_cast<double>(order->quantity));
-            
-            // Keep only recent history (last 1000 data points)
-            if (price_history.size() > 1000) {
-                price_history.pop_front();
-                volume_history.pop_front();
-            }
+            bank_->update(FixedPrice::from_ticks(order->price), FixedQuantity::from_ticks(order->quantity));
         }
     }
-    
-    // Need sufficient price history to generate signals
-    if (price_history.size() < config.long_period) {
-        return strategy_orders;
+}
+
+void StrategyCore::update_market_data(Span<MarketRecord> records) {
+    for (const MarketRecord& record : records) {
+        if (record.is_price_observation()) {
+            bank_->update(FixedPrice::from_ticks(record.price), FixedQuantity::from_ticks(record.quantity));
+        }
     }
+}
+
+size_t StrategyCore::emit_order(const Signal& signal, std::vector<Order>& out) {
+    out.emplace_back();
+    Order& order = out.back();
+    order.order_id = order_ids_.next();
+    order.side = (signal.type == SignalType::BUY) ? OrderSide::BUY : OrderSide::SELL;
+    order.price = double_to_price(signal.price);
+    order.quantity = static_cast<Quantity>(signal.quantity);
+    order.type = OrderType::MARKET; // Strategy orders are market orders
+    order.participant = config.participant;
+
+    last_signal_type_ = signal.type;
+    last_signal_reason_ = signal.reason;
+    last_signal_confidence_ = signal.confidence;
+    last_signal_pnl_pct_ = (signal.type == SignalType::SELL && in_position)
+        ? ((signal.price - entry_price) / entry_price) * 100.0 : 0.0;
+
+    if (signal.type == SignalType::BUY && !in_position) {
+        in_position = true;
+        entry_price = signal.price;
+    } else if (signal.type == SignalType::SELL && in_position) {
+        in_position = false;
+        entry_price = 0.0;
+    }
+
+    return 1;
+}
+
+bool StrategyCore::check_exit(const IndicatorSnapshot& ind, Signal& signal) const {
+    if (!in_position) return false;
+    double pnl_pct = ((ind.price - entry_price) / entry_price) * 100;
     
-    double current_price = price_history.back();
-    double current_volume = volume_history.back();
-    
-    // Generate momentum signal
-    Signal signal = generate_momentum_signal(current_price, current_volume);
+    // Stop loss
+    if (pnl_pct <= -config.stop_loss_pct) {
+        signal.type = SignalType::SELL;
+        signal.confidence = calculate_signal_confidence(ind);
+        signal.reason.kind = SignalReason::Kind::STOP_LOSS;
+        signal.reason.pnl_pct = pnl_pct;
+        return true;
+    }
     
-    // Convert signal to order if it's not HOLD
-    if (signal.type != SignalType::HOLD) {
-        auto order = std::make_shared<Order>();
-        order->order_id = static_cast<OrderId>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::high_resolution_clock::now().time_since_epoch()).count());
-        order->side = (signal.type == SignalType::BUY) ? OrderSide::BUY : OrderSide::SELL;
-        order->price = static_cast<Price>(signal.price * 100); // Convert to integer price
-        order->quantity = static_cast<Quantity>(signal.quantity);
-        order->type = OrderType::MARKET; // Strategy orders are market orders
-        order->timestamp = std::chrono::high_resolution_clock::now();
-        
-        strategy_orders.push_back(order);
-        last_signal_type_ = signal.type;
-        last_signal_reason_ = signal.reason;
-        last_signal_confidence_ = signal.confidence;
-        last_signal_pnl_pct_ = (signal.type == SignalType::SELL && in_position)
-            ? ((signal.price - entry_price) / entry_price) * 100.0 : 0.0;
-
-        if (signal.type == SignalType::BUY && !in_position) {
-            in_position = true;
-            entry_price = signal.price;
-        } else if (signal.type == SignalType::SELL && in_position) {
-            in_position = false;
-            entry_price = 0.0;
-        }
+    // Take profit
+    if (pnl_pct >= config.take_profit_pct) {
+        signal.type = SignalType::SELL;
+        signal.confidence = calculate_signal_confidence(ind);
+        signal.reason.kind = SignalReason::Kind::TAKE_PROFIT;
+        signal.reason.pnl_pct = pnl_pct;
+        return true;
     }
-
-    return strategy_orders;
+    return false;
 }
 
-Signal StrategyEngine::generate_momentum_signal(double current_price, double current_volume) {
+StrategyEngine::StrategyEngine() : StrategyEngine(StrategyConfig()) {}
+
+StrategyEngine::StrategyEngine(const StrategyConfig& config) : StrategyBase(config) {}
+
+StrategyEngine::StrategyEngine(IndicatorBank& bank, const StrategyConfig& config) : StrategyBase(bank, config) {}
+
+Signal StrategyEngine::evaluate(const IndicatorSnapshot& ind) const {
+    double current_price = ind.price;
     Signal signal;
     signal.price = current_price;
     signal.quantity = config.position_size;
-    signal.confidence = calculate_signal_confidence(current_price);
-    signal.reason = generate_signal_reason(current_price);
-    
-    // Calculate key indicators
-    double momentum_score = Indicators::momentum_score(price_history, config.short_period, config.long_period);
-    double rsi = Indicators::relative_strength_index(price_history, config.rsi_period);
-    auto [macd_line, signal_line] = Indicators::macd(price_history, 12, 26, 9);
-    double price_change = Indicators::price_change_percent(price_history, config.short_period);
+    signal.confidence = 0.0;
     
     // Check for stop loss or take profit if in position
-    if (in_position) {
-        double pnl_pct = ((current_price - entry_price) / entry_price) * 100;
-        
-        // Stop loss
-        if (pnl_pct <= -config.stop_loss_pct) {
-            signal.type = SignalType::SELL;
-            signal.reason = "Stop Loss triggered (" + std::to_string(pnl_pct) + "%)";
-            return signal;
-        }
-        
-        // Take profit
-        if (pnl_pct >= config.take_profit_pct) {
-            signal.type = SignalType::SELL;
-            signal.reason = "Take Profit triggered (" + std::to_string(pnl_pct) + "%)";
-            return signal;
-        }
-    }
+    if (check_exit(ind, signal)) return signal;
     
     // Momentum strategy logic
     if (!in_position) {
         // BUY conditions
-        bool strong_momentum = momentum_score > config.momentum_threshold;
-        bool rsi_not_overbought = rsi < config.rsi_overbought;
-        bool macd_bullish = macd_line > signal_line;
-        bool price_above_ma = current_price > Indicators::simple_moving_average(price_history, config.short_period);
+        bool strong_momentum = ind.momentum_score > config.momentum_threshold;
+        bool rsi_not_overbought = ind.rsi < config.rsi_overbought;
+        bool macd_bullish = ind.macd_line > ind.signal_line;
+        bool price_above_ma = current_price > ind.short_sma;
         
         if (strong_momentum && rsi_not_overbought && macd_bullish && price_above_ma) {
             signal.type = SignalType::BUY;
@@ -121,10 +128,10 @@ Signal StrategyEngine::generate_momentum_signal(double current_price, double cur
         }
     } else {
         // SELL conditions
-        bool momentum_weakening = momentum_score < 0.0;
-        bool rsi_overbought = rsi > config.rsi_overbought;
-        bool macd_bearish = macd_line < signal_line;
-        bool price_below_ma = current_price < Indicators::simple_moving_average(price_history, config.short_period);
+        bool momentum_weakening = ind.momentum_score < 0.0;
+        bool rsi_overbought = ind.rsi > config.rsi_overbought;
+        bool macd_bearish = ind.macd_line < ind.signal_line;
+        bool price_below_ma = current_price < ind.short_sma;
         
         if (momentum_weakening || rsi_overbought || macd_bearish || price_below_ma) {
             signal.type = SignalType::SELL;
@@ -133,41 +140,69 @@ Signal StrategyEngine::generate_momentum_signal(double current_price, double cur
         }
     }
     
+    // Confidence and reason are only needed once the signal will be acted on.
+    if (signal.type != SignalType::HOLD) {
+        signal.confidence = calculate_signal_confidence(ind);
+        signal.reason = generate_signal_reason(ind);
+    }
     return signal;
 }
 
-double StrategyEngine::calculate_signal_confidence(double current_price) {
-    if (price_history.size() < config.long_period) return 0.0;
-    
-    double momentum_score = Indicators::momentum_score(price_history, config.short_period, config.long_period);
-    double rsi = Indicators::relative_strength_index(price_history, config.rsi_period);
-    auto [macd_line, signal_line] = Indicators::macd(price_history, 12, 26, 9);
+double StrategyCore::calculate_signal_confidence(const IndicatorSnapshot& ind) const {
+    if (!ready()) return 0.0;
     
     // Normalize indicators to [0, 1] range
-    double momentum_norm = std::abs(momentum_score);
-    double rsi_norm = (rsi > 50) ? (rsi - 50) / 50 : (50 - rsi) / 50;
-    double macd_norm = std::abs(macd_line - signal_line) / std::max(std::abs(macd_line), 1.0);
+    double momentum_norm = std::abs(ind.momentum_score);
+    double rsi_norm = (ind.rsi > 50) ? (ind.rsi - 50) / 50 : (50 - ind.rsi) / 50;
+    double macd_norm = std::abs(ind.macd_line - ind.signal_line) / std::max(std::abs(ind.macd_line), 1.0);
     
     // Weighted average of confidence factors
     double confidence = (momentum_norm * 0.4 + rsi_norm * 0.3 + macd_norm * 0.3);
     return std::min(confidence, 1.0);
 }
 
-std::string StrategyEngine::generate_signal_reason(double current_price) {
-    if (price_history.size() < config.long_period) return "Insufficient data";
+SignalReason StrategyCore::generate_signal_reason(const IndicatorSnapshot& ind) const {
+    SignalReason reason;
+    if (!ready()) {
+        reason.kind = SignalReason::Kind::INSUFFICIENT_DATA;
+        return reason;
+    }
+    reason.kind = SignalReason::Kind::INDICATORS;
+    reason.momentum_score = ind.momentum_score;
+    reason.rsi = ind.rsi;
+    reason.macd_bullish = ind.macd_line > ind.signal_line;
+    reason.price_above_ma = ind.price > ind.short_sma;
+    reason.short_sma = ind.short_sma;
+    reason.long_sma = ind.long_sma;
+    return reason;
+}
+
+std::string SignalReason::to_string() const {
+    switch (kind) {
+    case Kind::NONE:
+        return "";
+    case Kind::INSUFFICIENT_DATA:
+        return "Insufficient data";
+    case Kind::STOP_LOSS:
+        return "Stop Loss triggered (" + std::to_string(pnl_pct) + "%)";
+    case Kind::TAKE_PROFIT:
+        return "Take Profit triggered (" + std::to_string(pnl_pct) + "%)";
+    case Kind::INDICATORS:
+    case Kind::REVERSION:
+        break;
+    }
     
     std::ostringstream reason;
-    double momentum_score = Indicators::momentum_score(price_history, config.short_period, config.long_period);
-    double rsi = Indicators::relative_strength_index(price_history, config.rsi_period);
-    auto [macd_line, signal_line] = Indicators::macd(price_history, 12, 26, 9);
-    double short_ma = Indicators::simple_moving_average(price_history, config.short_period);
-    double long_ma = Indicators::simple_moving_average(price_history, config.long_period);
-    
+    if (kind == Kind::REVERSION) {
+        reason << "Reversion: " << std::fixed << std::setprecision(2) << deviation_pct
+               << "% from MA (" << long_sma << "), RSI: " << rsi;
+        return reason.str();
+    }
     reason << "Momentum: " << std::fixed << std::setprecision(2) << momentum_score
            << ", RSI: " << rsi
-           << ", MACD: " << (macd_line > signal_line ? "Bullish" : "Bearish")
-           << ", Price vs MA: " << (current_price > short_ma ? "Above" : "Below")
-           << " (" << short_ma << " vs " << long_ma << ")";
+           << ", MACD: " << (macd_bullish ? "Bullish" : "Bearish")
+           << ", Price vs MA: " << (price_above_ma ? "Above" : "Below")
+           << " (" << short_sma << " vs " << long_sma << ")";
     
     return reason.str();
-} 
\ No newline at end of file
+}
@@ -1,10 +1,13 @@
 #pragma once
 #include <vector>
 #include <memory>
-#include <deque>
 #include <string>
+#include <tuple>
+#include <utility>
 #include "order_book.h"
 #include "indicators.h"
+#include "market_record.h"
+#include "order_id.h"
 
 enum class SignalType {
     BUY,
@@ -22,39 +25,48 @@ struct StrategyConfig {
     double position_size = 100.0;         // Default position size
     double stop_loss_pct = 2.0;           // Stop loss percentage
     double take_profit_pct = 5.0;         // Take profit percentage
+    double reversion_threshold_pct = 0.5; // Mean reversion: % below long MA to buy
+    ParticipantId participant = 1;        // Owner stamped on every order (self-trade checks, fill routing)
+};
+
+// Why a signal fired, kept as raw values so the hot path never formats
+// text. to_string() renders it on demand for logging.
+struct SignalReason {
+    enum class Kind {
+        NONE,
+        INSUFFICIENT_DATA,
+        INDICATORS,
+        REVERSION,
+        STOP_LOSS,
+        TAKE_PROFIT
+    };
+    Kind kind = Kind::NONE;
+    double momentum_score = 0.0;
+    double rsi = 0.0;
+    bool macd_bullish = false;
+    bool price_above_ma = false;
+    double short_sma = 0.0;
+    double long_sma = 0.0;
+    double deviation_pct = 0.0;  // Price vs long MA, for REVERSION
+    double pnl_pct = 0.0;
+
+    std::string to_string() const;
 };
 
 struct Signal {
     SignalType type;
     double price;
     double quantity;
-    std::string reason;
+    SignalReason reason;
     double confidence;
 };
 
-class StrategyEngine {
-private:
-    StrategyConfig config;
-    std::deque<double> price_history;
-    std::deque<double> volume_history;
-    double last_signal_price = 0.0;
-    bool in_position = false;
-    double entry_price = 0.0;
-    SignalType last_signal_type_ = SignalType::HOLD;
-    std::string last_signal_reason_;
-    double last_signal_confidence_ = 0.0;
-    double last_signal_pnl_pct_ = 0.0;
-
-    Signal generate_momentum_signal(double current_price, double current_volume);
-    double calculate_signal_confidence(double current_price);
-    std::string generate_signal_reason(double current_price);
-
+// State and plumbing shared by every strategy: configuration, the
+// indicator slot it reads, position tracking and order emission. A
+// strategy either owns a private IndicatorBank or reads one shared with
+// other strategies on the same feed.
+class StrategyCore {
 public:
-    StrategyEngine();
-    StrategyEngine(const StrategyConfig& config);
-    
-    std::vector<std::shared_ptr<Order>> generate_signals(const std::vector<std::shared_ptr<Order>>& market_orders);
-    
     // Strategy configuration
     void set_config(const StrategyConfig& config);
     StrategyConfig get_config() const;
@@ -62,14 +74,149 @@ public:
     // Strategy state
     bool is_in_position() const { return in_position; }
     double get_entry_price() const { return entry_price; }
-    size_t get_price_history_size() const { return price_history.size(); }
+    size_t get_price_history_size() const { return bank_->history_size(); }
     
     // Performance tracking
     void reset_position() { in_position = false; entry_price = 0.0; }
 
     // Last signal metadata for logging (set by generate_signals when order is produced)
     SignalType get_last_signal_type() const { return last_signal_type_; }
-    const std::string& get_last_signal_reason() const { return last_signal_reason_; }
+    const SignalReason& get_last_signal_reason() const { return last_signal_reason_; }
     double get_last_signal_confidence() const { return last_signal_confidence_; }
     double get_last_signal_pnl_pct() const { return last_signal_pnl_pct_; }
-}; 
\ No newline at end of file
+    // Indicator values as of the last processed batch.
+    const IndicatorSnapshot& get_indicators() const { return indicators(); }
+
+protected:
+    explicit StrategyCore(const StrategyConfig& config);
+    StrategyCore(IndicatorBank& bank, const StrategyConfig& config);
+
+    StrategyConfig config;
+    bool in_position = false;
+    double entry_price = 0.0;
+
+    bool ready() const { return bank_->history_size() >= config.long_period; }
+    const IndicatorSnapshot& indicators() const { return bank_->snapshot(slot_); }
+    void update_market_data(const std::vector<std::shared_ptr<Order>>& market_orders);
+    void update_market_data(Span<MarketRecord> records);
+    void begin_batch() { last_signal_type_ = SignalType::HOLD; }
+    // Stop loss / take profit on an open position; fills `signal` and
+    // returns true if one triggered.
+    bool check_exit(const IndicatorSnapshot& ind, Signal& signal) const;
+    double calculate_signal_confidence(const IndicatorSnapshot& ind) const;
+    SignalReason generate_signal_reason(const IndicatorSnapshot& ind) const;
+    size_t emit_order(const Signal& signal, std::vector<Order>& out);
+
+private:
+    std::unique_ptr<IndicatorBank> owned_bank_;
+    IndicatorBank* bank_;
+    OrderIdGenerator order_ids_;
+    size_t slot_ = 0;
+    SignalType last_signal_type_ = SignalType::HOLD;
+    SignalReason last_signal_reason_;
+    double last_signal_confidence_ = 0.0;
+    double last_signal_pnl_pct_ = 0.0;
+};
+
+// CRTP front end: Derived supplies `Signal evaluate(const IndicatorSnapshot&)`
+// and the call is resolved at compile time, so running many strategies
+// costs no virtual dispatch.
+template <typename Derived>
+class StrategyBase : public StrategyCore {
+public:
+    // Appends any strategy orders to `out` and returns how many were added.
+    // `out` is the caller's to reuse across batches; a HOLD batch touches
+    // nothing but the indicators. For a strategy on a shared bank, feed the
+    // bank once (see StrategyGroup) and call on_tick instead.
+    size_t generate_signals(const std::vector<std::shared_ptr<Order>>& market_orders, std::vector<Order>& out) {
+        update_market_data(market_orders);
+        return on_tick(out);
+    }
+    // Same, for replayed capture records read in place.
+    size_t generate_signals(Span<MarketRecord> records, std::vector<Order>& out) {
+        update_market_data(records);
+        return on_tick(out);
+    }
+
+    // Evaluates the strategy against the bank's current indicators.
+    size_t on_tick(std::vector<Order>& out) {
+        begin_batch();
+        // Need sufficient price history to generate signals
+        if (!ready()) return 0;
+        Signal signal = static_cast<Derived&>(*this).evaluate(indicators());
+        if (signal.type == SignalType::HOLD) return 0;
+        return emit_order(signal, out);
+    }
+
+protected:
+    using StrategyCore::StrategyCore;
+};
+
+// Momentum strategy: trend and MACD confirmation to enter, any sign of
+// weakening to exit.
+class StrategyEngine : public StrategyBase<StrategyEngine> {
+public:
+    StrategyEngine();
+    explicit StrategyEngine(const StrategyConfig& config);
+    StrategyEngine(IndicatorBank& bank, const StrategyConfig& config);
+
+    Signal evaluate(const IndicatorSnapshot& ind) const;
+};
+
+using MomentumStrategy = StrategyEngine;
+
+// Runs a fixed set of strategies over one market-data stream. The shared
+// IndicatorBank is fed once per batch, then each strategy is evaluated in
+// order; the set is a tuple, so every call is statically dispatched.
+template <typename... Strategies>
+class StrategyGroup {
+    template <typename>
+    using ConfigFor = StrategyConfig;
+public:
+    explicit StrategyGroup(const ConfigFor<Strategies>&... configs)
+        : strategies_(Strategies(bank_, configs)...) {}
+    StrategyGroup(const StrategyGroup&) = delete;
+    StrategyGroup& operator=(const StrategyGroup&) = delete;
+
+    // Appends every strategy's orders to `out`; returns how many were added.
+    size_t generate_signals(const std::vector<std::shared_ptr<Order>>& market_orders, std::vector<Order>& out) {
+        for (const auto& order : market_orders) {
+            if (order->type == OrderType::MARKET) {
+                bank_.update(FixedPrice::from_ticks(order->price), FixedQuantity::from_ticks(order->quantity));
+            }
+        }
+        return evaluate_all(out);
+    }
+    size_t generate_signals(Span<MarketRecord> records, std::vector<Order>& out) {
+        for (const MarketRecord& record : records) {
+            if (record.is_price_observation()) {
+                bank_.update(FixedPrice::from_ticks(record.price), FixedQuantity::from_ticks(record.quantity));
+            }
+        }
+        return evaluate_all(out);
+    }
+
+    template <typename F>
+    void for_each(F&& fn) { for_each_impl(fn, std::index_sequence_for<Strategies...>()); }
+
+    template <size_t I>
+    auto& get() { return std::get<I>(strategies_); }
+    template <size_t I>
+    const auto& get() const { return std::get<I>(strategies_); }
+
+    const IndicatorBank& bank() const { return bank_; }
+    static constexpr size_t size() { return sizeof...(Strategies); }
+private:
+    IndicatorBank bank_;
+    std::tuple<Strategies...> strategies_;
+
+    size_t evaluate_all(std::vector<Order>& out) {
+        size_t added = 0;
+        for_each([&](auto& strategy) { added += strategy.on_tick(out); });
+        return added;
+    }
+    template <typename F, size_t... I>
+    void for_each_impl(F& fn, std::index_sequence<I...>) {
+        (fn(std::get<I>(strategies_)), ...);
+    }
+};
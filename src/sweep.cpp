@@ -0,0 +1,211 @@
+#include "sweep.h"
+#include "threading.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+namespace {
+
+struct SweepField {
+    const char* name;
+    double StrategyConfig::*real;
+    size_t StrategyConfig::*count;
+};
+
+const SweepField SWEEP_FIELDS[] = {
+    {"momentum_threshold", &StrategyConfig::momentum_threshold, nullptr},
+    {"rsi_oversold", &StrategyConfig::rsi_oversold, nullptr},
+    {"rsi_overbought", &StrategyConfig::rsi_overbought, nullptr},
+    {"short_period", nullptr, &StrategyConfig::short_period},
+    {"long_period", nullptr, &StrategyConfig::long_period},
+    {"rsi_period", nullptr, &StrategyConfig::rsi_period},
+    {"position_size", &StrategyConfig::position_size, nullptr},
+    {"stop_loss_pct", &StrategyConfig::stop_loss_pct, nullptr},
+    {"take_profit_pct", &StrategyConfig::take_profit_pct, nullptr},
+    {"reversion_threshold_pct", &StrategyConfig::reversion_threshold_pct, nullptr},
+};
+
+const SweepField* find_field(const std::string& name) {
+    for (const SweepField& field : SWEEP_FIELDS) {
+        if (name == field.name) return &field;
+    }
+    return nullptr;
+}
+
+bool parse_number(const std::string& text, double& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    out = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size() && std::isfinite(out);
+}
+
+bool usable(const StrategyConfig& config) {
+    return config.short_period > 0 && config.rsi_period > 0 && config.short_period < config.long_period;
+}
+
+double win_rate(const BacktestResult& r) {
+    return r.round_trips > 0 ? static_cast<double>(r.winning_trips) / r.round_trips : 0.0;
+}
+
+}  // namespace
+
+bool SweepParameter::parse(const std::string& spec, SweepParameter& out, std::string& error) {
+    size_t eq = spec.find('=');
+    out = SweepParameter();
+    out.name = spec.substr(0, eq);
+    if (eq == std::string::npos || !find_field(out.name)) {
+        error = "unknown sweep field in '" + spec + "'";
+        return false;
+    }
+    std::string values = spec.substr(eq + 1);
+    size_t colon = values.find(':');
+    if (colon != std::string::npos) {
+        size_t second = values.find(':', colon + 1);
+        double lo, hi, step;
+        if (second == std::string::npos || !parse_number(values.substr(0, colon), lo) ||
+            !parse_number(values.substr(colon + 1, second - colon - 1), hi) ||
+            !parse_number(values.substr(second + 1), step) || step <= 0 || hi < lo) {
+            error = "expected lo:hi:step in '" + spec + "'";
+            return false;
+        }
+        // Count steps rather than accumulate, so the end point is not lost
+        // to rounding.
+        size_t steps = static_cast<size_t>(std::floor((hi - lo) / step + 1e-9));
+        for (size_t i = 0; i <= steps; ++i) out.values.push_back(lo + step * i);
+        return true;
+    }
+    size_t start = 0;
+    while (start <= values.size()) {
+        size_t comma = values.find(',', start);
+        if (comma == std::string::npos) comma = values.size();
+        double value;
+        if (!parse_number(values.substr(start, comma - start), value)) {
+            error = "bad value list in '" + spec + "'";
+            return false;
+        }
+        out.values.push_back(value);
+        start = comma + 1;
+    }
+    return true;
+}
+
+const std::vector<std::string>& sweep_field_names() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> out;
+        for (const SweepField& field : SWEEP_FIELDS) out.push_back(field.name);
+        return out;
+    }();
+    return names;
+}
+
+bool set_sweep_field(StrategyConfig& config, const std::string& name, double value) {
+    const SweepField* field = find_field(name);
+    if (!field) return false;
+    if (field->real) {
+        config.*(field->real) = value;
+    } else {
+        config.*(field->count) = static_cast<size_t>(std::llround(std::max(value, 0.0)));
+    }
+    return true;
+}
+
+double get_sweep_field(const StrategyConfig& config, const std::string& name) {
+    const SweepField* field = find_field(name);
+    if (!field) return 0.0;
+    return field->real ? config.*(field->real) : static_cast<double>(config.*(field->count));
+}
+
+std::vector<StrategyConfig> SweepSpace::grid() const {
+    std::vector<StrategyConfig> out;
+    std::vector<size_t> digits(parameters_.size(), 0);
+    for (const SweepParameter& parameter : parameters_) {
+        if (parameter.values.empty()) return out;
+    }
+    for (;;) {
+        StrategyConfig config = base_;
+        for (size_t i = 0; i < parameters_.size(); ++i) {
+            set_sweep_field(config, parameters_[i].name, parameters_[i].values[digits[i]]);
+        }
+        if (usable(config)) out.push_back(config);
+        // Odometer step, last parameter fastest.
+        size_t i = parameters_.size();
+        while (i > 0 && ++digits[i - 1] == parameters_[i - 1].values.size()) digits[--i] = 0;
+        if (i == 0) break;
+    }
+    return out;
+}
+
+std::vector<StrategyConfig> SweepSpace::sample(size_t count, uint64_t seed) const {
+    std::mt19937_64 rng(seed * 0x9e3779b97f4a7c15ULL + 1);
+    std::vector<StrategyConfig> out;
+    out.reserve(count);
+    // Bounded, so a space with no usable point cannot spin forever.
+    for (size_t attempts = 0; out.size() < count && attempts < count * 100 + 100; ++attempts) {
+        StrategyConfig config = base_;
+        for (const SweepParameter& parameter : parameters_) {
+            if (parameter.values.empty()) continue;
+            auto [lo, hi] = std::minmax_element(parameter.values.begin(), parameter.values.end());
+            double value;
+            if (find_field(parameter.name)->count) {
+                std::uniform_int_distribution<long long> pick(std::llround(*lo), std::llround(*hi));
+                value = static_cast<double>(pick(rng));
+            } else {
+                value = std::uniform_real_distribution<double>(*lo, *hi)(rng);
+            }
+            set_sweep_field(config, parameter.name, value);
+        }
+        if (usable(config)) out.push_back(config);
+    }
+    return out;
+}
+
+std::vector<SweepResult> run_sweep(const BacktestConfig& base, const std::vector<StrategyConfig>& configs,
+                                   Span<MarketRecord> records, const SweepOptions& options) {
+    std::vector<SweepResult> results(configs.size());
+    size_t threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, configs.size()));
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    auto worker = [&](size_t id) {
+        if (options.pin) pin_current_thread(static_cast<int>(id));
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < configs.size();
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            BacktestConfig config = base;
+            config.strategy = configs[i];
+            SweepResult& slot = results[i];
+            slot.index = i;
+            slot.config = configs[i];
+            slot.result = Backtester(config).run(records);
+            size_t finished = done.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (options.progress) options.progress(finished, configs.size());
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t id = 0; id < threads; ++id) pool.emplace_back(worker, id);
+    for (std::thread& thread : pool) thread.join();
+    return results;
+}
+
+void rank_sweep_results(std::vector<SweepResult>& results, SweepRank rank) {
+    auto better = [rank](const SweepResult& a, const SweepResult& b) {
+        const BacktestResult& x = a.result;
+        const BacktestResult& y = b.result;
+        switch (rank) {
+        case SweepRank::DRAWDOWN:
+            if (x.max_drawdown != y.max_drawdown) return x.max_drawdown < y.max_drawdown;
+            return x.total_pnl > y.total_pnl;
+        case SweepRank::WIN_RATE:
+            if (win_rate(x) != win_rate(y)) return win_rate(x) > win_rate(y);
+            return x.total_pnl > y.total_pnl;
+        case SweepRank::TOTAL_PNL:
+        default:
+            if (x.total_pnl != y.total_pnl) return x.total_pnl > y.total_pnl;
+            return x.max_drawdown < y.max_drawdown;
+        }
+    };
+    // Stable, so equal runs stay in config order.
+    std::stable_sort(results.begin(), results.end(), better);
+}
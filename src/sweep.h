@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "backtester.h"
+
+// One StrategyConfig field and the values a sweep tries for it.
+struct SweepParameter {
+    std::string name;            // StrategyConfig field, e.g. "short_period"
+    std::vector<double> values;  // Grid points; a random search samples [min, max]
+
+    // Parses "name=a,b,c" or "name=lo:hi:step" (inclusive). Returns false
+    // on an unknown field or malformed values.
+    static bool parse(const std::string& spec, SweepParameter& out, std::string& error);
+};
+
+// The StrategyConfig fields a sweep can vary, by name.
+const std::vector<std::string>& sweep_field_names();
+// Sets field `name` of `config`; integer fields are rounded. False if
+// `name` is not a sweepable field.
+bool set_sweep_field(StrategyConfig& config, const std::string& name, double value);
+double get_sweep_field(const StrategyConfig& config, const std::string& name);
+
+// Search space over a base config. Combinations whose short period is not
+// below the long period are skipped.
+class SweepSpace {
+public:
+    explicit SweepSpace(const StrategyConfig& base = StrategyConfig()) : base_(base) {}
+
+    void add(const SweepParameter& parameter) { parameters_.push_back(parameter); }
+    const std::vector<SweepParameter>& parameters() const { return parameters_; }
+
+    // Every combination of the parameters' values, the first parameter
+    // varying slowest.
+    std::vector<StrategyConfig> grid() const;
+    // `count` configs with each parameter drawn uniformly from its range;
+    // integer fields draw integers. Deterministic for a given seed.
+    std::vector<StrategyConfig> sample(size_t count, uint64_t seed) const;
+private:
+    StrategyConfig base_;
+    std::vector<SweepParameter> parameters_;
+};
+
+struct SweepResult {
+    size_t index = 0;  // Position in the config list
+    StrategyConfig config;
+    BacktestResult result;
+};
+
+enum class SweepRank {
+    TOTAL_PNL,    // Highest total P&L first, smaller drawdown on ties
+    DRAWDOWN,     // Smallest max drawdown first, higher P&L on ties
+    WIN_RATE      // Highest share of winning round trips first
+};
+
+struct SweepOptions {
+    size_t threads = 0;  // 0 = one per hardware thread
+    bool pin = false;    // Pin worker i to CPU i
+    // Called on the worker that finished a run, with the number done so
+    // far; must be thread-safe.
+    std::function<void(size_t done, size_t total)> progress;
+};
+
+// Runs one independent backtest per config in parallel. Every worker reads
+// the same records (typically a CaptureFile mapping, shared read-only) and
+// builds its own engine, strategy and risk state, so runs share nothing
+// mutable; workers claim the next config from an atomic cursor, which
+// keeps uneven run times balanced. `base` supplies everything but the
+// strategy config. Results come back in config order.
+std::vector<SweepResult> run_sweep(const BacktestConfig& base, const std::vector<StrategyConfig>& configs,
+                                   Span<MarketRecord> records, const SweepOptions& options = SweepOptions());
+
+// Sorts `results` best first.
+void rank_sweep_results(std::vector<SweepResult>& results, SweepRank rank);
@@ -0,0 +1,226 @@
+// Sweeps StrategyConfig parameters over recorded market data, one backtest
+// per config on every core, and prints the best configs.
+//
+//   sweep <capture> | <tick store> [--from <unix ns>] [--to <unix ns>]
+//         | --synthetic <records> [--rate <msgs/s>] [--seed <n>]
+//         --param <field>=<lo>:<hi>:<step> | --param <field>=<a>,<b>,...  (repeatable)
+//         [--random <configs> [--sample-seed <n>]] [--threads <n>] [--pin]
+//         [--rank pnl|drawdown|winrate] [--top <n>] [--csv <file>]
+//         [--strategy momentum|reversion] [--batch <records>] [--latency-us <us>]
+//
+// Without --random every combination of the --param values is run; with it,
+// that many configs are drawn uniformly from each parameter's range.
+#include "sweep.h"
+#include "load_generator.h"
+#include "replay.h"
+#include "tick_store.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+void print_usage(const char* program) {
+    std::cerr << "usage: " << program << " <capture> | <tick store> [--from <ns>] [--to <ns>]"
+              << " | --synthetic <records> [--rate <msgs/s>] [--seed <n>]"
+              << " --param <field>=<lo>:<hi>:<step>|<a>,<b>,... [--random <configs> [--sample-seed <n>]]"
+              << " [--threads <n>] [--pin] [--rank pnl|drawdown|winrate] [--top <n>] [--csv <file>]"
+              << " [--strategy momentum|reversion] [--batch <n>] [--latency-us <us>]\n"
+              << "fields:";
+    for (const std::string& name : sweep_field_names()) std::cerr << " " << name;
+    std::cerr << "\n";
+}
+
+void print_table(const std::vector<SweepResult>& results, const std::vector<SweepParameter>& parameters,
+                 size_t top) {
+    std::cout << std::right << std::setw(5) << "rank";
+    for (const SweepParameter& parameter : parameters) {
+        std::cout << " " << std::setw(std::max<int>(10, static_cast<int>(parameter.name.size()))) << parameter.name;
+    }
+    std::cout << std::setw(12) << "total_pnl" << std::setw(12) << "realized" << std::setw(12) << "drawdown"
+              << std::setw(8) << "trips" << std::setw(7) << "win%" << std::setw(9) << "fills" << "\n";
+    for (size_t i = 0; i < std::min(top, results.size()); ++i) {
+        const SweepResult& entry = results[i];
+        const BacktestResult& r = entry.result;
+        std::cout << std::setw(5) << (i + 1) << std::defaultfloat << std::setprecision(6);
+        for (const SweepParameter& parameter : parameters) {
+            std::cout << " " << std::setw(std::max<int>(10, static_cast<int>(parameter.name.size())))
+                      << get_sweep_field(entry.config, parameter.name);
+        }
+        double win = r.round_trips > 0 ? 100.0 * r.winning_trips / r.round_trips : 0.0;
+        std::cout << std::fixed << std::setprecision(2) << std::setw(12) << r.total_pnl << std::setw(12)
+                  << r.realized_pnl << std::setw(12) << r.max_drawdown << std::setw(8) << r.round_trips
+                  << std::setprecision(1) << std::setw(7) << win << std::setw(9) << r.fills << "\n";
+    }
+}
+
+bool write_csv(const std::string& path, const std::vector<SweepResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    for (const std::string& name : sweep_field_names()) out << name << ",";
+    out << "total_pnl,realized_pnl,max_drawdown,position,round_trips,winning_trips,signals,risk_rejected,"
+           "fills,filled_quantity,unfilled_quantity,wall_seconds\n";
+    out << std::setprecision(10);
+    for (const SweepResult& entry : results) {
+        const BacktestResult& r = entry.result;
+        for (const std::string& name : sweep_field_names()) out << get_sweep_field(entry.config, name) << ",";
+        out << r.total_pnl << "," << r.realized_pnl << "," << r.max_drawdown << "," << r.position << ","
+            << r.round_trips << "," << r.winning_trips << "," << r.signals << "," << r.risk_rejected << ","
+            << r.fills << "," << r.filled_quantity << "," << r.unfilled_quantity << "," << r.wall_seconds << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    std::string csv_path;
+    size_t synthetic = 0;
+    double rate = 1e6;
+    uint64_t seed = 1;
+    uint64_t from_ns = 0;
+    uint64_t to_ns = UINT64_MAX;
+    size_t random = 0;
+    uint64_t sample_seed = 1;
+    size_t top = 20;
+    SweepRank rank = SweepRank::TOTAL_PNL;
+    SweepOptions options;
+    BacktestConfig base;
+    base.engine.ladder_levels = 1024;
+    std::vector<SweepParameter> parameters;
+    bool bad_args = false;
+    for (int i = 1; i < argc && !bad_args; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--param" && has_value) {
+            SweepParameter parameter;
+            std::string error;
+            if (!SweepParameter::parse(argv[++i], parameter, error)) {
+                std::cerr << error << "\n";
+                bad_args = true;
+            }
+            parameters.push_back(parameter);
+        } else if (arg == "--synthetic" && has_value) {
+            synthetic = std::stoul(argv[++i]);
+        } else if (arg == "--from" && has_value) {
+            from_ns = std::stoull(argv[++i]);
+        } else if (arg == "--to" && has_value) {
+            to_ns = std::stoull(argv[++i]);
+        } else if (arg == "--rate" && has_value) {
+            rate = std::stod(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            seed = std::stoull(argv[++i]);
+        } else if (arg == "--random" && has_value) {
+            random = std::stoul(argv[++i]);
+        } else if (arg == "--sample-seed" && has_value) {
+            sample_seed = std::stoull(argv[++i]);
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::stoul(argv[++i]);
+        } else if (arg == "--pin") {
+            options.pin = true;
+        } else if (arg == "--rank" && has_value) {
+            std::string key = argv[++i];
+            if (key == "pnl") {
+                rank = SweepRank::TOTAL_PNL;
+            } else if (key == "drawdown") {
+                rank = SweepRank::DRAWDOWN;
+            } else if (key == "winrate") {
+                rank = SweepRank::WIN_RATE;
+            } else {
+                bad_args = true;
+            }
+        } else if (arg == "--top" && has_value) {
+            top = std::stoul(argv[++i]);
+        } else if (arg == "--csv" && has_value) {
+            csv_path = argv[++i];
+        } else if (arg == "--strategy" && has_value) {
+            std::string kind = argv[++i];
+            if (kind == "momentum") {
+                base.strategy_kind = BacktestStrategy::MOMENTUM;
+            } else if (kind == "reversion") {
+                base.strategy_kind = BacktestStrategy::MEAN_REVERSION;
+            } else {
+                bad_args = true;
+            }
+        } else if (arg == "--batch" && has_value) {
+            base.batch_size = std::stoul(argv[++i]);
+        } else if (arg == "--latency-us" && has_value) {
+            base.order_latency_ns = static_cast<uint64_t>(std::stod(argv[++i]) * 1000);
+        } else if (path.empty() && arg.rfind("--", 0) != 0) {
+            path = arg;
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args || parameters.empty() || (path.empty() == (synthetic == 0)) || rate <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    CaptureFile capture;
+    std::vector<MarketRecord> generated;
+    Span<MarketRecord> records;
+    if (synthetic > 0) {
+        LoadConfig load;
+        load.stream_length = synthetic;
+        load.seed = seed;
+        generated = LoadGenerator(load).generate(0);
+        double spacing_ns = 1e9 / rate;
+        for (size_t i = 0; i < generated.size(); ++i) {
+            generated[i].timestamp_ns = static_cast<uint64_t>(i * spacing_ns);
+        }
+        records = Span<MarketRecord>(generated);
+    } else if (TickStoreFile::is_tick_store(path)) {
+        TickStoreFile store;
+        if (!store.open(path) || !store.read_range(from_ns, to_ns, generated)) {
+            std::cerr << store.error() << "\n";
+            return 1;
+        }
+        records = Span<MarketRecord>(generated);
+    } else {
+        if (!capture.open(path)) {
+            std::cerr << capture.error() << "\n";
+            return 1;
+        }
+        records = capture.records();
+    }
+
+    SweepSpace space(base.strategy);
+    for (const SweepParameter& parameter : parameters) space.add(parameter);
+    std::vector<StrategyConfig> configs = random > 0 ? space.sample(random, sample_seed) : space.grid();
+    if (configs.empty()) {
+        std::cerr << "no usable configs (short_period must be below long_period)\n";
+        return 1;
+    }
+    std::cout << "Sweeping " << configs.size() << " configs over " << records.size() << " records\n";
+
+    std::mutex progress_mutex;
+    size_t step = std::max<size_t>(1, configs.size() / 20);
+    options.progress = [&](size_t done, size_t total) {
+        if (done % step != 0 && done != total) return;
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        std::cerr << "\r  " << done << "/" << total << std::flush;
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SweepResult> results = run_sweep(base, configs, records, options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "\n";
+
+    uint64_t events = 0;
+    for (const SweepResult& entry : results) events += entry.result.records;
+    std::cout << "Ran " << results.size() << " backtests in " << std::fixed << std::setprecision(2) << seconds
+              << "s (" << std::setprecision(1) << (results.size() / seconds) << " configs/s, "
+              << (events / seconds / 1e6) << "M events/s)\n";
+    rank_sweep_results(results, rank);
+    print_table(results, parameters, top);
+    if (!csv_path.empty() && !write_csv(csv_path, results)) {
+        std::cerr << "cannot write " << csv_path << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "telemetry.h"
+#include "tsc_clock.h"
+
+bool TelemetryPublisher::open(const std::string& name, size_t capacity) {
+    return ring_.create(name, capacity);
+}
+
+TelemetryEvent TelemetryPublisher::start(TelemetryEvent::Kind kind) const {
+    TelemetryEvent event{};
+    event.wall_ns = TscClock::to_wall_ns(TscClock::now());
+    event.kind = kind;
+    return event;
+}
+
+void TelemetryPublisher::publish_order(const Order& order) {
+    if (!is_open()) return;
+    TelemetryEvent event = start(TelemetryEvent::Kind::ORDER);
+    event.side = order.side == OrderSide::BUY ? TelemetryEvent::BUY : TelemetryEvent::SELL;
+    event.order = {price_to_double(order.price), static_cast<double>(order.quantity), order.order_id};
+    ring_.write(event);
+}
+
+void TelemetryPublisher::publish_signal(const StrategyCore& strategy, double price) {
+    if (!is_open()) return;
+    const SignalReason& reason = strategy.get_last_signal_reason();
+    TelemetryEvent event = start(TelemetryEvent::Kind::SIGNAL);
+    event.side = strategy.get_last_signal_type() == SignalType::BUY ? TelemetryEvent::BUY : TelemetryEvent::SELL;
+    event.reason = static_cast<uint8_t>(reason.kind);
+    event.flags = static_cast<uint8_t>((reason.macd_bullish ? 1 : 0) | (reason.price_above_ma ? 2 : 0));
+    event.signal = {price, strategy.get_last_signal_confidence(), strategy.get_last_signal_pnl_pct(),
+                    reason.momentum_score, reason.rsi, reason.short_sma, reason.long_sma, reason.deviation_pct};
+    ring_.write(event);
+}
+
+void TelemetryPublisher::publish_indicators(const IndicatorSnapshot& snapshot) {
+    if (!is_open()) return;
+    TelemetryEvent event = start(TelemetryEvent::Kind::INDICATORS);
+    event.indicators = {snapshot.price, snapshot.short_sma, snapshot.long_sma, snapshot.rsi,
+                        snapshot.macd_line, snapshot.signal_line, snapshot.momentum_score};
+    ring_.write(event);
+}
+
+void TelemetryPublisher::publish_stats(uint64_t orders, uint64_t trades, double events_per_second, const LatencyStats& match,
+                                       Price best_bid, Price best_ask, uint64_t risk_rejected) {
+    if (!is_open()) return;
+    TelemetryEvent event = start(TelemetryEvent::Kind::STATS);
+    event.stats = {orders, trades, events_per_second, match.mean_ns, static_cast<double>(match.p99_ns),
+                   price_to_double(best_bid), price_to_double(best_ask), risk_rejected};
+    ring_.write(event);
+}
+
+void TelemetryPublisher::publish_config(const StrategyConfig& config) {
+    if (!is_open()) return;
+    TelemetryEvent event = start(TelemetryEvent::Kind::CONFIG);
+    event.config = {config.momentum_threshold, config.rsi_oversold, config.rsi_overbought,
+                    static_cast<double>(config.short_period), static_cast<double>(config.long_period),
+                    config.position_size, config.stop_loss_pct, config.take_profit_pct};
+    ring_.write(event);
+}
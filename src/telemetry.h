@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include "broadcast_ring.h"
+#include "telemetry_event.h"
+#include "order_book.h"
+#include "strategy.h"
+#include "latency_histogram.h"
+
+// Writes TelemetryEvents into a shared-memory broadcast ring. Single
+// writer: every publish call must come from one thread or strand. The
+// calls are no-ops until open() succeeds, and none of them format text.
+class TelemetryPublisher {
+public:
+    bool open(const std::string& name = DEFAULT_TELEMETRY_RING, size_t capacity = 1 << 16);
+    bool is_open() const { return ring_.is_open(); }
+    const std::string& error() const { return ring_.error(); }
+
+    void publish_order(const Order& order);
+    void publish_signal(const StrategyCore& strategy, double price);
+    void publish_indicators(const IndicatorSnapshot& snapshot);
+    void publish_stats(uint64_t orders, uint64_t trades, double events_per_second, const LatencyStats& match,
+                       Price best_bid, Price best_ask, uint64_t risk_rejected);
+    void publish_config(const StrategyConfig& config);
+private:
+    BroadcastWriter<TelemetryEvent> ring_;
+    TelemetryEvent start(TelemetryEvent::Kind kind) const;
+};
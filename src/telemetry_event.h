@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+// Binary telemetry record nanoex publishes for out-of-process viewers
+// (nanoex_gui maps the ring read-only). Kept free of engine headers so a
+// viewer needs only this file, broadcast_ring.h and shared_memory.cpp.
+// Prices are in currency units, not ticks.
+struct TelemetryEvent {
+    enum class Kind : uint8_t { ORDER = 0, SIGNAL = 1, INDICATORS = 2, STATS = 3, CONFIG = 4 };
+    enum Side : uint8_t { BUY = 0, SELL = 1 };
+
+    struct OrderFields {
+        double price;
+        double quantity;
+        uint64_t order_id;
+    };
+    struct SignalFields {
+        double price;
+        double confidence;   // 0..1
+        double pnl_pct;      // Exits only
+        double momentum_score;
+        double rsi;
+        double short_sma;
+        double long_sma;
+        double deviation_pct;
+    };
+    struct IndicatorFields {
+        double price;
+        double short_sma;
+        double long_sma;
+        double rsi;
+        double macd_line;
+        double signal_line;
+        double momentum_score;
+    };
+    struct StatsFields {
+        uint64_t orders;
+        uint64_t trades;
+        double events_per_second;
+        double avg_match_ns;
+        double p99_match_ns;
+        double best_bid;
+        double best_ask;
+        uint64_t risk_rejected;
+    };
+    struct ConfigFields {
+        double momentum_threshold;
+        double rsi_oversold;
+        double rsi_overbought;
+        double short_period;
+        double long_period;
+        double position_size;
+        double stop_loss_pct;
+        double take_profit_pct;
+    };
+
+    int64_t wall_ns;
+    Kind kind;
+    uint8_t side;           // ORDER, SIGNAL
+    uint8_t reason;         // SIGNAL: SignalReason::Kind
+    uint8_t flags;          // SIGNAL: bit 0 = MACD bullish, bit 1 = price above MA
+    uint32_t reserved;
+    union {
+        OrderFields order;
+        SignalFields signal;
+        IndicatorFields indicators;
+        StatsFields stats;
+        ConfigFields config;
+    };
+};
+
+static_assert(sizeof(TelemetryEvent) == 80, "TelemetryEvent layout is shared with out-of-process readers");
+static_assert(std::is_trivially_copyable<TelemetryEvent>::value, "TelemetryEvent must be copyable into shared memory");
+
+constexpr const char* DEFAULT_TELEMETRY_RING = "/nanoex.telemetry";
@@ -1,42 +1,318 @@
 #include "threading.h"
+#include <chrono>
+#include <fstream>
+#include <string>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
-ThreadPool::ThreadPool(size_t num_threads) {
+namespace {
+
+// Identifies the pool worker running on this thread, if any.
+thread_local const void* tls_pool = nullptr;
+thread_local size_t tls_worker = 0;
+
+std::atomic<size_t> next_thread_index{0};
+
+// Single-writer counter: a plain load and store, no locked instruction.
+void bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+size_t current_thread_index() {
+    thread_local const size_t index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+bool pin_current_thread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+bool set_fifo_priority(int priority) {
+#if defined(__linux__)
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+    (void)priority;
+    return false;
+#endif
+}
+
+bool place_current_thread(int cpu, int fifo_priority) {
+    bool placed = true;
+    if (cpu >= 0) placed = pin_current_thread(cpu);
+    if (fifo_priority > 0) placed = set_fifo_priority(fifo_priority) && placed;
+    return placed;
+}
+
+int numa_node_of_cpu(int cpu) {
+    if (cpu < 0) return -1;
+    // Nodes are listed as CPU ranges, e.g. "0-7,16-23".
+    for (int node = 0; node < 64; ++node) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!in) return -1;
+        std::string list;
+        std::getline(in, list);
+        size_t pos = 0;
+        while (pos < list.size()) {
+            size_t comma = list.find(',', pos);
+            std::string range = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            size_t dash = range.find('-');
+            int lo = std::stoi(range);
+            int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+            if (cpu >= lo && cpu <= hi) return node;
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+    }
+    return -1;
+}
+
+void run_on_cpu(int cpu, const std::function<void()>& fn) {
+    if (cpu < 0) {
+        fn();
+        return;
+    }
+    std::thread([cpu, &fn]() {
+        pin_current_thread(cpu);
+        fn();
+    }).join();
+}
+
+WorkStealingDeque::WorkStealingDeque(size_t capacity)
+    : mask_(round_up_pow2(capacity) - 1), slots_(new Slot[mask_ + 1]) {}
+
+bool WorkStealingDeque::push(InplaceTask& task) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    if (bottom - top > static_cast<int64_t>(mask_)) return false;
+    Slot& slot = slots_[static_cast<size_t>(bottom) & mask_];
+    // A thief may have claimed this slot but not finished moving out of it.
+    if (slot.full.load(std::memory_order_acquire)) return false;
+    slot.task = std::move(task);
+    slot.full.store(true, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+bool WorkStealingDeque::pop(InplaceTask& out) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+    if (top == bottom) {
+        // Last task: race the thieves for it.
+        bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        if (!won) return false;
+    }
+    Slot& slot = slots_[static_cast<size_t>(bottom) & mask_];
+    out = std::move(slot.task);
+    slot.full.store(false, std::memory_order_release);
+    return true;
+}
+
+bool WorkStealingDeque::steal(InplaceTask& out) {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) return false;
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return false;
+    }
+    Slot& slot = slots_[static_cast<size_t>(top) & mask_];
+    out = std::move(slot.task);
+    slot.full.store(false, std::memory_order_release);
+    return true;
+}
+
+bool WorkStealingDeque::empty() const {
+    return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
+}
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : ThreadPool([num_threads]() {
+          ThreadPoolConfig config;
+          config.num_threads = num_threads;
+          return config;
+      }()) {}
+
+ThreadPool::ThreadPool(const ThreadPoolConfig& config) : config_(config) {
+    size_t num_threads = config.num_threads > 0 ? config.num_threads : 1;
+    workers_.reserve(num_threads);
     for (size_t i = 0; i < num_threads; ++i) {
-        workers_.emplace_back([this]() { this->worker_loop(); });
+        run_on_cpu(worker_cpu(i), [&]() {
+            workers_.push_back(std::make_unique<Worker>(config.deque_capacity, config.inbox_capacity));
+        });
     }
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_[i]->thread = std::thread([this, i]() { this->worker_loop(i); });
+    }
+}
+
+int ThreadPool::worker_cpu(size_t index) const {
+    return config_.cpus.empty() ? -1 : config_.cpus[index % config_.cpus.size()];
 }
 
 ThreadPool::~ThreadPool() {
     shutdown();
 }
 
-void ThreadPool::enqueue(std::function<void()> task) {
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        tasks_.push(std::move(task));
+void ThreadPool::submit(size_t worker, InplaceTask&& task) {
+    // Tasks spawned by a worker go straight onto its own deque.
+    if (tls_pool == this && (worker == ANY_WORKER || worker == tls_worker)) {
+        if (workers_[tls_worker]->deque.push(task)) {
+            wake_idle_peer(tls_worker);
+            return;
+        }
+        worker = tls_worker;
+    }
+    if (worker == ANY_WORKER) {
+        worker = next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
     }
-    condition_.notify_one();
+    Worker& target = *workers_[worker];
+    while (!target.inbox.try_push(std::move(task))) {
+        wake(target);
+        std::this_thread::yield();
+    }
+    // Pairs with the fence in worker_loop before a worker re-checks for work.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (target.sleeping.load(std::memory_order_relaxed)) wake(target);
+}
+
+void ThreadPool::wake(Worker& worker) {
+    std::lock_guard<std::mutex> lock(worker.park_mutex);
+    worker.sleeping.store(false, std::memory_order_relaxed);
+    worker.park_cv.notify_one();
+}
+
+void ThreadPool::wake_idle_peer(size_t self) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        Worker& peer = *workers_[(self + i) % workers_.size()];
+        if (peer.sleeping.load(std::memory_order_relaxed)) {
+            wake(peer);
+            return;
+        }
+    }
+}
+
+bool ThreadPool::find_work(size_t index, InplaceTask& task) {
+    Worker& self = *workers_[index];
+    if (self.deque.pop(task)) return true;
+    // Move a batch from the inbox onto the deque so idle peers can steal it.
+    if (self.inbox.try_pop(task)) {
+        InplaceTask extra;
+        size_t moved = 0;
+        while (moved < 32 && self.inbox.try_pop(extra)) {
+            if (!self.deque.push(extra)) {
+                extra();
+                extra.reset();
+                bump(self.tasks);
+                continue;
+            }
+            ++moved;
+        }
+        if (moved > 0) wake_idle_peer(index);
+        return true;
+    }
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        if (workers_[(index + i) % workers_.size()]->deque.steal(task)) {
+            bump(self.steals);
+            return true;
+        }
+    }
+    return false;
+}
+
+ThreadPoolStats ThreadPool::get_worker_stats(size_t worker) const {
+    const Worker& w = *workers_[worker];
+    ThreadPoolStats stats;
+    stats.tasks = w.tasks.load(std::memory_order_relaxed);
+    stats.steals = w.steals.load(std::memory_order_relaxed);
+    stats.parks = w.parks.load(std::memory_order_relaxed);
+    return stats;
 }
 
 void ThreadPool::shutdown() {
     stop_ = true;
-    condition_.notify_all();
+    for (auto& worker : workers_) wake(*worker);
     for (auto& worker : workers_) {
-        if (worker.joinable()) worker.join();
+        if (worker->thread.joinable()) worker->thread.join();
     }
-    workers_.clear();
 }
 
-void ThreadPool::worker_loop() {
+void ThreadPool::worker_loop(size_t index) {
+    place_current_thread(worker_cpu(index), config_.fifo_priority);
+    tls_pool = this;
+    tls_worker = index;
+    Worker& self = *workers_[index];
+    InplaceTask task;
+    IdleWaiter waiter(config_.wait);
     while (true) {
-        std::function<void()> task;
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            condition_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
-            if (stop_ && tasks_.empty()) return;
-            task = std::move(tasks_.front());
-            tasks_.pop();
+        if (find_work(index, task)) {
+            task();
+            task.reset();
+            bump(self.tasks);
+            waiter.reset();
+            continue;
+        }
+        if (config_.wait != WaitMode::BLOCK) {
+            // Never sleeping means never setting `sleeping`, so submitters
+            // never try to wake this worker either.
+            if (stop_) return;
+            waiter.idle();
+            continue;
         }
-        task();
+        if (config_.spin_us > 0) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(config_.spin_us);
+            bool found = false;
+            while (!found && std::chrono::steady_clock::now() < deadline) {
+                for (int i = 0; i < 64 && !found; ++i) {
+                    cpu_relax();
+                    found = find_work(index, task);
+                }
+            }
+            if (found) {
+                task();
+                task.reset();
+                bump(self.tasks);
+                continue;
+            }
+        }
+        self.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (find_work(index, task)) {
+            self.sleeping.store(false, std::memory_order_relaxed);
+            task();
+            task.reset();
+            bump(self.tasks);
+            continue;
+        }
+        if (stop_) return;
+        bump(self.parks);
+        std::unique_lock<std::mutex> lock(self.park_mutex);
+        // The timeout bounds how long queued work on a busy peer can wait
+        // for a thief if that peer never wakes us.
+        self.park_cv.wait_for(lock, std::chrono::milliseconds(10), [&]() {
+            return !self.sleeping.load(std::memory_order_relaxed) || stop_.load();
+        });
+        self.sleeping.store(false, std::memory_order_relaxed);
     }
-} 
\ No newline at end of file
+}
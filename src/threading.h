@@ -1,23 +1,194 @@
 #pragma once
 #include <vector>
-#include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <functional>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "lockfree_ring.h"
+#include "wait_strategy.h"
+
+// Pin the calling thread to one CPU. Returns false where unsupported.
+bool pin_current_thread(int cpu);
+
+// Move the calling thread to SCHED_FIFO at `priority` (1-99). Needs
+// CAP_SYS_NICE or an rtprio limit; returns false where refused.
+bool set_fifo_priority(int priority);
+
+// Pins (cpu >= 0) and raises (fifo_priority > 0) the calling thread.
+// Returns false if either was refused; the thread runs regardless.
+bool place_current_thread(int cpu, int fifo_priority);
+
+// NUMA node of `cpu` from sysfs, or -1 where unknown.
+int numa_node_of_cpu(int cpu);
+
+// Runs `fn` to completion on a thread pinned to `cpu` (inline if cpu < 0).
+// Under the kernel's default first-touch policy, memory `fn` allocates and
+// writes lands on that CPU's NUMA node, so a role's pools and rings can be
+// built next to the thread that will use them.
+void run_on_cpu(int cpu, const std::function<void()>& fn);
+
+// Small dense id for the calling thread, assigned on first call. Used to
+// pick a per-thread slot in sharded counters.
+size_t current_thread_index();
+
+// Move-only type-erased void() callable stored inline, so queueing a task
+// never allocates. Callables larger than CAPACITY are rejected at compile
+// time.
+class InplaceTask {
+public:
+    static constexpr size_t CAPACITY = 56;
+
+    InplaceTask() = default;
+
+    template <typename F, typename Fn = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<Fn, InplaceTask>::value>::type>
+    InplaceTask(F&& fn) {
+        static_assert(sizeof(Fn) <= CAPACITY, "task capture too large for InplaceTask; capture by reference or pointer");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "task capture over-aligned for InplaceTask");
+        new (storage_) Fn(std::forward<F>(fn));
+        ops_ = &OpsFor<Fn>::ops;
+    }
+
+    InplaceTask(InplaceTask&& other) noexcept { move_from(other); }
+    InplaceTask& operator=(InplaceTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+    InplaceTask(const InplaceTask&) = delete;
+    InplaceTask& operator=(const InplaceTask&) = delete;
+    ~InplaceTask() { reset(); }
 
+    explicit operator bool() const { return ops_ != nullptr; }
+    void operator()() { ops_->invoke(storage_); }
+    void reset() {
+        if (ops_) ops_->destroy(storage_);
+        ops_ = nullptr;
+    }
+private:
+    struct Ops {
+        void (*invoke)(void*);
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void*);
+    };
+    template <typename Fn>
+    struct OpsFor {
+        static void invoke(void* p) { (*static_cast<Fn*>(p))(); }
+        static void move(void* dst, void* src) { new (dst) Fn(std::move(*static_cast<Fn*>(src))); }
+        static void destroy(void* p) { static_cast<Fn*>(p)->~Fn(); }
+        static constexpr Ops ops{&invoke, &move, &destroy};
+    };
+    void move_from(InplaceTask& other) {
+        if (!other.ops_) return;
+        other.ops_->move(storage_, other.storage_);
+        ops_ = other.ops_;
+        other.reset();
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[CAPACITY];
+    const Ops* ops_ = nullptr;
+};
+
+template <typename Fn>
+constexpr InplaceTask::Ops InplaceTask::OpsFor<Fn>::ops;
+
+// Chase-Lev work-stealing deque of inline tasks. The owner pushes and pops
+// at the bottom (LIFO); other workers steal from the top (FIFO). A thief
+// claims a slot by advancing top and then moves the task out, so each slot
+// carries a flag that keeps the owner from reusing it until that move is
+// done.
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity);
+    bool push(InplaceTask& task);
+    bool pop(InplaceTask& out);
+    bool steal(InplaceTask& out);
+    bool empty() const;
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<bool> full{false};
+        InplaceTask task;
+    };
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> top_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> bottom_{0};
+};
+
+struct ThreadPoolConfig {
+    size_t num_threads = 1;
+    size_t deque_capacity = 1024;  // Per-worker work-stealing deque
+    size_t inbox_capacity = 1024;  // Per-worker ring for tasks from outside the pool
+    uint32_t spin_us = 0;          // BLOCK only: keep looking for work this long before parking
+    WaitMode wait = WaitMode::BLOCK;  // Idle workers park (BLOCK) or keep polling and never sleep
+    std::vector<int> cpus;         // Worker i pins to cpus[i % size] (empty = unpinned)
+    int fifo_priority = 0;         // SCHED_FIFO priority for workers (0 = default scheduler)
+};
+
+// Per-worker counts, kept by each worker on its own cache line.
+struct ThreadPoolStats {
+    uint64_t tasks = 0;   // Tasks run
+    uint64_t steals = 0;  // Tasks taken from a peer's deque
+    uint64_t parks = 0;   // Times the worker went to sleep
+};
+
+// Work-stealing thread pool. Tasks submitted from outside the pool land in
+// a worker's lock-free inbox (round-robin, or a chosen worker for
+// affinity); workers move inbox tasks onto their own deque and idle
+// workers steal from their peers. Parked workers are only woken when they
+// are actually asleep, so the hot path never touches a futex; in the
+// SPIN_YIELD and BUSY_POLL modes they never park at all. Pinned
+// workers have their deque and inbox built on their own CPU.
 class ThreadPool {
 public:
-    ThreadPool(size_t num_threads);
+    static constexpr size_t ANY_WORKER = static_cast<size_t>(-1);
+
+    explicit ThreadPool(size_t num_threads);
+    explicit ThreadPool(const ThreadPoolConfig& config);
     ~ThreadPool();
-    void enqueue(std::function<void()> task);
+
+    template <typename F>
+    void enqueue(F&& task) { submit(ANY_WORKER, InplaceTask(std::forward<F>(task))); }
+    template <typename F>
+    void enqueue_to(size_t worker, F&& task) { submit(worker % workers_.size(), InplaceTask(std::forward<F>(task))); }
+
     void shutdown();
+    size_t size() const { return workers_.size(); }
+    // Relaxed reads; safe to call from any thread while the pool runs.
+    ThreadPoolStats get_worker_stats(size_t worker) const;
 private:
-    std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
+    struct alignas(CACHE_LINE_SIZE) Worker {
+        Worker(size_t deque_capacity, size_t inbox_capacity)
+            : deque(deque_capacity), inbox(inbox_capacity) {}
+        WorkStealingDeque deque;
+        MpscRing<InplaceTask> inbox;
+        std::thread thread;
+        std::mutex park_mutex;
+        std::condition_variable park_cv;
+        std::atomic<bool> sleeping{false};
+        // Written only by the worker; off the line submitters poll.
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tasks{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> parks{0};
+    };
+    ThreadPoolConfig config_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_worker_{0};
     std::atomic<bool> stop_{false};
-    void worker_loop();
-}; 
\ No newline at end of file
+
+    void submit(size_t worker, InplaceTask&& task);
+    void wake(Worker& worker);
+    void wake_idle_peer(size_t self);
+    bool find_work(size_t index, InplaceTask& task);
+    int worker_cpu(size_t index) const;
+    void worker_loop(size_t index);
+};
@@ -0,0 +1,414 @@
+#include "tick_store.h"
+#include "tsc_clock.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NANOEX_HAVE_MMAP 1
+#endif
+
+namespace {
+
+uint64_t zigzag(uint64_t value, uint64_t previous) {
+    int64_t delta = static_cast<int64_t>(value - previous);
+    return (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+}
+
+uint64_t unzigzag(uint64_t encoded) {
+    return (encoded >> 1) ^ (~(encoded & 1) + 1);
+}
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Decodes `count` varints from [p, end) into `out`; false if the column
+// runs short or has bytes left over. Most values in a delta column fit one
+// byte, so eight bytes at a time are tested as one word and, when none
+// continues, widened without a branch per value.
+template <typename T>
+bool get_varints(const uint8_t* p, const uint8_t* end, T* out, size_t count) {
+    constexpr uint64_t CONTINUATION_BITS = 0x8080808080808080ULL;
+    for (size_t i = 0; i < count;) {
+        if (count - i >= 8 && end - p >= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            if ((word & CONTINUATION_BITS) == 0) {
+                for (size_t k = 0; k < 8; ++k) out[i + k] = static_cast<T>(p[k]);
+                p += 8;
+                i += 8;
+                continue;
+            }
+        }
+        if (p == end) return false;
+        uint64_t value = *p++;
+        if (value >= 0x80) {
+            value &= 0x7f;
+            for (int shift = 7;; shift += 7) {
+                if (p == end || shift > 63) return false;
+                uint64_t byte = *p++;
+                value |= (byte & 0x7f) << shift;
+                if (byte < 0x80) break;
+            }
+        }
+        out[i++] = static_cast<T>(value);
+    }
+    return p == end;
+}
+
+// Undoes the delta coding in place: a prefix sum over the zigzag deltas.
+void undelta(uint64_t* values, size_t count) {
+    uint64_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        previous += unzigzag(values[i]);
+        values[i] = previous;
+    }
+}
+
+}  // namespace
+
+TickStoreWriter::~TickStoreWriter() {
+    close();
+}
+
+bool TickStoreWriter::open(const std::string& path, uint32_t block_records) {
+    close();
+    block_records_ = std::max<uint32_t>(1, block_records);
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    pending_.clear();
+    pending_.reserve(block_records_);
+    index_.clear();
+    offset_ = 0;
+    count_ = 0;
+    TickStoreHeader header;
+    header.block_records = block_records_;
+    return write(&header, sizeof(header)) && std::fflush(file_) == 0;
+}
+
+bool TickStoreWriter::append(const MarketRecord& record) {
+    if (!file_) return false;
+    pending_.push_back(record);
+    ++count_;
+    return pending_.size() < block_records_ || flush();
+}
+
+bool TickStoreWriter::flush() {
+    if (!file_ || pending_.empty()) return file_ != nullptr;
+    for (std::vector<uint8_t>& column : columns_) column.clear();
+    TickBlockHeader header{};
+    header.magic = TickBlockHeader::MAGIC;
+    header.count = static_cast<uint32_t>(pending_.size());
+    header.min_ns = UINT64_MAX;
+    uint64_t previous_ns = 0;
+    OrderId previous_id = 0;
+    Price previous_price = 0;
+    for (const MarketRecord& record : pending_) {
+        header.min_ns = std::min(header.min_ns, record.timestamp_ns);
+        header.max_ns = std::max(header.max_ns, record.timestamp_ns);
+        put_varint(columns_[0], zigzag(record.timestamp_ns, previous_ns));
+        put_varint(columns_[1], zigzag(record.order_id, previous_id));
+        put_varint(columns_[2], zigzag(record.price, previous_price));
+        put_varint(columns_[3], record.quantity);
+        put_varint(columns_[4], record.symbol);
+        columns_[5].push_back(TickColumns::pack_flags(record.kind, record.side, record.type));
+        columns_[6].push_back(record.participant);
+        previous_ns = record.timestamp_ns;
+        previous_id = record.order_id;
+        previous_price = record.price;
+    }
+    for (size_t c = 0; c < TICK_COLUMNS; ++c) header.column_bytes[c] = static_cast<uint32_t>(columns_[c].size());
+    index_.push_back(TickBlockIndex{offset_, header.min_ns, header.max_ns, header.count, 0});
+    pending_.clear();
+    if (!write(&header, sizeof(header))) return false;
+    for (const std::vector<uint8_t>& column : columns_) {
+        if (!write(column.data(), column.size())) return false;
+    }
+    // Whole blocks reach the file as soon as they are encoded, so a killed
+    // process loses at most the block it was filling.
+    return std::fflush(file_) == 0;
+}
+
+bool TickStoreWriter::close() {
+    if (!file_) return true;
+    bool ok = flush();
+    TickStoreTrailer trailer;
+    trailer.index_offset = offset_;
+    trailer.block_count = index_.size();
+    trailer.record_count = count_;
+    ok = ok && write(index_.data(), index_.size() * sizeof(TickBlockIndex)) && write(&trailer, sizeof(trailer));
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+bool TickStoreWriter::write(const void* data, size_t size) {
+    if (size > 0 && std::fwrite(data, size, 1, file_) != 1) {
+        error_ = std::string("tick store write failed: ") + std::strerror(errno);
+        return false;
+    }
+    offset_ += size;
+    return true;
+}
+
+TickRecorder::TickRecorder(const TickRecorderConfig& config)
+    : config_(config), ring_(std::make_unique<SpscRing<MarketRecord>>(config.ring_capacity)) {}
+
+TickRecorder::~TickRecorder() {
+    close();
+}
+
+void TickRecorder::add_trade_source(std::shared_ptr<SpscRing<TradeEvent>> trades) {
+    trade_sources_.push_back(std::move(trades));
+}
+
+bool TickRecorder::open(const std::string& path) {
+    close();
+    if (!writer_.open(path, config_.block_records)) return false;
+    running_ = true;
+    thread_ = std::thread(&TickRecorder::writer_loop, this);
+    return true;
+}
+
+void TickRecorder::close() {
+    if (running_.exchange(false) && thread_.joinable()) thread_.join();
+    writer_.close();
+}
+
+size_t TickRecorder::drain() {
+    size_t count = 0;
+    MarketRecord record;
+    while (count < config_.block_records && ring_->try_pop(record)) {
+        writer_.append(record);
+        ++count;
+    }
+    TradeEvent trade;
+    for (const auto& trades : trade_sources_) {
+        while (count < config_.block_records && trades->try_pop(trade)) {
+            uint64_t wall_ns = static_cast<uint64_t>(TscClock::to_wall_ns(trade.timestamp));
+            writer_.append(MarketRecord::from_trade(trade, wall_ns));
+            ++count;
+        }
+    }
+    if (count > 0) recorded_.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+void TickRecorder::writer_loop() {
+    auto flush_interval = std::chrono::milliseconds(config_.flush_interval_ms);
+    auto last_flush = std::chrono::steady_clock::now();
+    IdleWaiter waiter(config_.wait);
+    for (;;) {
+        bool stopping = !running_.load(std::memory_order_acquire);
+        size_t count = drain();
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_flush >= flush_interval) {
+            writer_.flush();
+            last_flush = now;
+        }
+        if (count == 0) {
+            if (stopping) break;
+            waiter.idle();
+        } else {
+            waiter.reset();
+        }
+    }
+}
+
+TickStoreFile::~TickStoreFile() {
+    close();
+}
+
+bool TickStoreFile::is_tick_store(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    TickStoreHeader header;
+    return in.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == TickStoreHeader::MAGIC;
+}
+
+bool TickStoreFile::open(const std::string& path) {
+    close();
+#ifdef NANOEX_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(TickStoreHeader))) {
+        ::close(fd);
+        error_ = path + " is not a tick store";
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        error_ = "cannot map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    bytes_ = static_cast<const uint8_t*>(data_);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    size_ = fallback_.size();
+    if (size_ < sizeof(TickStoreHeader)) {
+        error_ = path + " is not a tick store";
+        return false;
+    }
+    bytes_ = reinterpret_cast<const uint8_t*>(fallback_.data());
+#endif
+    TickStoreHeader header;
+    std::memcpy(&header, bytes_, sizeof(header));
+    if (header.magic != TickStoreHeader::MAGIC || header.version != TickStoreHeader::VERSION) {
+        close();
+        error_ = path + " has an unsupported tick store header";
+        return false;
+    }
+    if (!load_index()) {
+        close();
+        return false;
+    }
+    open_ = true;
+    return true;
+}
+
+// Takes the closed writer's index if the trailer checks out; otherwise
+// walks the block headers from the front and stops at the first block the
+// file does not hold in full.
+bool TickStoreFile::load_index() {
+    index_.clear();
+    record_count_ = 0;
+    recovered_ = false;
+    TickStoreTrailer trailer;
+    if (size_ >= sizeof(TickStoreHeader) + sizeof(trailer)) {
+        std::memcpy(&trailer, bytes_ + size_ - sizeof(trailer), sizeof(trailer));
+        uint64_t index_bytes = trailer.block_count * sizeof(TickBlockIndex);
+        if (trailer.magic == TickStoreTrailer::MAGIC && trailer.index_offset >= sizeof(TickStoreHeader) &&
+            trailer.block_count <= size_ / sizeof(TickBlockIndex) &&
+            trailer.index_offset + index_bytes + sizeof(trailer) == size_) {
+            index_.resize(static_cast<size_t>(trailer.block_count));
+            std::memcpy(index_.data(), bytes_ + trailer.index_offset, static_cast<size_t>(index_bytes));
+            record_count_ = trailer.record_count;
+            return true;
+        }
+    }
+    recovered_ = true;
+    uint64_t offset = sizeof(TickStoreHeader);
+    while (offset + sizeof(TickBlockHeader) <= size_) {
+        TickBlockHeader header;
+        std::memcpy(&header, bytes_ + offset, sizeof(header));
+        uint64_t payload = 0;
+        for (uint32_t bytes : header.column_bytes) payload += bytes;
+        if (header.magic != TickBlockHeader::MAGIC || header.count == 0 ||
+            offset + sizeof(header) + payload > size_) {
+            break;
+        }
+        index_.push_back(TickBlockIndex{offset, header.min_ns, header.max_ns, header.count, 0});
+        record_count_ += header.count;
+        offset += sizeof(header) + payload;
+    }
+    return true;
+}
+
+void TickStoreFile::close() {
+#ifdef NANOEX_HAVE_MMAP
+    if (data_) munmap(data_, size_);
+#endif
+    data_ = nullptr;
+    fallback_.clear();
+    size_ = 0;
+    bytes_ = nullptr;
+    index_.clear();
+    record_count_ = 0;
+    recovered_ = false;
+    open_ = false;
+}
+
+bool TickStoreFile::decode(size_t i, TickColumns& out, uint32_t columns) const {
+    const TickBlockIndex& entry = index_[i];
+    TickBlockHeader header;
+    if (entry.offset + sizeof(header) > size_) {
+        error_ = "block " + std::to_string(i) + " lies outside the file";
+        return false;
+    }
+    std::memcpy(&header, bytes_ + entry.offset, sizeof(header));
+    const uint8_t* column = bytes_ + entry.offset + sizeof(header);
+    const uint8_t* file_end = bytes_ + size_;
+    size_t count = header.count;
+    out.count = count;
+    bool ok = header.magic == TickBlockHeader::MAGIC && header.count == entry.count;
+    // Each column decodes in its own tight loop, and skipped ones cost
+    // nothing but the pointer bump.
+    for (size_t c = 0; ok && c < TICK_COLUMNS; ++c) {
+        const uint8_t* end = column + header.column_bytes[c];
+        if (end > file_end) {
+            ok = false;
+            break;
+        }
+        bool wanted = (columns & (1u << c)) != 0;
+        switch (static_cast<TickColumn>(c)) {
+        case TickColumn::TIMESTAMP:
+            out.timestamp_ns.resize(wanted ? count : 0);
+            if (wanted) ok = get_varints(column, end, out.timestamp_ns.data(), count);
+            if (ok && wanted) undelta(out.timestamp_ns.data(), count);
+            break;
+        case TickColumn::ORDER_ID:
+            out.order_id.resize(wanted ? count : 0);
+            if (wanted) ok = get_varints(column, end, out.order_id.data(), count);
+            if (ok && wanted) undelta(out.order_id.data(), count);
+            break;
+        case TickColumn::PRICE:
+            out.price.resize(wanted ? count : 0);
+            if (wanted) ok = get_varints(column, end, out.price.data(), count);
+            if (ok && wanted) undelta(out.price.data(), count);
+            break;
+        case TickColumn::QUANTITY:
+            out.quantity.resize(wanted ? count : 0);
+            if (wanted) ok = get_varints(column, end, out.quantity.data(), count);
+            break;
+        case TickColumn::SYMBOL:
+            out.symbol.resize(wanted ? count : 0);
+            if (wanted) ok = get_varints(column, end, out.symbol.data(), count);
+            break;
+        case TickColumn::FLAGS:
+            ok = header.column_bytes[c] == count;
+            if (ok) out.flags.assign(wanted ? column : end, end);
+            break;
+        case TickColumn::PARTICIPANT:
+            ok = header.column_bytes[c] == count;
+            if (ok) out.participant.assign(wanted ? column : end, end);
+            break;
+        case TickColumn::COUNT:
+            break;
+        }
+        column = end;
+    }
+    if (!ok) error_ = "block " + std::to_string(i) + " is corrupt";
+    return ok;
+}
+
+bool TickStoreFile::read_range(uint64_t from_ns, uint64_t to_ns, std::vector<MarketRecord>& out) const {
+    return scan(from_ns, to_ns, ALL_TICK_COLUMNS, [&](const TickColumns& block) {
+        for (size_t i = 0; i < block.count; ++i) {
+            if (block.timestamp_ns[i] >= from_ns && block.timestamp_ns[i] <= to_ns) out.push_back(block.record(i));
+        }
+    });
+}
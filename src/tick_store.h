@@ -0,0 +1,241 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lockfree_ring.h"
+#include "market_record.h"
+#include "wait_strategy.h"
+
+// Columnar, append-only store of market records and trades for research
+// scans and backtests. A file is a TickStoreHeader, then blocks of up to
+// block_records records each laid out column by column, then (once the
+// writer closes) an index of every block's offset and time range and a
+// TickStoreTrailer. Timestamps, order IDs and prices are zigzag varints
+// of the delta from the previous record; quantities and symbols are plain
+// varints; kind, side and type share one flags byte. A store whose writer
+// never closed is still readable: the reader rebuilds the index from the
+// block headers and drops a torn final block.
+enum class TickColumn : uint8_t { TIMESTAMP, ORDER_ID, PRICE, QUANTITY, SYMBOL, FLAGS, PARTICIPANT, COUNT };
+
+constexpr size_t TICK_COLUMNS = static_cast<size_t>(TickColumn::COUNT);
+
+constexpr uint32_t tick_column_bit(TickColumn column) { return 1u << static_cast<uint32_t>(column); }
+constexpr uint32_t ALL_TICK_COLUMNS = (1u << TICK_COLUMNS) - 1;
+
+struct TickStoreHeader {
+    static constexpr uint32_t MAGIC = 0x5354584e;  // "NXTS"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t block_records = 0;
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(TickStoreHeader) == 16, "TickStoreHeader layout is part of the tick store format");
+
+// Precedes each block's columns, which follow in TickColumn order.
+struct TickBlockHeader {
+    static constexpr uint32_t MAGIC = 0x4254584e;  // "NXTB"
+
+    uint32_t magic;
+    uint32_t count;
+    uint64_t min_ns;  // Time range of the block's records
+    uint64_t max_ns;
+    uint32_t column_bytes[TICK_COLUMNS];
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TickBlockHeader) == 56, "TickBlockHeader layout is part of the tick store format");
+
+struct TickBlockIndex {
+    uint64_t offset;  // Of the block header, from the start of the file
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TickBlockIndex) == 32, "TickBlockIndex layout is part of the tick store format");
+
+struct TickStoreTrailer {
+    static constexpr uint32_t MAGIC = 0x4954584e;  // "NXTI"
+
+    uint32_t magic = MAGIC;
+    uint32_t reserved = 0;
+    uint64_t index_offset = 0;
+    uint64_t block_count = 0;
+    uint64_t record_count = 0;
+};
+
+static_assert(sizeof(TickStoreTrailer) == 32, "TickStoreTrailer layout is part of the tick store format");
+
+// One decoded block. Columns that were not requested stay empty; record()
+// needs all of them.
+struct TickColumns {
+    std::vector<uint64_t> timestamp_ns;
+    std::vector<OrderId> order_id;
+    std::vector<Price> price;
+    std::vector<Quantity> quantity;
+    std::vector<SymbolId> symbol;
+    std::vector<uint8_t> flags;
+    std::vector<ParticipantId> participant;
+    size_t count = 0;
+
+    static uint8_t pack_flags(MarketRecord::Kind kind, OrderSide side, OrderType type) {
+        return static_cast<uint8_t>(static_cast<uint8_t>(kind) | static_cast<uint8_t>(side) << 2 |
+                                    static_cast<uint8_t>(type) << 3);
+    }
+    static MarketRecord::Kind kind(uint8_t flags) { return static_cast<MarketRecord::Kind>(flags & 3); }
+    static OrderSide side(uint8_t flags) { return static_cast<OrderSide>(flags >> 2 & 1); }
+    static OrderType type(uint8_t flags) { return static_cast<OrderType>(flags >> 3); }
+    // As MarketRecord::is_price_observation().
+    static bool is_price_observation(uint8_t flags) {
+        return kind(flags) == MarketRecord::Kind::TRADE ||
+               (kind(flags) == MarketRecord::Kind::ADD && type(flags) == OrderType::MARKET);
+    }
+    MarketRecord record(size_t i) const {
+        return MarketRecord{timestamp_ns[i], order_id[i], price[i], quantity[i], symbol[i], kind(flags[i]),
+                            side(flags[i]), type(flags[i]), participant[i]};
+    }
+};
+
+// Writes a tick store on the calling thread: records are buffered until a
+// block fills, then encoded and written with one fwrite. close() writes the
+// last partial block and the index.
+class TickStoreWriter {
+public:
+    static constexpr uint32_t DEFAULT_BLOCK_RECORDS = 4096;
+
+    TickStoreWriter() = default;
+    ~TickStoreWriter();
+    TickStoreWriter(const TickStoreWriter&) = delete;
+    TickStoreWriter& operator=(const TickStoreWriter&) = delete;
+
+    bool open(const std::string& path, uint32_t block_records = DEFAULT_BLOCK_RECORDS);
+    bool append(const MarketRecord& record);
+    bool flush();  // Writes the buffered records as a (short) block now
+    bool close();
+    bool is_open() const { return file_ != nullptr; }
+    uint64_t count() const { return count_; }
+    uint64_t bytes_written() const { return offset_; }
+    const std::string& error() const { return error_; }
+private:
+    std::FILE* file_ = nullptr;
+    uint32_t block_records_ = DEFAULT_BLOCK_RECORDS;
+    std::vector<MarketRecord> pending_;
+    std::vector<uint8_t> columns_[TICK_COLUMNS];
+    std::vector<TickBlockIndex> index_;
+    uint64_t offset_ = 0;
+    uint64_t count_ = 0;
+    std::string error_;
+
+    bool write(const void* data, size_t size);
+};
+
+struct TickRecorderConfig {
+    size_t ring_capacity = 1 << 16;  // Records queued between the producer and the writer
+    uint32_t block_records = TickStoreWriter::DEFAULT_BLOCK_RECORDS;
+    uint32_t flush_interval_ms = 1000;  // Longest a partial block waits before it is written
+    WaitMode wait = WaitMode::BLOCK;    // Writer thread's idle policy
+};
+
+// Records into a tick store off the hot path. record() only pushes onto an
+// SPSC ring, so one producer thread at a time (a feed thread); trades come
+// from engine trade rings (MatchingEngine::subscribe_trades) added before
+// open(). A writer thread drains both, converts trade timestamps to wall
+// time and encodes blocks. A full ring drops the record and counts it, as
+// the trade rings do, so recording never stalls the feed.
+class TickRecorder {
+public:
+    explicit TickRecorder(const TickRecorderConfig& config = TickRecorderConfig());
+    ~TickRecorder();
+    TickRecorder(const TickRecorder&) = delete;
+    TickRecorder& operator=(const TickRecorder&) = delete;
+
+    void add_trade_source(std::shared_ptr<SpscRing<TradeEvent>> trades);
+    bool open(const std::string& path);
+    void close();  // Writes everything queued, then the index
+    bool is_open() const { return running_.load(std::memory_order_relaxed); }
+
+    void record(const MarketRecord& record) {
+        if (!ring_->try_push(record)) dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t get_recorded() const { return recorded_.load(std::memory_order_relaxed); }
+    uint64_t get_dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    const std::string& error() const { return writer_.error(); }
+private:
+    TickRecorderConfig config_;
+    std::unique_ptr<SpscRing<MarketRecord>> ring_;
+    std::vector<std::shared_ptr<SpscRing<TradeEvent>>> trade_sources_;
+    TickStoreWriter writer_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> recorded_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    size_t drain();
+    void writer_loop();
+};
+
+// Read-only view of a tick store. On POSIX the file is memory-mapped and
+// blocks are decoded straight from the mapping, so a scan only touches the
+// blocks (and columns) it asks for.
+class TickStoreFile {
+public:
+    TickStoreFile() = default;
+    ~TickStoreFile();
+    TickStoreFile(const TickStoreFile&) = delete;
+    TickStoreFile& operator=(const TickStoreFile&) = delete;
+
+    static bool is_tick_store(const std::string& path);
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return open_; }
+    size_t block_count() const { return index_.size(); }
+    const TickBlockIndex& block(size_t i) const { return index_[i]; }
+    uint64_t record_count() const { return record_count_; }
+    uint64_t file_bytes() const { return size_; }
+    // True if the writer never closed and the index was rebuilt from the
+    // block headers.
+    bool recovered() const { return recovered_; }
+
+    // Decodes the `columns` (a mask of tick_column_bit) of block `i`.
+    bool decode(size_t i, TickColumns& out, uint32_t columns = ALL_TICK_COLUMNS) const;
+    // Calls fn(const TickColumns&) for every block whose time range meets
+    // [from_ns, to_ns]; records inside a block are not filtered. Stops and
+    // returns false at a corrupt block.
+    template <typename Fn>
+    bool scan(uint64_t from_ns, uint64_t to_ns, uint32_t columns, Fn&& fn) const {
+        TickColumns block_columns;
+        for (size_t i = 0; i < index_.size(); ++i) {
+            if (index_[i].max_ns < from_ns || index_[i].min_ns > to_ns) continue;
+            if (!decode(i, block_columns, columns)) return false;
+            fn(static_cast<const TickColumns&>(block_columns));
+        }
+        return true;
+    }
+    // Appends the records with from_ns <= timestamp_ns <= to_ns, in file
+    // order.
+    bool read_range(uint64_t from_ns, uint64_t to_ns, std::vector<MarketRecord>& out) const;
+    const std::string& error() const { return error_; }
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<char> fallback_;
+    const uint8_t* bytes_ = nullptr;
+    std::vector<TickBlockIndex> index_;
+    uint64_t record_count_ = 0;
+    bool recovered_ = false;
+    bool open_ = false;
+    mutable std::string error_;
+
+    bool load_index();
+};
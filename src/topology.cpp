@@ -0,0 +1,131 @@
+#include "topology.h"
+#include "threading.h"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <map>
+#include <set>
+#include <thread>
+
+namespace {
+
+constexpr size_t NUM_ROLES = static_cast<size_t>(ThreadRole::COUNT);
+
+bool parse_int(const std::string& text, int& value) {
+    auto digit = [](unsigned char c) { return std::isdigit(c) != 0; };
+    if (text.empty() || text.size() > 9 || !std::all_of(text.begin(), text.end(), digit)) return false;
+    value = std::stoi(text);
+    return true;
+}
+
+// "0-3,8" -> {0, 1, 2, 3, 8}, in the order given.
+bool parse_cpu_list(const std::string& text, std::vector<int>& cpus) {
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = std::min(text.find(',', pos), text.size());
+        std::string range = text.substr(pos, comma - pos);
+        size_t dash = range.find('-');
+        int lo = 0;
+        int hi = 0;
+        if (!parse_int(range.substr(0, dash), lo)) return false;
+        hi = lo;
+        if (dash != std::string::npos && (!parse_int(range.substr(dash + 1), hi) || hi < lo)) return false;
+        for (int cpu = lo; cpu <= hi; ++cpu) cpus.push_back(cpu);
+        pos = comma + 1;
+    }
+    return !cpus.empty();
+}
+
+}  // namespace
+
+const char* thread_role_name(ThreadRole role) {
+    switch (role) {
+    case ThreadRole::FEED: return "feed";
+    case ThreadRole::STRATEGY: return "strategy";
+    case ThreadRole::MATCHER: return "matcher";
+    case ThreadRole::LOGGER: return "logger";
+    case ThreadRole::TELEMETRY: return "telemetry";
+    case ThreadRole::COUNT: break;
+    }
+    return "unknown";
+}
+
+int TopologyConfig::cpu(ThreadRole which, size_t index) const {
+    const std::vector<int>& cpus = role(which).cpus;
+    return cpus.empty() ? -1 : cpus[index % cpus.size()];
+}
+
+bool TopologyConfig::empty() const {
+    return std::none_of(std::begin(roles), std::end(roles), [](const RolePlacement& r) { return !r.cpus.empty(); });
+}
+
+bool TopologyConfig::wants_fifo() const {
+    return std::any_of(std::begin(roles), std::end(roles), [](const RolePlacement& r) { return r.fifo_priority > 0; });
+}
+
+bool parse_topology(const std::string& spec, TopologyConfig& config, std::string& error) {
+    config = TopologyConfig();
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t end = std::min(spec.find(';', pos), spec.size());
+        std::string entry = spec.substr(pos, end - pos);
+        pos = end + 1;
+        if (entry.empty()) continue;
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            error = "topology entry '" + entry + "' is not role=<cpus>[@<priority>]";
+            return false;
+        }
+        std::string name = entry.substr(0, equals);
+        size_t index = 0;
+        while (index < NUM_ROLES && name != thread_role_name(static_cast<ThreadRole>(index))) ++index;
+        if (index == NUM_ROLES) {
+            error = "unknown topology role '" + name + "'";
+            return false;
+        }
+        RolePlacement& placement = config.roles[index];
+        placement = RolePlacement();
+        std::string value = entry.substr(equals + 1);
+        size_t at = value.find('@');
+        if (!parse_cpu_list(value.substr(0, at), placement.cpus)) {
+            error = "bad CPU list for " + name + ": '" + value.substr(0, at) + "'";
+            return false;
+        }
+        if (at != std::string::npos &&
+            (!parse_int(value.substr(at + 1), placement.fifo_priority) || placement.fifo_priority < 1 ||
+             placement.fifo_priority > 99)) {
+            error = "SCHED_FIFO priority for " + name + " must be 1-99";
+            return false;
+        }
+    }
+    return true;
+}
+
+void print_topology(std::ostream& out, const TopologyConfig& config) {
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    std::map<int, std::vector<const char*>> owners;
+    for (size_t i = 0; i < NUM_ROLES; ++i) {
+        const RolePlacement& placement = config.roles[i];
+        if (placement.cpus.empty()) continue;
+        const char* name = thread_role_name(static_cast<ThreadRole>(i));
+        std::set<int> nodes;
+        out << "  " << name << ": cpus";
+        for (int cpu : placement.cpus) {
+            int node = numa_node_of_cpu(cpu);
+            out << " " << cpu;
+            if (node >= 0) out << "(node " << node << ")";
+            nodes.insert(node);
+            owners[cpu].push_back(name);
+            if (cores > 0 && cpu >= cores) out << " [not on this machine]";
+        }
+        if (placement.fifo_priority > 0) out << " SCHED_FIFO " << placement.fifo_priority;
+        if (nodes.size() > 1) out << " [spans NUMA nodes]";
+        out << "\n";
+    }
+    for (const auto& entry : owners) {
+        if (entry.second.size() < 2) continue;
+        out << "  warning: cpu " << entry.first << " is shared by";
+        for (const char* name : entry.second) out << " " << name;
+        out << "\n";
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Threads (or groups of threads) the process places independently.
+enum class ThreadRole : uint8_t {
+    FEED,       // Market-data receive, replay or load producers
+    STRATEGY,   // Thread-pool workers running the strategy strands
+    MATCHER,    // Router shards, pinned to the listed CPUs in order
+    LOGGER,     // Async log writer
+    TELEMETRY,  // Where the GUI telemetry ring is built (its pages' NUMA node)
+    COUNT
+};
+
+const char* thread_role_name(ThreadRole role);
+
+struct RolePlacement {
+    std::vector<int> cpus;  // Empty = leave the role to the scheduler
+    int fifo_priority = 0;  // SCHED_FIFO priority for the role's threads (0 = default scheduler)
+};
+
+// Which cores each role runs on. Parsed from a spec such as
+//
+//   feed=2@80;strategy=3-5;matcher=6,7@90;logger=0;telemetry=3
+//
+// where each entry is role=<cpu list>[@<fifo priority>] and a CPU list
+// uses the kernel's "0-3,8" syntax. Each pinned thread's pools and rings
+// are built on its own CPU, so they are first-touched on its NUMA node.
+struct TopologyConfig {
+    RolePlacement roles[static_cast<size_t>(ThreadRole::COUNT)];
+
+    const RolePlacement& role(ThreadRole role) const { return roles[static_cast<size_t>(role)]; }
+    RolePlacement& role(ThreadRole role) { return roles[static_cast<size_t>(role)]; }
+    bool assigned(ThreadRole role) const { return !this->role(role).cpus.empty(); }
+    bool empty() const;
+    bool wants_fifo() const;
+    // The index'th CPU of a role, wrapping; -1 if unassigned.
+    int cpu(ThreadRole role, size_t index = 0) const;
+};
+
+bool parse_topology(const std::string& spec, TopologyConfig& config, std::string& error);
+
+// One line per assigned role with its CPUs, NUMA nodes and priority, plus
+// warnings for CPUs outside the machine, CPUs shared between roles, and
+// roles split across nodes.
+void print_topology(std::ostream& out, const TopologyConfig& config);
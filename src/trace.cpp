@@ -0,0 +1,144 @@
+#include "trace.h"
+#include "performance.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+constexpr size_t NUM_SPANS = static_cast<size_t>(TraceSpan::COUNT);
+
+struct SpanInfo {
+    TraceStage from;
+    TraceStage to;
+    int lane;  // Chrome trace tid
+    bool queue;
+};
+
+// TICK_TO_TRADE is not drawn; it is the sum of the rest.
+const SpanInfo SPANS[NUM_SPANS] = {
+    {TraceStage::FEED, TraceStage::STRATEGY_START, 1, true},
+    {TraceStage::STRATEGY_START, TraceStage::STRATEGY_DONE, 2, false},
+    {TraceStage::STRATEGY_DONE, TraceStage::RISK_DONE, 2, false},
+    {TraceStage::RISK_DONE, TraceStage::SUBMITTED, 2, false},
+    {TraceStage::SUBMITTED, TraceStage::MATCH_START, 3, true},
+    {TraceStage::MATCH_START, TraceStage::MATCH_DONE, 4, false},
+    {TraceStage::FEED, TraceStage::MATCH_DONE, 0, false},
+};
+
+const char* const LANES[] = {"", "feed -> strand queue", "strategy strand", "engine ingress", "matcher"};
+
+}  // namespace
+
+const char* trace_stage_name(TraceStage stage) {
+    switch (stage) {
+    case TraceStage::FEED: return "feed";
+    case TraceStage::STRATEGY_START: return "strategy_start";
+    case TraceStage::STRATEGY_DONE: return "strategy_done";
+    case TraceStage::RISK_DONE: return "risk_done";
+    case TraceStage::SUBMITTED: return "submitted";
+    case TraceStage::MATCH_START: return "match_start";
+    case TraceStage::MATCH_DONE: return "match_done";
+    case TraceStage::COUNT: break;
+    }
+    return "unknown";
+}
+
+const char* trace_span_name(TraceSpan span) {
+    switch (span) {
+    case TraceSpan::DISPATCH_QUEUE: return "dispatch_queue";
+    case TraceSpan::STRATEGY: return "strategy";
+    case TraceSpan::RISK: return "risk";
+    case TraceSpan::SUBMIT: return "submit";
+    case TraceSpan::INGRESS_QUEUE: return "ingress_queue";
+    case TraceSpan::MATCH: return "match";
+    case TraceSpan::TICK_TO_TRADE: return "tick_to_trade";
+    case TraceSpan::COUNT: break;
+    }
+    return "unknown";
+}
+
+Tracer::Tracer(const TraceConfig& config)
+    : config_(config),
+      slots_(new TraceContext[config.max_in_flight > 0 ? config.max_in_flight : 1]),
+      finished_(config.completed_capacity) {
+    if (config_.max_in_flight == 0) config_.max_in_flight = 1;
+}
+
+TraceContext* Tracer::start_trace() {
+    uint64_t id = started_.fetch_add(1, std::memory_order_relaxed);
+    TraceContext& trace = slots_[id % config_.max_in_flight];
+    trace = TraceContext();
+    trace.owner = this;
+    trace.id = static_cast<uint32_t>(id);
+    trace.feed_ticks = TscClock::now();
+    return &trace;
+}
+
+void Tracer::finish(const TraceContext& trace) {
+    if (!finished_.try_push(trace)) dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t Tracer::drain() {
+    size_t count = 0;
+    TraceContext trace;
+    while (finished_.try_pop(trace)) {
+        for (size_t i = 0; i < NUM_SPANS; ++i) {
+            const SpanInfo& span = SPANS[i];
+            if (!trace.reached(span.from) || !trace.reached(span.to)) continue;
+            spans_[i].record(TscClock::to_ns(trace.ticks_at(span.to) - trace.ticks_at(span.from)));
+        }
+        if (retained_.size() < config_.max_retained) retained_.push_back(trace);
+        ++count;
+    }
+    completed_ += count;
+    return count;
+}
+
+LatencyStats Tracer::get_span_stats(TraceSpan span) const {
+    return spans_[static_cast<size_t>(span)].stats();
+}
+
+void Tracer::print_report(std::ostream& out) const {
+    out << "Trace breakdown (" << completed_ << " traces, " << get_dropped() << " dropped):\n";
+    for (size_t i = 0; i < NUM_SPANS; ++i) {
+        print_latency_line(out, trace_span_name(static_cast<TraceSpan>(i)), spans_[i].stats());
+    }
+}
+
+bool Tracer::write_chrome_trace(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+    bool first = true;
+    for (int lane = 1; lane <= 4; ++lane) {
+        std::fprintf(file,
+                     "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                     "\"args\":{\"name\":\"%s\"}}",
+                     first ? "" : ",\n", lane, LANES[lane]);
+        first = false;
+    }
+    // Traces finish out of order across threads, so the origin is the
+    // earliest feed stamp rather than the first retained trace.
+    uint64_t origin = retained_.empty() ? 0 : retained_.front().feed_ticks;
+    for (const TraceContext& trace : retained_) origin = std::min(origin, trace.feed_ticks);
+    for (const TraceContext& trace : retained_) {
+        for (size_t i = 0; i < NUM_SPANS; ++i) {
+            const SpanInfo& span = SPANS[i];
+            if (span.lane == 0 || !trace.reached(span.from) || !trace.reached(span.to)) continue;
+            uint64_t from = trace.ticks_at(span.from);
+            double ts_us = TscClock::to_ns(from - origin) / 1000.0;
+            double dur_us = TscClock::to_ns(trace.ticks_at(span.to) - from) / 1000.0;
+            // Async begin/end pairs keyed by trace id, since queued batches
+            // overlap and complete ("X") events on one lane must nest.
+            for (char phase : {'b', 'e'}) {
+                std::fprintf(file,
+                             ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"id\":%u,\"pid\":1,"
+                             "\"tid\":%d,\"ts\":%.3f}",
+                             trace_span_name(static_cast<TraceSpan>(i)), span.queue ? "queue" : "compute", phase,
+                             trace.id, span.lane, phase == 'b' ? ts_us : ts_us + dur_us);
+            }
+        }
+    }
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "latency_histogram.h"
+#include "lockfree_ring.h"
+#include "tsc_clock.h"
+
+// Stage boundaries a sampled feed batch is stamped at, in pipeline order.
+enum class TraceStage : uint8_t {
+    FEED,            // Batch handed over by the feed thread
+    STRATEGY_START,  // Strand picked it up
+    STRATEGY_DONE,
+    RISK_DONE,
+    SUBMITTED,       // First order handed to the router
+    MATCH_START,     // Matcher popped it
+    MATCH_DONE,
+    COUNT
+};
+
+// Intervals between consecutive stages, plus the whole path. Queue spans
+// are time spent waiting, the rest is compute.
+enum class TraceSpan : uint8_t {
+    DISPATCH_QUEUE,  // FEED -> STRATEGY_START
+    STRATEGY,        // STRATEGY_START -> STRATEGY_DONE
+    RISK,            // STRATEGY_DONE -> RISK_DONE
+    SUBMIT,          // RISK_DONE -> SUBMITTED
+    INGRESS_QUEUE,   // SUBMITTED -> MATCH_START
+    MATCH,           // MATCH_START -> MATCH_DONE
+    TICK_TO_TRADE,   // FEED -> MATCH_DONE, for traces that reached the book
+    COUNT
+};
+
+const char* trace_stage_name(TraceStage stage);
+const char* trace_span_name(TraceSpan span);
+
+class Tracer;
+
+// Trace state carried by pointer alongside one sampled batch and, if it
+// produced orders, its first order. Every stage after FEED is an offset in
+// ticks from the FEED stamp (saturating), so a trace is 48 bytes. Each
+// stage is stamped by whichever thread holds the batch at that point; the
+// queues between them order the writes.
+struct TraceContext {
+    static constexpr size_t OFFSETS = static_cast<size_t>(TraceStage::COUNT) - 1;
+
+    Tracer* owner;
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t feed_ticks;
+    uint32_t offsets[OFFSETS];  // 0 = stage not reached
+
+    void stamp(TraceStage stage) {
+        uint64_t delta = TscClock::now() - feed_ticks;
+        offsets[static_cast<size_t>(stage) - 1] = delta < UINT32_MAX ? static_cast<uint32_t>(delta ? delta : 1)
+                                                                     : UINT32_MAX;
+    }
+    bool reached(TraceStage stage) const {
+        return stage == TraceStage::FEED || offsets[static_cast<size_t>(stage) - 1] != 0;
+    }
+    uint64_t ticks_at(TraceStage stage) const {
+        return stage == TraceStage::FEED ? feed_ticks : feed_ticks + offsets[static_cast<size_t>(stage) - 1];
+    }
+    // Ends the trace at its last stamped stage.
+    void finish();
+};
+
+static_assert(sizeof(TraceContext) == 48, "TraceContext should stay compact");
+
+struct TraceConfig {
+    uint32_t sample_every = 0;        // Trace one batch in this many (0 = off)
+    size_t max_in_flight = 1024;      // Contexts handed out before slots are reused
+    size_t completed_capacity = 1 << 14;  // Finished traces waiting for drain()
+    size_t max_retained = 1 << 17;    // Finished traces kept for export
+};
+
+// Sampled tick-to-trade tracing. begin() on the feed thread hands out a
+// context for one batch in sample_every; each stage stamps it as the batch
+// moves on, and finish() copies it onto an MPSC ring from whichever thread
+// saw the last stage. drain(), on one thread, folds finished traces into
+// per-span histograms and keeps them for a Chrome trace export. Slots are
+// reused after max_in_flight traces, which must exceed what can ever be in
+// flight at once.
+class Tracer {
+public:
+    explicit Tracer(const TraceConfig& config = TraceConfig());
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    bool enabled() const { return config_.sample_every > 0; }
+    // Returns a context stamped at FEED, or nullptr if this batch is not
+    // sampled. One producer thread at a time.
+    TraceContext* begin() {
+        if (!enabled() || batches_++ % config_.sample_every != 0) return nullptr;
+        return start_trace();
+    }
+    void finish(const TraceContext& trace);
+
+    // Consumer side: one thread at a time.
+    size_t drain();
+    LatencyStats get_span_stats(TraceSpan span) const;
+    void print_report(std::ostream& out) const;
+    // Writes every retained trace as Chrome trace-event JSON, loadable in
+    // chrome://tracing and Perfetto: each span is a slice on its pipeline
+    // hop's lane, categorised "queue" or "compute".
+    bool write_chrome_trace(const std::string& path) const;
+
+    uint64_t get_started() const { return started_.load(std::memory_order_relaxed); }
+    uint64_t get_completed() const { return completed_; }
+    uint64_t get_dropped() const { return dropped_.load(std::memory_order_relaxed); }
+private:
+    TraceConfig config_;
+    uint64_t batches_ = 0;
+    std::atomic<uint64_t> started_{0};
+    std::unique_ptr<TraceContext[]> slots_;
+    MpscRing<TraceContext> finished_;
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t completed_ = 0;
+    LatencyHistogram spans_[static_cast<size_t>(TraceSpan::COUNT)];
+    std::vector<TraceContext> retained_;
+
+    TraceContext* start_trace();
+};
+
+inline void TraceContext::finish() {
+    owner->finish(*this);
+}
@@ -0,0 +1,64 @@
+#include "tsc_clock.h"
+#include "seqlock.h"
+#include <thread>
+
+namespace {
+
+double calibrate() {
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+    // Spin (rather than sleep) so the sample is not dominated by wakeup
+    // jitter; 10ms keeps the ratio error well under 0.1%.
+    auto wall_start = std::chrono::steady_clock::now();
+    uint64_t tick_start = TscClock::now();
+    auto wall_end = wall_start;
+    while (wall_end - wall_start < std::chrono::milliseconds(10)) {
+        std::this_thread::yield();
+        wall_end = std::chrono::steady_clock::now();
+    }
+    uint64_t tick_end = TscClock::now();
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(wall_end - wall_start).count());
+    return tick_end > tick_start ? ns / static_cast<double>(tick_end - tick_start) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+WallClockAnchor read_wall_anchor() {
+    WallClockAnchor anchor;
+    anchor.ticks = TscClock::now();
+    anchor.unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return anchor;
+}
+
+SeqLock<WallClockAnchor>& anchor_lock() {
+    static SeqLock<WallClockAnchor> lock;
+    static const bool initialized = (lock.store(read_wall_anchor()), true);
+    (void)initialized;
+    return lock;
+}
+
+}  // namespace
+
+double TscClock::ns_per_tick() {
+    static const double ratio = calibrate();
+    return ratio;
+}
+
+int64_t TscClock::to_wall_ns(uint64_t ticks) {
+    WallClockAnchor anchor = anchor_lock().load();
+    double delta = static_cast<double>(static_cast<int64_t>(ticks - anchor.ticks)) * ns_per_tick();
+    return anchor.unix_ns + static_cast<int64_t>(delta);
+}
+
+WallClockAnchor TscClock::wall_anchor() {
+    return anchor_lock().load();
+}
+
+void TscClock::set_wall_anchor(const WallClockAnchor& anchor) {
+    anchor_lock().store(anchor);
+}
+
+void TscClock::resync_wall_clock() {
+    anchor_lock().store(read_wall_anchor());
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Pairs a tick reading with the Unix time it corresponds to.
+struct WallClockAnchor {
+    uint64_t ticks = 0;
+    int64_t unix_ns = 0;
+};
+
+// Cheap monotonic tick counter used for every order/trade timestamp and
+// latency measurement: rdtsc on x86 (assumes an invariant TSC), the
+// virtual counter on AArch64, steady_clock nanoseconds elsewhere. Ticks
+// are converted to nanoseconds with a ratio calibrated once against
+// steady_clock on first use.
+class TscClock {
+public:
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static double ns_per_tick();
+    static uint64_t to_ns(uint64_t ticks) { return static_cast<uint64_t>(ticks * ns_per_tick()); }
+
+    // Wall time is derived from an anchor taken from system_clock at
+    // calibration. Callers with a disciplined source (PTP, chrony) can
+    // install their own anchor, or resync periodically to bound drift.
+    static int64_t to_wall_ns(uint64_t ticks);
+    static WallClockAnchor wall_anchor();
+    static void set_wall_anchor(const WallClockAnchor& anchor);
+    static void resync_wall_clock();
+
+    // Stamps every element of `items` (Orders or pointers to them) with one
+    // clock read and returns it.
+    template <typename Range>
+    static uint64_t stamp_batch(Range& items) {
+        uint64_t ticks = now();
+        for (auto& item : items) target(item).timestamp = ticks;
+        return ticks;
+    }
+private:
+    template <typename T>
+    static T& target(T& item) { return item; }
+    template <typename T>
+    static T& target(std::shared_ptr<T>& item) { return *item; }
+};
@@ -0,0 +1,95 @@
+#include "udp_multicast_source.h"
+#include <cerrno>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define NANOEX_HAVE_SOCKETS 1
+#endif
+
+UdpMulticastSource::UdpMulticastSource(const UdpEndpoint& endpoint) : endpoint_(endpoint) {}
+
+UdpMulticastSource::~UdpMulticastSource() {
+#ifdef NANOEX_HAVE_SOCKETS
+    if (fd_ >= 0) ::close(fd_);
+#endif
+}
+
+bool UdpMulticastSource::open() {
+#ifdef NANOEX_HAVE_SOCKETS
+    fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd_ < 0) {
+        error_ = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+    setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &endpoint_.receive_buffer, sizeof(endpoint_.receive_buffer));
+#ifdef SO_BUSY_POLL
+    if (endpoint_.busy_poll_us > 0) {
+        setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL, &endpoint_.busy_poll_us, sizeof(endpoint_.busy_poll_us));
+    }
+#endif
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(endpoint_.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error_ = std::string("bind: ") + std::strerror(errno);
+        return false;
+    }
+
+    ip_mreq membership;
+    std::memset(&membership, 0, sizeof(membership));
+    if (inet_pton(AF_INET, endpoint_.group.c_str(), &membership.imr_multiaddr) != 1 ||
+        inet_pton(AF_INET, endpoint_.interface_addr.c_str(), &membership.imr_interface) != 1) {
+        error_ = "bad multicast group or interface address";
+        return false;
+    }
+    if (setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+        error_ = std::string("IP_ADD_MEMBERSHIP: ") + std::strerror(errno);
+        return false;
+    }
+
+    int flags = fcntl(fd_, F_GETFL, 0);
+    fcntl(fd_, F_SETFL, flags | O_NONBLOCK);
+    return true;
+#else
+    error_ = "UDP sockets are not supported on this platform";
+    return false;
+#endif
+}
+
+size_t UdpMulticastSource::receive(PacketBatch& batch) {
+    batch.count = 0;
+#if defined(__linux__)
+    mmsghdr messages[PacketBatch::MAX_PACKETS];
+    iovec vectors[PacketBatch::MAX_PACKETS];
+    for (size_t i = 0; i < PacketBatch::MAX_PACKETS; ++i) {
+        vectors[i].iov_base = batch.packet(i);
+        vectors[i].iov_len = PacketBatch::MTU;
+        std::memset(&messages[i].msg_hdr, 0, sizeof(messages[i].msg_hdr));
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    int received = recvmmsg(fd_, messages, PacketBatch::MAX_PACKETS, MSG_DONTWAIT, nullptr);
+    if (received <= 0) return 0;
+    for (int i = 0; i < received; ++i) batch.lengths[i] = messages[i].msg_len;
+    batch.count = static_cast<size_t>(received);
+#elif defined(NANOEX_HAVE_SOCKETS)
+    while (batch.count < PacketBatch::MAX_PACKETS) {
+        ssize_t n = recv(fd_, batch.packet(batch.count), PacketBatch::MTU, MSG_DONTWAIT);
+        if (n <= 0) break;
+        batch.lengths[batch.count++] = static_cast<size_t>(n);
+    }
+#endif
+    return batch.count;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "packet_source.h"
+
+struct UdpEndpoint {
+    std::string group;                   // Multicast group, e.g. "239.1.1.1"
+    uint16_t port = 0;
+    std::string interface_addr = "0.0.0.0";  // Local interface to join on
+    int busy_poll_us = 50;               // SO_BUSY_POLL where supported (0 = off)
+    int receive_buffer = 8 << 20;        // SO_RCVBUF bytes
+};
+
+// Non-blocking multicast UDP socket. On Linux a poll drains up to
+// MAX_PACKETS datagrams with one recvmmsg call.
+class UdpMulticastSource : public PacketSource {
+public:
+    explicit UdpMulticastSource(const UdpEndpoint& endpoint);
+    ~UdpMulticastSource() override;
+    UdpMulticastSource(const UdpMulticastSource&) = delete;
+    UdpMulticastSource& operator=(const UdpMulticastSource&) = delete;
+
+    bool open();
+    size_t receive(PacketBatch& batch) override;
+    const std::string& error() const { return error_; }
+private:
+    UdpEndpoint endpoint_;
+    int fd_ = -1;
+    std::string error_;
+};
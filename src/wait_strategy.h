@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "lockfree_ring.h"
+
+// How a consumer waits when its queue is empty.
+enum class WaitMode : uint8_t {
+    BLOCK,       // Spin briefly, then sleep (or park); frees the core, costs a wake-up
+    SPIN_YIELD,  // Spin briefly, then yield the core to other runnable threads
+    BUSY_POLL,   // cpu_relax() forever; never enters the kernel, needs a dedicated core
+};
+
+inline const char* wait_mode_name(WaitMode mode) {
+    switch (mode) {
+    case WaitMode::BLOCK: return "block";
+    case WaitMode::SPIN_YIELD: return "spin";
+    case WaitMode::BUSY_POLL: return "busy";
+    }
+    return "unknown";
+}
+
+inline bool parse_wait_mode(const std::string& name, WaitMode& mode) {
+    for (WaitMode candidate : {WaitMode::BLOCK, WaitMode::SPIN_YIELD, WaitMode::BUSY_POLL}) {
+        if (name == wait_mode_name(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Idle policy for a polling loop: call idle() after every empty poll and
+// reset() once work turns up again.
+class IdleWaiter {
+public:
+    static constexpr uint32_t DEFAULT_SPINS = 1024;
+
+    explicit IdleWaiter(WaitMode mode, uint32_t spins = DEFAULT_SPINS, uint32_t sleep_us = 50)
+        : mode_(mode), spins_(spins), sleep_(sleep_us) {}
+
+    void idle() {
+        if (mode_ == WaitMode::BUSY_POLL) {
+            cpu_relax();
+        } else if (idle_ < spins_) {
+            ++idle_;
+            cpu_relax();
+        } else if (mode_ == WaitMode::SPIN_YIELD) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(sleep_);
+        }
+    }
+    void reset() { idle_ = 0; }
+    WaitMode mode() const { return mode_; }
+private:
+    WaitMode mode_;
+    uint32_t spins_;
+    std::chrono::microseconds sleep_;
+    uint32_t idle_ = 0;
+};
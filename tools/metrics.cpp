@@ -0,0 +1,51 @@
+// Scrapes a running nanoex's metrics page (nanoex --metrics <name>).
+//
+//   nanoex_metrics [<name>] [--watch <ms>]
+//
+// Prints every series in the Prometheus text exposition format, once or
+// every --watch milliseconds. Reading the page takes no lock and never
+// waits on the process being scraped, so any scrape rate is safe; the
+// values are as fresh as nanoex's last 100 ms sample. For a Prometheus
+// server, redirect it into node_exporter's textfile collector or serve it
+// from any small HTTP wrapper.
+#include "metrics.h"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+int main(int argc, char* argv[]) {
+    std::string name = DEFAULT_METRICS_PAGE;
+    int watch_ms = 0;
+    bool bad_args = false;
+    for (int i = 1; i < argc && !bad_args; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--watch" && i + 1 < argc) {
+            watch_ms = std::stoi(argv[++i]);
+        } else if (arg.rfind("--", 0) != 0) {
+            name = arg;
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args || watch_ms < 0) {
+        std::cerr << "usage: " << argv[0] << " [<name>] [--watch <ms>]\n";
+        return 1;
+    }
+
+    MetricsReader reader;
+    if (!reader.open(name)) {
+        std::cerr << reader.error() << "\n";
+        return 1;
+    }
+    for (;;) {
+        // One write per scrape, so a reader of the pipe never sees half of one.
+        std::ostringstream scrape;
+        reader.write_prometheus(scrape);
+        std::cout << scrape.str() << std::flush;
+        if (watch_ms == 0) return 0;
+        std::this_thread::sleep_for(std::chrono::milliseconds(watch_ms));
+        std::cout << "\n";
+    }
+}
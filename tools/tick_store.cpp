@@ -0,0 +1,158 @@
+// Builds and queries columnar tick stores.
+//
+//   nanoex_tick_store import <capture> <store> [--block <records>]
+//   nanoex_tick_store info <store>
+//   nanoex_tick_store query <store> [--from <unix ns>] [--to <unix ns>]
+//
+// query prints per-symbol price prints, volume, VWAP and range over the
+// window. It maps the store, skips blocks outside the window by the block
+// index and decodes only the columns it reads, so memory stays at one
+// block however long the window is.
+#include "replay.h"
+#include "tick_store.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct SymbolStats {
+    uint64_t prints = 0;
+    uint64_t volume = 0;
+    double notional = 0.0;
+    Price high = 0;
+    Price low = UINT64_MAX;
+    Price last = 0;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int import_capture(const std::string& capture_path, const std::string& store_path, uint32_t block_records) {
+    CaptureFile capture;
+    if (!capture.open(capture_path)) {
+        std::cerr << capture.error() << "\n";
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    TickStoreWriter writer;
+    bool ok = writer.open(store_path, block_records);
+    for (const MarketRecord& record : capture.records()) {
+        if (!ok) break;
+        ok = writer.append(record);
+    }
+    uint64_t count = writer.count();
+    ok = writer.close() && ok;
+    if (!ok) {
+        std::cerr << writer.error() << "\n";
+        return 1;
+    }
+    uint64_t raw = count * sizeof(MarketRecord);
+    uint64_t stored = writer.bytes_written();
+    std::cout << "Imported " << count << " records: " << raw << " -> " << stored << " bytes (" << std::fixed
+              << std::setprecision(2) << (stored > 0 ? double(raw) / stored : 0.0) << "x) in "
+              << std::setprecision(3) << seconds_since(start) << "s\n";
+    return 0;
+}
+
+int print_info(const TickStoreFile& store) {
+    uint64_t first_ns = UINT64_MAX;
+    uint64_t last_ns = 0;
+    for (size_t i = 0; i < store.block_count(); ++i) {
+        first_ns = std::min(first_ns, store.block(i).min_ns);
+        last_ns = std::max(last_ns, store.block(i).max_ns);
+    }
+    std::cout << "records=" << store.record_count() << " blocks=" << store.block_count()
+              << " bytes=" << store.file_bytes() << std::fixed << std::setprecision(2) << " bytes/record="
+              << (store.record_count() > 0 ? double(store.file_bytes()) / store.record_count() : 0.0) << "\n";
+    if (store.block_count() > 0) std::cout << "time range: " << first_ns << " - " << last_ns << " ns\n";
+    if (store.recovered()) std::cout << "No index (writer did not close); rebuilt from block headers.\n";
+    return 0;
+}
+
+int run_query(const TickStoreFile& store, uint64_t from_ns, uint64_t to_ns) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SymbolStats> stats;
+    uint64_t records = 0;
+    size_t blocks = 0;
+    uint32_t columns = tick_column_bit(TickColumn::TIMESTAMP) | tick_column_bit(TickColumn::PRICE) |
+                       tick_column_bit(TickColumn::QUANTITY) | tick_column_bit(TickColumn::SYMBOL) |
+                       tick_column_bit(TickColumn::FLAGS);
+    bool ok = store.scan(from_ns, to_ns, columns, [&](const TickColumns& block) {
+        ++blocks;
+        for (size_t i = 0; i < block.count; ++i) {
+            if (block.timestamp_ns[i] < from_ns || block.timestamp_ns[i] > to_ns) continue;
+            ++records;
+            if (!TickColumns::is_price_observation(block.flags[i])) continue;
+            if (block.symbol[i] >= stats.size()) stats.resize(block.symbol[i] + 1);
+            SymbolStats& s = stats[block.symbol[i]];
+            ++s.prints;
+            s.volume += block.quantity[i];
+            s.notional += price_to_double(block.price[i]) * static_cast<double>(block.quantity[i]);
+            s.high = std::max(s.high, block.price[i]);
+            s.low = std::min(s.low, block.price[i]);
+            s.last = block.price[i];
+        }
+    });
+    if (!ok) {
+        std::cerr << store.error() << "\n";
+        return 1;
+    }
+    double seconds = seconds_since(start);
+    std::cout << "Scanned " << records << " records in " << blocks << " of " << store.block_count() << " blocks in "
+              << std::fixed << std::setprecision(3) << seconds << "s ("
+              << std::setprecision(1) << (seconds > 0 ? records / seconds / 1e6 : 0.0) << "M records/s)\n";
+    for (size_t symbol = 0; symbol < stats.size(); ++symbol) {
+        const SymbolStats& s = stats[symbol];
+        if (s.prints == 0) continue;
+        std::cout << "  symbol " << symbol << ": prints=" << s.prints << " volume=" << s.volume << std::setprecision(4)
+                  << " vwap=" << s.notional / static_cast<double>(s.volume) << std::setprecision(2)
+                  << " high=" << price_to_double(s.high) << " low=" << price_to_double(s.low)
+                  << " last=" << price_to_double(s.last) << "\n";
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string command = argc > 1 ? argv[1] : "";
+    std::vector<std::string> paths;
+    uint32_t block_records = TickStoreWriter::DEFAULT_BLOCK_RECORDS;
+    uint64_t from_ns = 0;
+    uint64_t to_ns = UINT64_MAX;
+    bool bad_args = command != "import" && command != "info" && command != "query";
+    for (int i = 2; i < argc && !bad_args; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--block" && has_value) {
+            block_records = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--from" && has_value) {
+            from_ns = std::stoull(argv[++i]);
+        } else if (arg == "--to" && has_value) {
+            to_ns = std::stoull(argv[++i]);
+        } else if (arg.rfind("--", 0) != 0) {
+            paths.push_back(arg);
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args || paths.size() != (command == "import" ? 2u : 1u)) {
+        std::cerr << "usage: " << argv[0] << " import <capture> <store> [--block <records>]\n"
+                  << "       " << argv[0] << " info <store>\n"
+                  << "       " << argv[0] << " query <store> [--from <unix ns>] [--to <unix ns>]\n";
+        return 1;
+    }
+
+    if (command == "import") return import_capture(paths[0], paths[1], block_records);
+    TickStoreFile store;
+    if (!store.open(paths[0])) {
+        std::cerr << store.error() << "\n";
+        return 1;
+    }
+    return command == "info" ? print_info(store) : run_query(store, from_ns, to_ns);
+}